@@ -0,0 +1,74 @@
+// Neighbor grid build and SPH step time for 50k to 500k interacting
+// particles, on one thread and on the shared thread pool.
+//
+// Usage: FluidBenchmarks [steps]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "ParticleData.h"
+#include "ParticleFluid.h"
+#include "ThreadPool.h"
+
+namespace {
+    struct StepTimes {
+        float grid;
+        float solve;
+    };
+
+    // A cube of particles at the rest spacing, slightly jittered
+    void FillCube(ParticleData& particles, size_t count, float spacing) {
+        particles.Resize(count);
+        size_t side = (size_t)std::ceil(std::cbrt((double)count));
+        for (size_t i = 0; i < count; i++) {
+            float jitter = (float)((i * 2654435761u) % 1000) * 1.0e-6f;
+            particles.px[i] = (float)(i % side) * spacing + jitter;
+            particles.py[i] = (float)((i / side) % side) * spacing;
+            particles.pz[i] = (float)(i / (side * side)) * spacing - jitter;
+            particles.vx[i] = particles.vy[i] = particles.vz[i] = 0.0f;
+        }
+    }
+
+    StepTimes MeasureStep(size_t count, int steps, ThreadPool* threadPool) {
+        SphFluidSettings settings;
+        ParticleData particles;
+        FillCube(particles, count, settings.smoothingRadius * 0.5f);
+
+        SphFluidSolver solver;
+        solver.SetSettings(settings);
+        solver.SetThreadPool(threadPool);
+        solver.Step(particles, settings.maxTimeStep); // warm up the allocations
+
+        StepTimes total = { 0.0f, 0.0f };
+        for (int step = 0; step < steps; step++) {
+            solver.Step(particles, settings.maxTimeStep);
+            total.grid += solver.GetGridTime();
+            total.solve += solver.GetSolveTime();
+        }
+        return { total.grid / steps, total.solve / steps };
+    }
+}
+
+int main(int argc, char** argv) {
+    int steps = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 5;
+    const size_t counts[] = { 50000, 100000, 250000, 500000 };
+    ThreadPool& pool = ThreadPool::GetShared();
+
+    std::cout << "SPH fluid benchmark (" << steps << " steps, " << pool.GetThreadCount() << " threads)" << std::endl;
+    std::cout << std::setw(10) << "particles" << std::setw(12) << "grid 1T" << std::setw(12) << "solve 1T"
+              << std::setw(12) << "grid MT" << std::setw(12) << "solve MT" << std::setw(10) << "speedup" << std::endl;
+
+    for (size_t count : counts) {
+        StepTimes serial = MeasureStep(count, steps, nullptr);
+        StepTimes parallel = MeasureStep(count, steps, &pool);
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(2)
+                  << std::setw(9) << serial.grid << " ms" << std::setw(9) << serial.solve << " ms"
+                  << std::setw(9) << parallel.grid << " ms" << std::setw(9) << parallel.solve << " ms"
+                  << std::setw(9) << (serial.grid + serial.solve) / (parallel.grid + parallel.solve) << "x" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Particle update throughput: the previous array-of-structures update
+// against the structure-of-arrays kernels at every supported SIMD level,
+// emission randomness from std::mt19937 against the batch generators, and
+// the cost of each force module.
+//
+// Usage: ParticleBenchmarks [frames]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ParticleData.h"
+#include "ParticleForces.h"
+#include "ParticleKernels.h"
+#include "Random.h"
+
+namespace {
+    // The particle layout and update used before the SoA rewrite (88 bytes per particle)
+    struct LegacyParticle {
+        glm::vec3 position;
+        glm::vec3 velocity;
+        glm::vec3 acceleration;
+        glm::vec4 color;
+        float life;
+        float maxLife;
+        float size;
+        float rotation;
+        float rotationSpeed;
+    };
+
+    void UpdateLegacyParticle(LegacyParticle& particle, float deltaTime) {
+        particle.velocity += particle.acceleration * deltaTime;
+        particle.position += particle.velocity * deltaTime;
+        particle.rotation += particle.rotationSpeed * deltaTime;
+        particle.life -= deltaTime;
+
+        float lifeRatio = particle.life / particle.maxLife;
+        particle.color.a = lifeRatio;
+        if (lifeRatio < 0.3f) {
+            particle.color.a *= lifeRatio / 0.3f;
+        }
+    }
+
+    const float DELTA_TIME = 1.0f / 60.0f;
+
+    template <typename Function>
+    double MeasureParticlesPerSecond(size_t count, int frames, Function update) {
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            update();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return count * (double)frames / seconds;
+    }
+
+    void PrintResult(const char* name, double particlesPerSecond, double baseline) {
+        std::cout << "  " << std::left << std::setw(10) << name << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1) << particlesPerSecond / 1e6 << " M particles/s"
+                  << std::setw(8) << std::setprecision(2) << particlesPerSecond / baseline << "x" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 200;
+    const size_t counts[] = { 10000, 100000, 1000000 };
+
+    std::cout << "Particle update benchmark (" << frames << " frames, best level: "
+              << GetSimdLevelName(DetectSimdLevel()) << ")" << std::endl;
+
+    for (size_t count : counts) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        // Lifetimes long enough that nothing expires during the run
+        std::vector<LegacyParticle> legacy(count);
+        ParticleData particles;
+        particles.Resize(count);
+        for (size_t i = 0; i < count; i++) {
+            LegacyParticle& particle = legacy[i];
+            particle.position = glm::vec3(unit(rng), unit(rng), unit(rng));
+            particle.velocity = glm::vec3(unit(rng), unit(rng), unit(rng));
+            particle.acceleration = glm::vec3(0.0f, -9.81f, 0.0f);
+            particle.color = glm::vec4(1.0f);
+            particle.maxLife = particle.life = 1000.0f + unit(rng);
+            particle.size = 0.1f;
+            particle.rotation = 0.0f;
+            particle.rotationSpeed = unit(rng) * 180.0f;
+
+            particles.px[i] = particle.position.x;
+            particles.py[i] = particle.position.y;
+            particles.pz[i] = particle.position.z;
+            particles.vx[i] = particle.velocity.x;
+            particles.vy[i] = particle.velocity.y;
+            particles.vz[i] = particle.velocity.z;
+            particles.ax[i] = particle.acceleration.x;
+            particles.ay[i] = particle.acceleration.y;
+            particles.az[i] = particle.acceleration.z;
+            particles.r[i] = particles.g[i] = particles.b[i] = particles.a[i] = 1.0f;
+            particles.life[i] = particles.maxLife[i] = particle.life;
+            particles.size[i] = particle.size;
+            particles.rotation[i] = particle.rotation;
+            particles.rotationSpeed[i] = particle.rotationSpeed;
+        }
+
+        std::cout << "\n" << count << " particles" << std::endl;
+
+        double baseline = MeasureParticlesPerSecond(count, frames, [&legacy] {
+            for (auto& particle : legacy) {
+                UpdateLegacyParticle(particle, DELTA_TIME);
+            }
+        });
+        PrintResult("AoS", baseline, baseline);
+
+        const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+        for (SimdLevel level : levels) {
+            if ((int)level > (int)DetectSimdLevel()) break;
+
+            ParticleUpdateKernel kernel = GetParticleUpdateKernel(level);
+            double result = MeasureParticlesPerSecond(count, frames, [&particles, kernel, count] {
+                kernel(particles, 0, count, DELTA_TIME);
+            });
+            PrintResult(GetSimdLevelName(level), result, baseline);
+        }
+    }
+
+    // A 50k burst draws seven random floats per particle
+    const size_t burst = 50000;
+    const size_t floatsPerParticle = 7;
+    std::vector<float> values(burst);
+    std::cout << "\nEmission randomness (" << burst << " particle burst)" << std::endl;
+
+    std::mt19937 mersenne(1234);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    double baseline = MeasureParticlesPerSecond(burst, frames, [&] {
+        for (size_t stream = 0; stream < floatsPerParticle; stream++) {
+            for (float& value : values) {
+                value = -1.0f + distribution(mersenne) * 2.0f;
+            }
+        }
+    });
+    PrintResult("mt19937", baseline, baseline);
+
+    Xoshiro128Plus xoshiro(1234);
+    double result = MeasureParticlesPerSecond(burst, frames, [&] {
+        for (size_t stream = 0; stream < floatsPerParticle; stream++) {
+            xoshiro.FillUniform(values.data(), burst, -1.0f, 1.0f);
+        }
+    });
+    PrintResult("xoshiro", result, baseline);
+
+    Philox4x32 philox(1234);
+    uint64_t index = 0;
+    result = MeasureParticlesPerSecond(burst, frames, [&] {
+        for (size_t stream = 0; stream < floatsPerParticle; stream++) {
+            philox.FillUniform(values.data(), burst, -1.0f, 1.0f, index);
+            index += burst;
+        }
+    });
+    PrintResult("philox", result, baseline);
+
+    // Force modules relative to the plain update kernel
+    const size_t forceCount = 100000;
+    ParticleData particles;
+    particles.Resize(forceCount);
+    Xoshiro128Plus random(1234);
+    for (AlignedFloatArray* stream : { &particles.px, &particles.py, &particles.pz, &particles.vx, &particles.vy, &particles.vz }) {
+        random.FillUniform(stream->data(), forceCount, -4.0f, 4.0f);
+    }
+    std::cout << "\nForce modules (" << forceCount << " particles)" << std::endl;
+
+    ParticleUpdateKernel kernel = GetParticleUpdateKernel(DetectSimdLevel());
+    baseline = MeasureParticlesPerSecond(forceCount, frames, [&] {
+        kernel(particles, 0, forceCount, 0.0f);
+    });
+    PrintResult("Update", baseline, baseline);
+
+    std::vector<glm::vec3> vectors(16 * 16 * 16, glm::vec3(0.0f, 1.0f, 0.0f));
+    VectorFieldForce field;
+    field.SetField(glm::ivec3(16), glm::vec3(-4.0f), glm::vec3(4.0f), vectors);
+    CurlNoiseForce curl(1.0f, 0.5f);
+    AttractorForce attractor(glm::vec3(0.0f), 1.0f, 4.0f);
+    VortexForce vortex(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 1.0f, 4.0f);
+    DragForce drag(0.1f, 0.01f);
+    const ParticleForce* forces[] = { &curl, &attractor, &vortex, &drag, &field };
+    for (const ParticleForce* force : forces) {
+        // A zero step leaves the particles unchanged between frames
+        result = MeasureParticlesPerSecond(forceCount, frames, [&] {
+            force->Apply(particles, 0, forceCount, 0.0f, 0.0f);
+        });
+        PrintResult(force->GetName(), result, baseline);
+    }
+
+    return 0;
+}
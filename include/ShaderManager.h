@@ -20,6 +20,13 @@ public:
 		const char* vertex_file_path, 
 		const char* fragment_file_path);
 
+	// Vertex-only program whose outputs are captured with transform
+	// feedback (interleaved, in the order given); rasterization is unused
+	GLuint LoadTransformFeedbackShader(
+		const char* vertex_file_path,
+		const char* const* varyings,
+		int varyingCount);
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
@@ -27,77 +34,84 @@ public:
 		glUseProgram(m_programID);
 	}
 
-	// utility uniform functions
+	// utility uniform functions (names are C strings, so literals do not
+	// build a std::string per call)
 	// ------------------------------------------------------------------------
-	inline void setBoolValue(const std::string &name, bool value) const
+	inline void setBoolValue(const char* name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		glUniform1i(glGetUniformLocation(m_programID, name), (int)value);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setIntValue(const std::string &name, int value) const
+	inline void setIntValue(const char* name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1i(glGetUniformLocation(m_programID, name), value);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setFloatValue(const std::string &name, float value) const
+	inline void setFloatValue(const char* name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1f(glGetUniformLocation(m_programID, name), value);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
+	inline void setVec2Value(const char* name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform2fv(glGetUniformLocation(m_programID, name), 1, &value[0]);
 	}
 
-	inline void setVec2Value(const std::string &name, float x, float y) const
+	inline void setVec2Value(const char* name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		glUniform2f(glGetUniformLocation(m_programID, name), x, y);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
+	inline void setVec3Value(const char* name, const glm::vec3 &value) const
+	{
+		glUniform3fv(glGetUniformLocation(m_programID, name), 1, &value[0]);
+	}
+	inline void setVec3Value(const char* name, float x, float y, float z) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform3f(glGetUniformLocation(m_programID, name), x, y, z);
 	}
-	inline void setVec3Value(const std::string &name, float x, float y, float z) const
+
+	// ------------------------------------------------------------------------
+	inline void setIVec3Value(const char* name, int x, int y, int z) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		glUniform3i(glGetUniformLocation(m_programID, name), x, y, z);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
+	inline void setVec4Value(const char* name, const glm::vec4 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform4fv(glGetUniformLocation(m_programID, name), 1, &value[0]);
 	}
-	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
+	inline void setVec4Value(const char* name, float x, float y, float z, float w)
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		glUniform4f(glGetUniformLocation(m_programID, name), x, y, z, w);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
+	inline void setMat2Value(const char* name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix2fv(glGetUniformLocation(m_programID, name), 1, GL_FALSE, &mat[0][0]);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
+	inline void setMat3Value(const char* name, const glm::mat3 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix3fv(glGetUniformLocation(m_programID, name), 1, GL_FALSE, &mat[0][0]);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
+	inline void setMat4Value(const char* name, const glm::mat4 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		glUniformMatrix4fv(glGetUniformLocation(m_programID, name), 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setSampler2DValue(const std::string& name, const int &value) const
+	inline void setSampler2DValue(const char* name, const int &value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1i(glGetUniformLocation(m_programID, name), value);
 	}
 };
\ No newline at end of file
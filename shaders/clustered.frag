@@ -0,0 +1,156 @@
+#version 330 core
+
+// Clustered forward lighting shader
+// Point and spot lights are read from buffer textures filled by
+// ClusteredLighting; each fragment only loops over its cluster's lights.
+
+// Input from vertex shader
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+// Output color
+out vec4 FragColor;
+
+// Material structure
+struct Material {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+};
+
+// Directional light
+struct DirLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float intensity;
+};
+
+// Uniforms
+uniform Material material;
+uniform DirLight dirLight;
+uniform vec3 viewPos;
+uniform vec3 ambientLight;
+uniform mat4 view;
+
+// Cluster data (4 texels per light: position/range, color/type,
+// direction/cos inner cone, attenuation/cos outer cone)
+uniform samplerBuffer clusterLightData;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer clusterLightIndices;
+uniform ivec3 clusterDims;
+uniform vec2 clusterTileSize;
+uniform float clusterSliceScale;
+uniform float clusterSliceBias;
+
+// Texture
+uniform sampler2D diffuseTexture;
+uniform bool useTexture;
+
+// Function prototypes
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
+vec3 CalcClusterLight(int lightIndex, vec3 normal, vec3 fragPos, vec3 viewDir);
+int GetClusterIndex(vec3 fragPos);
+
+void main()
+{
+    // Normalize the normal vector
+    vec3 norm = normalize(Normal);
+
+    // Calculate view direction
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    // Ambient and directional light
+    vec3 result = ambientLight * material.ambient;
+    result += CalcDirLight(dirLight, norm, viewDir);
+
+    // Only the lights binned into this fragment's cluster
+    uvec2 cluster = texelFetch(clusterGrid, GetClusterIndex(FragPos)).xy;
+    for (uint i = 0u; i < cluster.y; i++) {
+        int lightIndex = int(texelFetch(clusterLightIndices, int(cluster.x + i)).r);
+        result += CalcClusterLight(lightIndex, norm, FragPos, viewDir);
+    }
+
+    // Apply texture if available
+    if (useTexture) {
+        vec4 texColor = texture(diffuseTexture, TexCoord);
+        result *= texColor.rgb;
+    }
+
+    // Output final color
+    FragColor = vec4(result, 1.0);
+}
+
+// Map a fragment to its froxel (must match ClusteredLighting::GetDepthSlice)
+int GetClusterIndex(vec3 fragPos)
+{
+    float depth = -(view * vec4(fragPos, 1.0)).z;
+    int slice = int(max(log(depth) * clusterSliceScale - clusterSliceBias, 0.0));
+    slice = min(slice, clusterDims.z - 1);
+
+    ivec2 tile = ivec2(gl_FragCoord.xy / clusterTileSize);
+    tile = clamp(tile, ivec2(0), clusterDims.xy - 1);
+
+    return tile.x + tile.y * clusterDims.x + slice * clusterDims.x * clusterDims.y;
+}
+
+// Calculate directional light contribution
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 lightDir = normalize(-light.direction);
+
+    // Diffuse
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * material.diffuse;
+
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = light.specular * spec * material.specular;
+
+    return (light.ambient * material.ambient + diffuse + specular) * light.intensity;
+}
+
+// Calculate point or spot light contribution from the light buffer
+vec3 CalcClusterLight(int lightIndex, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    int base = lightIndex * 4;
+    vec4 positionRange = texelFetch(clusterLightData, base);
+    vec4 colorType = texelFetch(clusterLightData, base + 1);
+    vec4 directionInner = texelFetch(clusterLightData, base + 2);
+    vec4 attenuationOuter = texelFetch(clusterLightData, base + 3);
+
+    vec3 toLight = positionRange.xyz - fragPos;
+    float distance = length(toLight);
+    if (distance >= positionRange.w) {
+        return vec3(0.0);
+    }
+    vec3 lightDir = toLight / distance;
+
+    // Attenuation, windowed to reach zero at the cluster range
+    float attenuation = 1.0 / (attenuationOuter.x + attenuationOuter.y * distance +
+                               attenuationOuter.z * (distance * distance));
+    float window = clamp(1.0 - pow(distance / positionRange.w, 4.0), 0.0, 1.0);
+    attenuation *= window * window;
+
+    // Spot cone
+    if (colorType.w > 1.5) {
+        float theta = dot(lightDir, normalize(-directionInner.xyz));
+        float epsilon = directionInner.w - attenuationOuter.w;
+        attenuation *= clamp((theta - attenuationOuter.w) / epsilon, 0.0, 1.0);
+    }
+
+    // Diffuse
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = colorType.rgb * diff * material.diffuse;
+
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = colorType.rgb * spec * material.specular;
+
+    return (diffuse + specular) * attenuation;
+}
@@ -0,0 +1,96 @@
+#version 330 core
+
+// Deferred lighting shader
+// lightType 0: ambient + directional (fullscreen), 1: point volume, 2: spot volume
+
+out vec4 FragColor;
+
+// G-buffer
+uniform sampler2D gAlbedoSpec;
+uniform sampler2D gNormalMaterial;
+uniform sampler2D gDepth;
+uniform vec2 screenSize;  // render size; the G-buffer may be larger (lower-left corner used)
+uniform mat4 inverseViewProjection;
+uniform vec3 viewPos;
+
+// Light parameters
+uniform int lightType;
+uniform vec3 ambientLight;
+uniform vec3 lightPosition;
+uniform vec3 lightDirection;
+uniform vec3 lightColor;
+uniform vec3 lightAttenuation;  // constant, linear, quadratic
+uniform float lightRange;
+uniform float lightCutOff;      // cosine of inner cone
+uniform float lightOuterCutOff; // cosine of outer cone
+
+vec3 DecodeNormal(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    float depth = texelFetch(gDepth, texel, 0).r;
+    if (depth >= 1.0) {
+        discard; // background
+    }
+
+    // Reconstruct world position from depth
+    vec4 clip = vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec3 fragPos = world.xyz / world.w;
+
+    vec4 albedoSpec = texelFetch(gAlbedoSpec, texel, 0);
+    vec4 normalMaterial = texelFetch(gNormalMaterial, texel, 0);
+    vec3 albedo = albedoSpec.rgb;
+    vec3 normal = DecodeNormal(normalMaterial.xy);
+    float shininess = normalMaterial.z;
+    vec3 viewDir = normalize(viewPos - fragPos);
+
+    vec3 lightDir;
+    float attenuation = 1.0;
+    vec3 result = vec3(0.0);
+
+    if (lightType == 0) {
+        lightDir = normalize(-lightDirection);
+        result = ambientLight * albedo * normalMaterial.w;
+    } else {
+        vec3 toLight = lightPosition - fragPos;
+        float distance = length(toLight);
+        if (distance >= lightRange) {
+            discard;
+        }
+        lightDir = toLight / distance;
+
+        // Attenuation, windowed to reach zero at the volume boundary
+        attenuation = 1.0 / (lightAttenuation.x + lightAttenuation.y * distance +
+                             lightAttenuation.z * (distance * distance));
+        float window = clamp(1.0 - pow(distance / lightRange, 4.0), 0.0, 1.0);
+        attenuation *= window * window;
+
+        if (lightType == 2) {
+            float theta = dot(lightDir, normalize(-lightDirection));
+            float epsilon = lightCutOff - lightOuterCutOff;
+            attenuation *= clamp((theta - lightOuterCutOff) / epsilon, 0.0, 1.0);
+        }
+    }
+
+    // Diffuse
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = lightColor * diff * albedo;
+
+    // Specular
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = lightColor * spec * albedoSpec.a * albedo;
+
+    result += (diffuse + specular) * attenuation;
+    FragColor = vec4(result, 1.0);
+}
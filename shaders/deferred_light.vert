@@ -0,0 +1,12 @@
+#version 330 core
+
+// Deferred lighting vertex shader
+// Draws either a fullscreen triangle (mvp = identity) or a light volume
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 mvp;
+
+void main()
+{
+    gl_Position = mvp * vec4(aPos, 1.0);
+}
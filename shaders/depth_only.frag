@@ -0,0 +1,6 @@
+#version 330 core
+
+// Depth/stencil-only passes: no color output
+void main()
+{
+}
@@ -0,0 +1,54 @@
+#version 330 core
+
+// G-buffer fill shader for the deferred path
+// RT0: albedo.rgb + specular reflectance (relative to albedo)
+// RT1: octahedral normal.xy + shininess + ambient reflectance (relative to albedo)
+
+// Input from vertex shader
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+// G-buffer outputs
+layout (location = 0) out vec4 gAlbedoSpec;
+layout (location = 1) out vec4 gNormalMaterial;
+
+// Material properties
+struct Material {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+};
+
+// Uniforms
+uniform Material material;
+
+// Texture
+uniform sampler2D diffuseTexture;
+uniform bool useTexture;
+
+// Octahedral normal encoding (two channels instead of three)
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.z >= 0.0 ? n.xy : folded;
+}
+
+void main()
+{
+    vec3 albedo = material.diffuse;
+    if (useTexture) {
+        albedo *= texture(diffuseTexture, TexCoord).rgb;
+    }
+
+    // The forward shaders use separate ambient/specular colors; the deferred
+    // path stores them as scalars relative to the albedo
+    float maxAlbedo = max(max(material.diffuse.r, max(material.diffuse.g, material.diffuse.b)), 0.001);
+    float specular = max(material.specular.r, max(material.specular.g, material.specular.b)) / maxAlbedo;
+    float ambient = max(material.ambient.r, max(material.ambient.g, material.ambient.b)) / maxAlbedo;
+
+    gAlbedoSpec = vec4(albedo, clamp(specular, 0.0, 1.0));
+    gNormalMaterial = vec4(EncodeNormal(normalize(Normal)), material.shininess, ambient);
+}
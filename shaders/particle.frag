@@ -2,6 +2,7 @@
 
 // Particle fragment shader
 in vec4 Color;
+in vec2 TexCoords;
 out vec4 FragColor;
 
 uniform sampler2D particleTexture;
@@ -11,7 +12,7 @@ void main()
 {
     if (useTexture) {
         // Use texture for particle
-        vec4 texColor = texture(particleTexture, gl_PointCoord);
+        vec4 texColor = texture(particleTexture, TexCoords);
         FragColor = Color * texColor;
     } else {
         // Use solid color
@@ -1,17 +1,32 @@
 #version 330 core
 
 // Particle vertex shader
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec4 aColor;
+// Expands one instance per particle into a camera-facing quad
+layout (location = 0) in vec2 aCorner;          // unit quad corner, -0.5..0.5
+layout (location = 1) in vec4 aPositionSize;    // instance: world position + size
+layout (location = 2) in float aRotation;       // instance: degrees around the view axis
+layout (location = 3) in vec4 aColor;           // instance: RGBA8, normalized
 
 out vec4 Color;
+out vec2 TexCoords;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
 void main()
 {
+    // Camera right and up vectors are the first two rows of the view rotation
+    vec3 cameraRight = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 cameraUp = vec3(view[0][1], view[1][1], view[2][1]);
+
+    float angle = radians(aRotation);
+    float s = sin(angle);
+    float c = cos(angle);
+    vec2 corner = vec2(aCorner.x * c - aCorner.y * s, aCorner.x * s + aCorner.y * c) * aPositionSize.w;
+
+    vec3 worldPos = aPositionSize.xyz + cameraRight * corner.x + cameraUp * corner.y;
+
     Color = aColor;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    TexCoords = aCorner + 0.5;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
 }
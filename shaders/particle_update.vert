@@ -0,0 +1,86 @@
+#version 330 core
+
+// Particle simulation shader (transform feedback, no rasterization)
+// Advances one particle per vertex; the outputs replace it in the other buffer
+layout (location = 0) in vec4 aPositionSize;      // world position + size
+layout (location = 1) in vec4 aVelocityRotation;  // velocity + rotation in degrees
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec3 aLife;              // life left, max life, rotation speed
+
+out vec4 outPositionSize;
+out vec4 outVelocityRotation;
+out vec4 outColor;
+out vec3 outLife;
+
+// Matches GpuEmitterBlock (std140)
+layout (std140) uniform Emitter {
+    vec4 emitterPosition;
+    vec4 velocityMin;
+    vec4 velocityMax;
+    vec4 acceleration;
+    vec4 emitterColor;
+    vec4 lifeSize;      // life min/max, size min/max
+    vec4 timing;        // x = delta time
+    ivec4 spawn;        // first slot, slot count, capacity, frame seed
+};
+
+// Alpha ramps down quadratically over the last 30% of a particle's life
+const float FADE_START = 0.3;
+
+uint Hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random(uint seed)
+{
+    return float(Hash(seed) >> 8) / 16777216.0;
+}
+
+void main()
+{
+    float deltaTime = timing.x;
+    float life = aLife.x;
+
+    // Dead slots inside this frame's spawn window are respawned
+    if (life <= 0.0) {
+        int windowOffset = (gl_VertexID - spawn.x + spawn.z) % spawn.z;
+        if (windowOffset < spawn.y) {
+            uint seed = Hash(uint(gl_VertexID) ^ Hash(uint(spawn.w))) * 8u;
+            vec3 random = vec3(Random(seed), Random(seed + 1u), Random(seed + 2u));
+            float maxLife = mix(lifeSize.x, lifeSize.y, Random(seed + 3u));
+
+            outPositionSize = vec4(emitterPosition.xyz, mix(lifeSize.z, lifeSize.w, Random(seed + 4u)));
+            outVelocityRotation = vec4(mix(velocityMin.xyz, velocityMax.xyz, random), Random(seed + 5u) * 360.0);
+            outColor = emitterColor;
+            outLife = vec3(maxLife, maxLife, mix(-180.0, 180.0, Random(seed + 6u)));
+        } else {
+            // Stays dead: zero size and alpha so the billboard is culled
+            outPositionSize = vec4(aPositionSize.xyz, 0.0);
+            outVelocityRotation = aVelocityRotation;
+            outColor = vec4(aColor.rgb, 0.0);
+            outLife = aLife;
+        }
+        return;
+    }
+
+    // Same operations and order as UpdateParticlesScalar
+    vec3 velocity = aVelocityRotation.xyz + acceleration.xyz * deltaTime;
+    vec3 position = aPositionSize.xyz + velocity * deltaTime;
+    float rotation = aVelocityRotation.w + aLife.z * deltaTime;
+    life -= deltaTime;
+
+    float ratio = life / aLife.y;
+    float alpha = ratio < FADE_START ? ratio * (ratio / FADE_START) : ratio;
+    bool alive = life > 0.0;
+
+    outPositionSize = vec4(position, alive ? aPositionSize.w : 0.0);
+    outVelocityRotation = vec4(velocity, rotation);
+    outColor = vec4(aColor.rgb, alive ? alpha : 0.0);
+    outLife = vec3(life, aLife.y, aLife.z);
+}
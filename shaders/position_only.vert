@@ -0,0 +1,19 @@
+#version 330 core
+
+// Depth pre-pass vertex shader
+// Reads only the position stream; the transform must match vertex.glsl
+// exactly so the shading pass can use GL_EQUAL depth testing.
+layout (location = 0) in vec3 aPos;
+
+// Uniform matrices
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+invariant gl_Position;
+
+void main()
+{
+    vec3 worldPos = vec3(model * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+// Ribbon fragment shader
+in vec4 Color;
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = Color;
+
+    // Discard transparent pixels
+    if (FragColor.a < 0.01) {
+        discard;
+    }
+}
@@ -0,0 +1,58 @@
+#version 330 core
+
+// Ribbon vertex shader
+// One instance per ribbon; vertices 2k and 2k+1 are the two edges at history
+// point k (0 = newest). Points past the recorded count collapse onto the
+// oldest one, so every ribbon uses the same vertex count.
+uniform samplerBuffer ribbonPoints;  // historyLength per ribbon: position, half width
+uniform samplerBuffer ribbonInfo;    // 2 per ribbon: (head, count), color
+uniform int historyLength;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec4 Color;
+
+vec4 FetchPoint(int ribbon, int head, int age)
+{
+    int index = (head - 1 - age + historyLength * 2) % historyLength;
+    return texelFetch(ribbonPoints, ribbon * historyLength + index);
+}
+
+void main()
+{
+    int ribbon = gl_InstanceID;
+    vec4 info = texelFetch(ribbonInfo, ribbon * 2);
+    int head = int(info.x);
+    int count = int(info.y);
+    vec4 color = texelFetch(ribbonInfo, ribbon * 2 + 1);
+
+    // Free or single-point ribbons draw nothing
+    if (count < 2) {
+        gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+        Color = vec4(0.0);
+        return;
+    }
+
+    int age = min(gl_VertexID / 2, count - 1);
+    float side = (gl_VertexID % 2 == 0) ? -1.0 : 1.0;
+    vec4 point = FetchPoint(ribbon, head, age);
+
+    // Direction along the ribbon from the neighboring points
+    vec3 newer = FetchPoint(ribbon, head, max(age - 1, 0)).xyz;
+    vec3 older = FetchPoint(ribbon, head, min(age + 1, count - 1)).xyz;
+    vec3 tangent = newer - older;
+
+    // Camera position from the view matrix: -R^T * t
+    vec3 cameraPosition = -transpose(mat3(view)) * view[3].xyz;
+    vec3 across = cross(tangent, cameraPosition - point.xyz);
+    float acrossLength = length(across);
+    across = acrossLength > 1e-6 ? across / acrossLength : vec3(0.0);
+
+    // Taper and fade towards the tail
+    float t = float(age) / float(count - 1);
+    vec3 worldPos = point.xyz + across * side * point.w * (1.0 - t);
+
+    Color = vec4(color.rgb, color.a * (1.0 - t));
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
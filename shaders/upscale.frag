@@ -0,0 +1,36 @@
+#version 330 core
+
+// Dynamic resolution upscale
+// sharpness 0: plain bilinear; > 0: bilinear plus a 5-tap unsharp mask
+// measured in source texels to recover detail lost to the lower resolution
+
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+uniform sampler2D sceneTexture;
+uniform vec2 uvScale;    // rendered size / target size
+uniform vec2 uvMax;      // last valid sample position in the rendered area
+uniform vec2 texelSize;  // 1 / target size
+uniform float sharpness;
+
+vec3 sampleScene(vec2 uv)
+{
+    return texture(sceneTexture, min(uv, uvMax)).rgb;
+}
+
+void main()
+{
+    vec2 uv = TexCoords * uvScale;
+    vec3 center = sampleScene(uv);
+
+    if (sharpness > 0.0) {
+        vec3 neighbors = sampleScene(uv + vec2(texelSize.x, 0.0)) +
+                         sampleScene(uv - vec2(texelSize.x, 0.0)) +
+                         sampleScene(uv + vec2(0.0, texelSize.y)) +
+                         sampleScene(uv - vec2(0.0, texelSize.y));
+        center = clamp(center + (center * 4.0 - neighbors) * sharpness, 0.0, 1.0);
+    }
+
+    FragColor = vec4(center, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+// Dynamic resolution upscale: fullscreen triangle
+layout (location = 0) in vec3 aPos;
+
+out vec2 TexCoords;
+
+void main()
+{
+    TexCoords = aPos.xy * 0.5 + 0.5;
+    gl_Position = vec4(aPos, 1.0);
+}
@@ -15,6 +15,9 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Must match position_only.vert for the depth pre-pass GL_EQUAL test
+invariant gl_Position;
+
 void main()
 {
     // Calculate world position
@@ -0,0 +1,221 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+namespace {
+    // Everything the hooks touch is constant-initialized, so allocations made
+    // during static initialization (before any constructor runs) are safe to count
+    struct TagCounters {
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> frees;
+    };
+    TagCounters g_counters[AllocationTracker::MAX_TAGS];
+
+    std::mutex g_tagMutex;
+    const char* g_tagNames[AllocationTracker::MAX_TAGS] = { "Untagged" };
+    std::atomic<int> g_tagCount{ 1 };
+
+    thread_local int t_tags[AllocationTracker::MAX_TAG_DEPTH];
+    thread_local int t_tagDepth = 0;
+}
+
+AllocationTracker::AllocationTracker()
+    : m_steadyStateCheck(false), m_steadyStateViolations(0) {
+}
+
+AllocationTracker& AllocationTracker::Get() {
+    static AllocationTracker tracker;
+    return tracker;
+}
+
+bool AllocationTracker::IsCompiledIn() {
+#ifdef ENABLE_ALLOCATION_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+int AllocationTracker::GetTag(const char* name) {
+    std::lock_guard<std::mutex> lock(g_tagMutex);
+    int count = g_tagCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (std::strcmp(g_tagNames[i], name) == 0) return i;
+    }
+    if (count == MAX_TAGS) {
+        std::cout << "Warning: Allocation tag limit reached, counting '" << name << "' as untagged!" << std::endl;
+        return UNTAGGED;
+    }
+    g_tagNames[count] = name;
+    g_tagCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+const char* AllocationTracker::GetTagName(int tag) const {
+    return tag >= 0 && tag < GetTagCount() ? g_tagNames[tag] : "Unknown";
+}
+
+int AllocationTracker::GetTagCount() const {
+    return g_tagCount.load(std::memory_order_acquire);
+}
+
+void AllocationTracker::PushTag(int tag) {
+    // Scopes nested deeper than the stack keep the innermost tracked tag
+    if (t_tagDepth < MAX_TAG_DEPTH) {
+        t_tags[t_tagDepth] = tag;
+    }
+    t_tagDepth++;
+}
+
+void AllocationTracker::PopTag() {
+    if (t_tagDepth > 0) {
+        t_tagDepth--;
+    }
+}
+
+int AllocationTracker::GetCurrentTag() {
+    if (t_tagDepth == 0) return UNTAGGED;
+    return t_tags[(t_tagDepth < MAX_TAG_DEPTH ? t_tagDepth : MAX_TAG_DEPTH) - 1];
+}
+
+void AllocationTracker::RecordAllocation(size_t bytes) {
+    TagCounters& counters = g_counters[GetCurrentTag()];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocationTracker::RecordFree() {
+    g_counters[GetCurrentTag()].frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::EndFrame() {
+    m_frameTotal = TagStats();
+    for (int i = 0; i < MAX_TAGS; i++) {
+        TagStats& frame = m_frameStats[i];
+        frame.allocations = g_counters[i].allocations.exchange(0, std::memory_order_relaxed);
+        frame.bytes = g_counters[i].bytes.exchange(0, std::memory_order_relaxed);
+        frame.frees = g_counters[i].frees.exchange(0, std::memory_order_relaxed);
+
+        m_sessionStats[i].allocations += frame.allocations;
+        m_sessionStats[i].bytes += frame.bytes;
+        m_sessionStats[i].frees += frame.frees;
+        m_frameTotal.allocations += frame.allocations;
+        m_frameTotal.bytes += frame.bytes;
+        m_frameTotal.frees += frame.frees;
+    }
+
+    if (m_steadyStateCheck && m_frameTotal.allocations > 0) {
+        m_steadyStateViolations++;
+        std::cout << "ERROR: Steady-state frame made " << m_frameTotal.allocations << " allocations ("
+                  << m_frameTotal.bytes << " bytes)!\n" << GetFrameReport() << std::flush;
+    }
+}
+
+std::string AllocationTracker::GetFrameReport() const {
+    std::string report;
+    char line[160];
+    for (int i = 0; i < GetTagCount(); i++) {
+        const TagStats& stats = m_frameStats[i];
+        if (stats.allocations == 0 && stats.frees == 0) continue;
+        std::snprintf(line, sizeof(line), "  %-20s %6llu allocations %10llu bytes %6llu frees\n", g_tagNames[i],
+                      (unsigned long long)stats.allocations, (unsigned long long)stats.bytes,
+                      (unsigned long long)stats.frees);
+        report += line;
+    }
+    return report;
+}
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+// Global allocation hooks, backed by malloc (aligned_alloc for over-aligned types)
+
+void* operator new(std::size_t size) {
+    AllocationTracker::RecordAllocation(size);
+    void* pointer = std::malloc(size ? size : 1);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    AllocationTracker::RecordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    AllocationTracker::RecordAllocation(size);
+    size_t align = (size_t)alignment;
+    size_t rounded = (size + align - 1) / align * align;
+#ifdef _MSC_VER
+    void* pointer = _aligned_malloc(rounded ? rounded : align, align);
+#else
+    void* pointer = std::aligned_alloc(align, rounded ? rounded : align);
+#endif
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer) return;
+    AllocationTracker::RecordFree();
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    if (!pointer) return;
+    AllocationTracker::RecordFree();
+#ifdef _MSC_VER
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    ::operator delete(pointer, alignment);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(pointer, alignment);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(pointer, alignment);
+}
+#endif
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Heap allocation counters per subsystem tag, for finding per-frame churn.
+// Building with ENABLE_ALLOCATION_TRACKING replaces the global operator
+// new/delete so every allocation on every thread is counted against the
+// innermost ALLOCATION_TAG of the allocating thread (ThreadPool workers
+// inherit the tag of the thread that submitted the job). The hooks only
+// touch atomics and a thread-local tag stack, so they never allocate
+// themselves. EndFrame() moves the counters into per-frame totals. With
+// the steady-state check on, any frame that allocates is reported and
+// counted as a violation. Without the build flag nothing is hooked and
+// every count stays zero.
+class AllocationTracker {
+public:
+    static constexpr int MAX_TAGS = 32;
+    static constexpr int MAX_TAG_DEPTH = 16;
+    // Tag 0 collects allocations made outside any ALLOCATION_TAG
+    static constexpr int UNTAGGED = 0;
+
+    struct TagStats {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t frees = 0;
+    };
+
+    static AllocationTracker& Get();
+    static bool IsCompiledIn();
+
+    // Index of the tag with this name, registering it on first use (name
+    // must be a string literal). Falls back to UNTAGGED once MAX_TAGS are in use.
+    int GetTag(const char* name);
+    const char* GetTagName(int tag) const;
+    int GetTagCount() const;
+
+    // The calling thread's tag stack
+    static void PushTag(int tag);
+    static void PopTag();
+    static int GetCurrentTag();
+
+    // Called by the operator new/delete replacements
+    static void RecordAllocation(size_t bytes);
+    static void RecordFree();
+
+    // Close the frame: per-tag counts since the last EndFrame() become the frame's
+    void EndFrame();
+    const TagStats& GetFrameStats(int tag) const { return m_frameStats[tag]; }
+    uint64_t GetFrameAllocationCount() const { return m_frameTotal.allocations; }
+    uint64_t GetFrameAllocatedBytes() const { return m_frameTotal.bytes; }
+    const TagStats& GetSessionStats(int tag) const { return m_sessionStats[tag]; }
+
+    // Steady-state check: every later frame that allocates is a violation
+    void SetSteadyStateCheck(bool enabled) { m_steadyStateCheck = enabled; }
+    bool GetSteadyStateCheck() const { return m_steadyStateCheck; }
+    size_t GetSteadyStateViolationCount() const { return m_steadyStateViolations; }
+
+    // Last frame's tags with allocations or frees, one per line
+    std::string GetFrameReport() const;
+
+private:
+    AllocationTracker();
+
+    TagStats m_frameStats[MAX_TAGS];
+    TagStats m_sessionStats[MAX_TAGS];
+    TagStats m_frameTotal;
+    bool m_steadyStateCheck;
+    size_t m_steadyStateViolations;
+};
+
+// Attributes the enclosing scope's allocations to a tag
+class AllocationScope {
+public:
+    explicit AllocationScope(int tag) { AllocationTracker::PushTag(tag); }
+    ~AllocationScope() { AllocationTracker::PopTag(); }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
+
+#define ALLOCATION_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_CONCAT(a, b) ALLOCATION_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+// name must be a string literal; the tag is looked up once per call site
+#define ALLOCATION_TAG(name) \
+    static const int ALLOCATION_CONCAT(allocationTag, __LINE__) = AllocationTracker::Get().GetTag(name); \
+    AllocationScope ALLOCATION_CONCAT(allocationScope, __LINE__)(ALLOCATION_CONCAT(allocationTag, __LINE__))
+#else
+#define ALLOCATION_TAG(name) ((void)0)
+#endif
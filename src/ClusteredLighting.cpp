@@ -0,0 +1,327 @@
+#include "ClusteredLighting.h"
+#include "Light.h"
+#include "MemoryTracker.h"
+#include "ShaderManager.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLUSTER_USE_SSE 1
+#endif
+
+ClusteredLighting::ClusteredLighting()
+    : m_fovDegrees(0.0f), m_width(0), m_height(0), m_nearPlane(0.0f), m_farPlane(0.0f),
+      m_sliceScale(0.0f), m_sliceBias(0.0f), m_maxLightsInCluster(0), m_overflowCount(0), m_buildTime(0.0f),
+      m_lightBuffer(0), m_lightTexture(0), m_gridBuffer(0), m_gridTexture(0),
+      m_indexBuffer(0), m_indexTexture(0) {
+    m_clusterLights.resize(CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER);
+    m_clusterCounts.resize(CLUSTER_COUNT, 0);
+    m_clusterGrid.resize(CLUSTER_COUNT * 2, 0);
+
+    // Sensible defaults until the first SetProjection call
+    SetProjection(45.0f, 1200, 800, 0.1f, 100.0f);
+}
+
+ClusteredLighting::~ClusteredLighting() {
+    Cleanup();
+}
+
+void ClusteredLighting::Initialize() {
+    std::cout << "Initializing Clustered Lighting..." << std::endl;
+
+    SetupBufferTexture(m_lightBuffer, m_lightTexture, GL_RGBA32F);
+    SetupBufferTexture(m_gridBuffer, m_gridTexture, GL_RG32UI);
+    SetupBufferTexture(m_indexBuffer, m_indexTexture, GL_R32UI);
+}
+
+void ClusteredLighting::Cleanup() {
+    GLuint textures[] = { m_lightTexture, m_gridTexture, m_indexTexture };
+    GLuint buffers[] = { m_lightBuffer, m_gridBuffer, m_indexBuffer };
+
+    if (m_lightTexture) {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+        for (GLuint buffer : buffers) {
+            MemoryTracker::Get().ReleaseBuffer(buffer);
+        }
+    }
+    m_lightBuffer = m_lightTexture = 0;
+    m_gridBuffer = m_gridTexture = 0;
+    m_indexBuffer = m_indexTexture = 0;
+}
+
+void ClusteredLighting::SetProjection(float fovDegrees, int width, int height, float nearPlane, float farPlane) {
+    if (fovDegrees == m_fovDegrees && width == m_width && height == m_height &&
+        nearPlane == m_nearPlane && farPlane == m_farPlane) {
+        return;
+    }
+
+    m_fovDegrees = fovDegrees;
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+
+    // slice = log(depth) * scale - bias, shared with clustered.frag
+    float logRatio = std::log(m_farPlane / m_nearPlane);
+    m_sliceScale = CLUSTER_Z / logRatio;
+    m_sliceBias = CLUSTER_Z * std::log(m_nearPlane) / logRatio;
+
+    BuildClusterBounds();
+}
+
+void ClusteredLighting::Update(const std::vector<std::shared_ptr<Light>>& lights, const glm::mat4& view) {
+    BuildClusters(lights, view);
+    UploadBuffers();
+}
+
+void ClusteredLighting::BuildClusters(const std::vector<std::shared_ptr<Light>>& lights, const glm::mat4& view) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    GatherLights(lights, view);
+
+    // Depth slices own disjoint clusters, so they can be binned in parallel
+    std::fill(m_clusterCounts.begin(), m_clusterCounts.end(), 0);
+    std::atomic<size_t> overflow(0);
+    ThreadPool::GetShared().ParallelFor(CLUSTER_Z, 1, [this, &overflow](size_t begin, size_t end) {
+        size_t localOverflow = 0;
+        for (size_t slice = begin; slice < end; slice++) {
+            BinSlice(static_cast<int>(slice), localOverflow);
+        }
+        overflow.fetch_add(localOverflow, std::memory_order_relaxed);
+    });
+    m_overflowCount = overflow.load();
+
+    CompactClusters();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_buildTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0f;
+}
+
+void ClusteredLighting::Bind(ShaderManager& shader, int firstTextureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture);
+    shader.setIntValue("clusterLightData", firstTextureUnit);
+
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit + 1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_gridTexture);
+    shader.setIntValue("clusterGrid", firstTextureUnit + 1);
+
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit + 2);
+    glBindTexture(GL_TEXTURE_BUFFER, m_indexTexture);
+    shader.setIntValue("clusterLightIndices", firstTextureUnit + 2);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setIVec3Value("clusterDims", CLUSTER_X, CLUSTER_Y, CLUSTER_Z);
+    shader.setVec2Value("clusterTileSize", (float)m_width / CLUSTER_X, (float)m_height / CLUSTER_Y);
+    shader.setFloatValue("clusterSliceScale", m_sliceScale);
+    shader.setFloatValue("clusterSliceBias", m_sliceBias);
+}
+
+int ClusteredLighting::GetDepthSlice(float viewDepth) const {
+    if (viewDepth <= m_nearPlane) return 0;
+    int slice = static_cast<int>(std::floor(std::log(viewDepth) * m_sliceScale - m_sliceBias));
+    return std::min(std::max(slice, 0), CLUSTER_Z - 1);
+}
+
+void ClusteredLighting::BuildClusterBounds() {
+    m_boundsMinX.resize(CLUSTER_COUNT);
+    m_boundsMinY.resize(CLUSTER_COUNT);
+    m_boundsMinZ.resize(CLUSTER_COUNT);
+    m_boundsMaxX.resize(CLUSTER_COUNT);
+    m_boundsMaxY.resize(CLUSTER_COUNT);
+    m_boundsMaxZ.resize(CLUSTER_COUNT);
+
+    float tanHalfFov = std::tan(glm::radians(m_fovDegrees) * 0.5f);
+    float aspect = (float)m_width / (float)m_height;
+    float depthRatio = m_farPlane / m_nearPlane;
+
+    for (int z = 0; z < CLUSTER_Z; z++) {
+        // Exponential slicing keeps clusters roughly cubic in view space
+        float sliceNear = m_nearPlane * std::pow(depthRatio, (float)z / CLUSTER_Z);
+        float sliceFar = m_nearPlane * std::pow(depthRatio, (float)(z + 1) / CLUSTER_Z);
+
+        for (int y = 0; y < CLUSTER_Y; y++) {
+            float ndcY0 = -1.0f + 2.0f * y / CLUSTER_Y;
+            float ndcY1 = -1.0f + 2.0f * (y + 1) / CLUSTER_Y;
+
+            for (int x = 0; x < CLUSTER_X; x++) {
+                float ndcX0 = -1.0f + 2.0f * x / CLUSTER_X;
+                float ndcX1 = -1.0f + 2.0f * (x + 1) / CLUSTER_X;
+
+                // The frustum widens with depth, so take the extremes of both caps
+                float xs[4] = { ndcX0 * sliceNear, ndcX0 * sliceFar, ndcX1 * sliceNear, ndcX1 * sliceFar };
+                float ys[4] = { ndcY0 * sliceNear, ndcY0 * sliceFar, ndcY1 * sliceNear, ndcY1 * sliceFar };
+
+                int index = GetClusterIndex(x, y, z);
+                m_boundsMinX[index] = *std::min_element(xs, xs + 4) * tanHalfFov * aspect;
+                m_boundsMaxX[index] = *std::max_element(xs, xs + 4) * tanHalfFov * aspect;
+                m_boundsMinY[index] = *std::min_element(ys, ys + 4) * tanHalfFov;
+                m_boundsMaxY[index] = *std::max_element(ys, ys + 4) * tanHalfFov;
+                m_boundsMinZ[index] = -sliceFar;
+                m_boundsMaxZ[index] = -sliceNear;
+            }
+        }
+    }
+}
+
+void ClusteredLighting::GatherLights(const std::vector<std::shared_ptr<Light>>& lights, const glm::mat4& view) {
+    m_viewSpheres.clear();
+    m_sliceRanges.clear();
+    m_lightTexels.clear();
+
+    for (const auto& light : lights) {
+        if (!light || !light->enabled || light->type == LightType::DIRECTIONAL) continue;
+
+        float range = light->GetRange();
+        if (range <= 0.0f) continue;
+
+        glm::vec4 viewPos = view * glm::vec4(light->position, 1.0f);
+        float depth = -viewPos.z;
+
+        // Entirely behind the camera or past the far plane
+        if (depth + range < m_nearPlane || depth - range > m_farPlane) continue;
+
+        m_viewSpheres.push_back(glm::vec4(viewPos.x, viewPos.y, viewPos.z, range));
+        m_sliceRanges.push_back(glm::ivec2(GetDepthSlice(depth - range), GetDepthSlice(depth + range)));
+
+        bool isSpot = light->type == LightType::SPOT;
+        m_lightTexels.push_back(glm::vec4(light->position, range));
+        m_lightTexels.push_back(glm::vec4(light->diffuse * light->intensity, isSpot ? 2.0f : 1.0f));
+        m_lightTexels.push_back(glm::vec4(light->direction, std::cos(glm::radians(light->cutOff))));
+        m_lightTexels.push_back(glm::vec4(light->constant, light->linear, light->quadratic,
+                                          std::cos(glm::radians(light->outerCutOff))));
+    }
+}
+
+void ClusteredLighting::BinSlice(int slice, size_t& overflow) {
+    const int sliceBase = slice * CLUSTER_X * CLUSTER_Y;
+    const int sliceSize = CLUSTER_X * CLUSTER_Y;
+
+    for (size_t lightIndex = 0; lightIndex < m_viewSpheres.size(); lightIndex++) {
+        const glm::ivec2& range = m_sliceRanges[lightIndex];
+        if (slice < range.x || slice > range.y) continue;
+
+        const glm::vec4& sphere = m_viewSpheres[lightIndex];
+        float radiusSq = sphere.w * sphere.w;
+
+        // Sphere vs AABB: squared distance from the center to the box
+        int i = 0;
+#ifdef CLUSTER_USE_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 cx = _mm_set1_ps(sphere.x);
+        const __m128 cy = _mm_set1_ps(sphere.y);
+        const __m128 cz = _mm_set1_ps(sphere.z);
+        const __m128 r2 = _mm_set1_ps(radiusSq);
+
+        for (; i + 4 <= sliceSize; i += 4) {
+            int index = sliceBase + i;
+            __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_boundsMinX[index]), cx), zero),
+                                   _mm_max_ps(_mm_sub_ps(cx, _mm_loadu_ps(&m_boundsMaxX[index])), zero));
+            __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_boundsMinY[index]), cy), zero),
+                                   _mm_max_ps(_mm_sub_ps(cy, _mm_loadu_ps(&m_boundsMaxY[index])), zero));
+            __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_boundsMinZ[index]), cz), zero),
+                                   _mm_max_ps(_mm_sub_ps(cz, _mm_loadu_ps(&m_boundsMaxZ[index])), zero));
+            __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+            int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, r2));
+            while (mask) {
+                int lane = 0;
+                while (!(mask & (1 << lane))) lane++;
+                mask &= ~(1 << lane);
+
+                int cluster = index + lane;
+                uint32_t& count = m_clusterCounts[cluster];
+                if (count < MAX_LIGHTS_PER_CLUSTER) {
+                    m_clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER + count++] = static_cast<uint32_t>(lightIndex);
+                } else {
+                    overflow++;
+                }
+            }
+        }
+#endif
+        for (; i < sliceSize; i++) {
+            int cluster = sliceBase + i;
+            float dx = std::max(m_boundsMinX[cluster] - sphere.x, 0.0f) + std::max(sphere.x - m_boundsMaxX[cluster], 0.0f);
+            float dy = std::max(m_boundsMinY[cluster] - sphere.y, 0.0f) + std::max(sphere.y - m_boundsMaxY[cluster], 0.0f);
+            float dz = std::max(m_boundsMinZ[cluster] - sphere.z, 0.0f) + std::max(sphere.z - m_boundsMaxZ[cluster], 0.0f);
+            if (dx * dx + dy * dy + dz * dz > radiusSq) continue;
+
+            uint32_t& count = m_clusterCounts[cluster];
+            if (count < MAX_LIGHTS_PER_CLUSTER) {
+                m_clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER + count++] = static_cast<uint32_t>(lightIndex);
+            } else {
+                overflow++;
+            }
+        }
+    }
+}
+
+void ClusteredLighting::CompactClusters() {
+    uint32_t total = 0;
+    m_maxLightsInCluster = 0;
+    for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++) {
+        m_clusterGrid[cluster * 2] = total;
+        m_clusterGrid[cluster * 2 + 1] = m_clusterCounts[cluster];
+        total += m_clusterCounts[cluster];
+        m_maxLightsInCluster = std::max(m_maxLightsInCluster, (int)m_clusterCounts[cluster]);
+    }
+
+    m_indexList.resize(total);
+    for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++) {
+        std::copy_n(&m_clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER], m_clusterCounts[cluster],
+                    m_indexList.begin() + m_clusterGrid[cluster * 2]);
+    }
+}
+
+void ClusteredLighting::UploadBuffers() {
+    if (!m_lightBuffer) return;
+
+    // Buffer textures must never be empty, so always upload at least one element
+    static const glm::vec4 emptyTexel(0.0f);
+    static const uint32_t emptyIndex = 0;
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_lightBuffer);
+    if (m_lightTexels.empty()) {
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), &emptyTexel, GL_STREAM_DRAW);
+    } else {
+        glBufferData(GL_TEXTURE_BUFFER, m_lightTexels.size() * sizeof(glm::vec4), m_lightTexels.data(), GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, m_clusterGrid.size() * sizeof(uint32_t), m_clusterGrid.data(), GL_STREAM_DRAW);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_indexBuffer);
+    if (m_indexList.empty()) {
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(uint32_t), &emptyIndex, GL_STREAM_DRAW);
+    } else {
+        glBufferData(GL_TEXTURE_BUFFER, m_indexList.size() * sizeof(uint32_t), m_indexList.data(), GL_STREAM_DRAW);
+    }
+
+    MemoryTracker& tracker = MemoryTracker::Get();
+    tracker.TrackBuffer(m_lightBuffer, std::max<size_t>(m_lightTexels.size(), 1) * sizeof(glm::vec4), MemoryCategory::Lighting);
+    tracker.TrackBuffer(m_gridBuffer, m_clusterGrid.size() * sizeof(uint32_t), MemoryCategory::Lighting);
+    tracker.TrackBuffer(m_indexBuffer, std::max<size_t>(m_indexList.size(), 1) * sizeof(uint32_t), MemoryCategory::Lighting);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::SetupBufferTexture(GLuint& buffer, GLuint& texture, GLenum format) {
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    MemoryTracker::Get().TrackBuffer(buffer, sizeof(glm::vec4), MemoryCategory::Lighting);
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
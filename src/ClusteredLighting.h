@@ -0,0 +1,97 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class Light;
+class ShaderManager;
+
+// Clustered forward lighting. Point and spot lights are binned on the CPU
+// into a view-space froxel grid (screen tiles x exponential depth slices),
+// and the per-cluster light lists are uploaded as buffer textures so
+// clustered.frag only shades the lights that can reach each fragment.
+class ClusteredLighting {
+public:
+    static constexpr int CLUSTER_X = 16;
+    static constexpr int CLUSTER_Y = 9;
+    static constexpr int CLUSTER_Z = 24;
+    static constexpr int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+    static constexpr int MAX_LIGHTS_PER_CLUSTER = 256;
+    static constexpr int TEXELS_PER_LIGHT = 4;
+
+    ClusteredLighting();
+    ~ClusteredLighting();
+
+    // Initialization
+    void Initialize();
+    void Cleanup();
+
+    // Rebuilds cluster bounds only when the parameters change
+    void SetProjection(float fovDegrees, int width, int height, float nearPlane, float farPlane);
+
+    // Bin lights for this frame and upload the result
+    void Update(const std::vector<std::shared_ptr<Light>>& lights, const glm::mat4& view);
+
+    // CPU half of Update(), usable without a GL context
+    void BuildClusters(const std::vector<std::shared_ptr<Light>>& lights, const glm::mat4& view);
+
+    // Bind the buffer textures starting at firstTextureUnit (3 units)
+    void Bind(ShaderManager& shader, int firstTextureUnit) const;
+
+    // Statistics
+    size_t GetLightCount() const { return m_viewSpheres.size(); }
+    size_t GetIndexCount() const { return m_indexList.size(); }
+    int GetMaxLightsInCluster() const { return m_maxLightsInCluster; }
+    size_t GetOverflowCount() const { return m_overflowCount; }
+    float GetBuildTime() const { return m_buildTime; }
+
+    // Cluster lookups (mainly for tests and debug views)
+    int GetClusterIndex(int x, int y, int z) const { return x + y * CLUSTER_X + z * CLUSTER_X * CLUSTER_Y; }
+    int GetDepthSlice(float viewDepth) const;
+    uint32_t GetClusterLightCount(int clusterIndex) const { return m_clusterGrid[clusterIndex * 2 + 1]; }
+    const uint32_t* GetClusterLights(int clusterIndex) const { return m_indexList.data() + m_clusterGrid[clusterIndex * 2]; }
+
+private:
+    // Projection parameters
+    float m_fovDegrees;
+    int m_width;
+    int m_height;
+    float m_nearPlane;
+    float m_farPlane;
+    float m_sliceScale;
+    float m_sliceBias;
+
+    // View-space cluster AABBs, structure-of-arrays for SIMD tests
+    std::vector<float> m_boundsMinX, m_boundsMinY, m_boundsMinZ;
+    std::vector<float> m_boundsMaxX, m_boundsMaxY, m_boundsMaxZ;
+
+    // Per-frame light data
+    std::vector<glm::vec4> m_viewSpheres;   // view-space center + range
+    std::vector<glm::ivec2> m_sliceRanges;  // first/last depth slice touched
+    std::vector<glm::vec4> m_lightTexels;   // TEXELS_PER_LIGHT per light
+
+    // Binning output
+    std::vector<uint32_t> m_clusterLights;  // MAX_LIGHTS_PER_CLUSTER per cluster
+    std::vector<uint32_t> m_clusterCounts;
+    std::vector<uint32_t> m_clusterGrid;    // offset, count per cluster
+    std::vector<uint32_t> m_indexList;
+    int m_maxLightsInCluster;
+    size_t m_overflowCount;
+    float m_buildTime;
+
+    // GPU resources
+    GLuint m_lightBuffer, m_lightTexture;
+    GLuint m_gridBuffer, m_gridTexture;
+    GLuint m_indexBuffer, m_indexTexture;
+
+    // Helper methods
+    void BuildClusterBounds();
+    void GatherLights(const std::vector<std::shared_ptr<Light>>& lights, const glm::mat4& view);
+    void BinSlice(int slice, size_t& overflow);
+    void CompactClusters();
+    void UploadBuffers();
+    void SetupBufferTexture(GLuint& buffer, GLuint& texture, GLenum format);
+};
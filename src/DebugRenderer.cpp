@@ -1,10 +1,14 @@
 #include "DebugRenderer.h"
+#include "AllocationTracker.h"
+#include "MemoryTracker.h"
 #include "ShaderManager.h"
+#include "StreamBuffer.h"
+#include "Profiler.h"
 #include <iostream>
 #include <cmath>
 
 DebugRenderer::DebugRenderer() 
-    : m_lineWidth(1.0f), m_depthTest(true), m_wireframeMode(false) {
+    : m_streamBuffer(nullptr), m_lineWidth(1.0f), m_depthTest(true), m_wireframeMode(false) {
     m_lineVAO = m_lineVBO = 0;
     m_boxVAO = m_boxVBO = 0;
 }
@@ -24,6 +28,7 @@ void DebugRenderer::Cleanup() {
     if (m_lineVAO) {
         glDeleteVertexArrays(1, &m_lineVAO);
         glDeleteBuffers(1, &m_lineVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_lineVBO);
     }
     if (m_boxVAO) {
         glDeleteVertexArrays(1, &m_boxVAO);
@@ -155,6 +160,8 @@ void DebugRenderer::DrawText(const std::string& text, const glm::vec2& position,
 
 void DebugRenderer::Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection) {
     if (m_lineVertices.empty()) return;
+    PROFILE_SCOPE("DebugRenderer::Render");
+    ALLOCATION_TAG("Debug");
     
     // Set matrices
     shader.setMat4Value("view", view);
@@ -171,13 +178,50 @@ void DebugRenderer::Render(ShaderManager& shader, const glm::mat4& view, const g
         glDisable(GL_DEPTH_TEST);
     }
     
+    // Upload interleaved position + color
+    const GLsizei stride = 6 * sizeof(float);
+    size_t dataSize = m_lineVertices.size() * stride;
+    GLuint buffer = m_lineVBO;
+    GLintptr offset = 0;
+
+    if (m_streamBuffer) {
+        StreamBuffer::Allocation allocation = m_streamBuffer->Allocate(dataSize, sizeof(float));
+        if (!allocation) return; // Segment full; the stream buffer grows next frame
+        WriteLineVertices((float*)allocation.data);
+        m_streamBuffer->Commit(allocation);
+        buffer = m_streamBuffer->GetBuffer();
+        offset = allocation.offset;
+    } else {
+        std::vector<float> data(m_lineVertices.size() * 6);
+        WriteLineVertices(data.data());
+        glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
+        glBufferData(GL_ARRAY_BUFFER, dataSize, data.data(), GL_DYNAMIC_DRAW);
+        MemoryTracker::Get().TrackBuffer(m_lineVBO, dataSize, MemoryCategory::Debug);
+    }
+
     // Render lines
     glBindVertexArray(m_lineVAO);
-    glBufferData(GL_ARRAY_BUFFER, m_lineVertices.size() * sizeof(glm::vec3), m_lineVertices.data(), GL_DYNAMIC_DRAW);
-    glDrawArrays(GL_LINES, 0, m_lineVertices.size());
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 3 * sizeof(float)));
+    glDrawArrays(GL_LINES, 0, (GLsizei)m_lineVertices.size());
     glBindVertexArray(0);
 }
 
+void DebugRenderer::WriteLineVertices(float* destination) const {
+    for (size_t i = 0; i < m_lineVertices.size(); i++) {
+        const glm::vec3& position = m_lineVertices[i];
+        const glm::vec3& color = m_lineColors[i];
+        destination[0] = position.x;
+        destination[1] = position.y;
+        destination[2] = position.z;
+        destination[3] = color.x;
+        destination[4] = color.y;
+        destination[5] = color.z;
+        destination += 6;
+    }
+}
+
 void DebugRenderer::Clear() {
     m_lineVertices.clear();
     m_lineColors.clear();
@@ -202,11 +246,10 @@ void DebugRenderer::SetupLineBuffers() {
     glGenBuffers(1, &m_lineVBO);
     
     glBindVertexArray(m_lineVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
     
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    // Position and color attributes (pointers are set per draw)
     glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
     
     glBindVertexArray(0);
 }
@@ -6,6 +6,7 @@
 #include <GL/glew.h>
 
 class ShaderManager;
+class StreamBuffer;
 
 class DebugRenderer {
 public:
@@ -37,11 +38,16 @@ public:
     void SetDepthTest(bool enabled);
     void SetWireframeMode(bool enabled);
 
+    // Stream line vertices through a shared per-frame buffer instead of a private VBO
+    void SetStreamBuffer(StreamBuffer* streamBuffer) { m_streamBuffer = streamBuffer; }
+    size_t GetLineCount() const { return m_lineVertices.size() / 2; }
+
 private:
     // Line rendering
     std::vector<glm::vec3> m_lineVertices;
     std::vector<glm::vec3> m_lineColors;
     GLuint m_lineVAO, m_lineVBO;
+    StreamBuffer* m_streamBuffer;
     
     // Box rendering
     std::vector<glm::vec3> m_boxVertices;
@@ -56,6 +62,7 @@ private:
     // Helper methods
     void SetupLineBuffers();
     void SetupBoxBuffers();
+    void WriteLineVertices(float* destination) const;
     void CreateBoxVertices(const glm::vec3& min, const glm::vec3& max);
     void CreateSphereVertices(const glm::vec3& center, float radius, int segments = 16);
     void CreateCylinderVertices(const glm::vec3& center, float radius, float height, int segments = 16);
@@ -0,0 +1,394 @@
+#include "DeferredRenderer.h"
+#include "Light.h"
+#include "MemoryTracker.h"
+#include "ShaderManager.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+DeferredRenderer::DeferredRenderer()
+    : m_width(0), m_height(0), m_viewportWidth(0), m_viewportHeight(0), m_gBufferFBO(0), m_lightFBO(0),
+      m_albedoSpecTexture(0), m_normalMaterialTexture(0), m_outputTexture(0), m_depthTexture(0),
+      m_lightDepthStencil(0),
+      m_fullscreenVAO(0), m_fullscreenVBO(0), m_sphereVAO(0), m_sphereVBO(0), m_sphereEBO(0),
+      m_sphereIndexCount(0), m_sphereBoundScale(1.0f), m_lightVolumeCount(0) {
+}
+
+DeferredRenderer::~DeferredRenderer() {
+    Cleanup();
+}
+
+bool DeferredRenderer::Initialize(int width, int height) {
+    std::cout << "Initializing Deferred Renderer..." << std::endl;
+
+    m_geometryShader = std::make_unique<ShaderManager>();
+    m_lightShader = std::make_unique<ShaderManager>();
+    m_stencilShader = std::make_unique<ShaderManager>();
+
+    if (m_geometryShader->LoadShaders("shaders/vertex.glsl", "shaders/gbuffer.frag") == 0 ||
+        m_lightShader->LoadShaders("shaders/deferred_light.vert", "shaders/deferred_light.frag") == 0 ||
+        m_stencilShader->LoadShaders("shaders/deferred_light.vert", "shaders/depth_only.frag") == 0) {
+        std::cout << "ERROR: Failed to load deferred shading shaders!" << std::endl;
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+    SetupGBuffer();
+    SetupFullscreenTriangle();
+    SetupSphereMesh(16, 8);
+
+    return true;
+}
+
+void DeferredRenderer::Cleanup() {
+    DeleteGBuffer();
+
+    if (m_fullscreenVAO) {
+        glDeleteVertexArrays(1, &m_fullscreenVAO);
+        glDeleteBuffers(1, &m_fullscreenVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_fullscreenVBO);
+        m_fullscreenVAO = m_fullscreenVBO = 0;
+    }
+    if (m_sphereVAO) {
+        glDeleteVertexArrays(1, &m_sphereVAO);
+        glDeleteBuffers(1, &m_sphereVBO);
+        glDeleteBuffers(1, &m_sphereEBO);
+        MemoryTracker::Get().ReleaseBuffer(m_sphereVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_sphereEBO);
+        m_sphereVAO = m_sphereVBO = m_sphereEBO = 0;
+    }
+}
+
+void DeferredRenderer::Resize(int width, int height) {
+    if (width == m_width && height == m_height) return;
+
+    m_width = width;
+    m_height = height;
+    SetViewport(m_viewportWidth, m_viewportHeight);
+
+    if (m_gBufferFBO) {
+        DeleteGBuffer();
+        SetupGBuffer();
+    }
+}
+
+void DeferredRenderer::SetViewport(int width, int height) {
+    m_viewportWidth = std::max(1, std::min(width, m_width));
+    m_viewportHeight = std::max(1, std::min(height, m_height));
+}
+
+ShaderManager& DeferredRenderer::BeginGeometryPass(const glm::mat4& view, const glm::mat4& projection) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_gBufferFBO);
+    glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+
+    GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glStencilMask(0xFF);
+    glDepthMask(GL_TRUE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDisable(GL_BLEND);
+
+    m_geometryShader->use();
+    m_geometryShader->setMat4Value("view", view);
+    m_geometryShader->setMat4Value("projection", projection);
+    return *m_geometryShader;
+}
+
+void DeferredRenderer::EndGeometryPass() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredRenderer::LightingPass(const std::vector<std::shared_ptr<Light>>& lights, const glm::vec3& ambientLight,
+                                    const glm::vec3& viewPos, const glm::mat4& view, const glm::mat4& projection) {
+    glm::mat4 viewProjection = projection * view;
+
+    // Light volumes depth-test against a copy of the G-buffer depth; testing
+    // against the sampled texture itself would be a feedback loop
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_gBufferFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_lightFBO);
+    glBlitFramebuffer(0, 0, m_viewportWidth, m_viewportHeight, 0, 0, m_viewportWidth, m_viewportHeight,
+                      GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_lightFBO);
+    glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glStencilMask(0xFF);
+    glClearStencil(0);
+    // Cleared once; each light volume's shading draw zeroes the pixels it marked
+    glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    glDepthMask(GL_FALSE);
+
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    m_lightShader->use();
+    BindGBufferTextures(*m_lightShader);
+    m_lightShader->setMat4Value("inverseViewProjection", glm::inverse(viewProjection));
+    m_lightShader->setVec3Value("viewPos", viewPos);
+    m_lightShader->setVec2Value("screenSize", (float)m_viewportWidth, (float)m_viewportHeight);
+
+    // Ambient + directional lights as fullscreen passes
+    glDisable(GL_DEPTH_TEST);
+    m_lightShader->setMat4Value("mvp", glm::mat4(1.0f));
+    m_lightShader->setIntValue("lightType", 0);
+
+    bool ambientApplied = false;
+    for (const auto& light : lights) {
+        if (!light->enabled || light->type != LightType::DIRECTIONAL) continue;
+
+        m_lightShader->setVec3Value("ambientLight", ambientApplied ? glm::vec3(0.0f) : ambientLight);
+        m_lightShader->setVec3Value("lightDirection", light->direction);
+        m_lightShader->setVec3Value("lightColor", light->diffuse * light->intensity);
+        glBindVertexArray(m_fullscreenVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        ambientApplied = true;
+    }
+    if (!ambientApplied) {
+        m_lightShader->setVec3Value("ambientLight", ambientLight);
+        m_lightShader->setVec3Value("lightColor", glm::vec3(0.0f));
+        glBindVertexArray(m_fullscreenVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // Point and spot lights as stencil-tested volumes
+    m_lightVolumeCount = 0;
+    glEnable(GL_STENCIL_TEST);
+    glBindVertexArray(m_sphereVAO);
+    for (const auto& light : lights) {
+        if (!light->enabled || light->type == LightType::DIRECTIONAL) continue;
+        DrawLightVolume(*light, viewProjection);
+        m_lightVolumeCount++;
+    }
+    glBindVertexArray(0);
+
+    // Restore state
+    glDisable(GL_STENCIL_TEST);
+    glDisable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredRenderer::Present(GLuint targetFramebuffer) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_lightFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+
+    int width = m_viewportWidth;
+    int height = m_viewportHeight;
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+}
+
+void DeferredRenderer::SetupGBuffer() {
+    auto createTexture = [this](GLuint& texture, GLint internalFormat, GLenum format, GLenum type) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_width, m_height, 0, format, type, NULL);
+        MemoryTracker::Get().TrackTexture(texture, MemoryTracker::GetTextureSize(m_width, m_height, internalFormat),
+                                          MemoryCategory::RenderTargets);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    };
+
+    createTexture(m_albedoSpecTexture, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    createTexture(m_normalMaterialTexture, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    createTexture(m_outputTexture, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    createTexture(m_depthTexture, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Geometry pass target
+    glGenFramebuffers(1, &m_gBufferFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_gBufferFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoSpecTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalMaterialTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR: G-buffer framebuffer not complete!" << std::endl;
+    }
+
+    // Lighting pass target; same depth format as the G-buffer so depth can be blitted
+    glGenRenderbuffers(1, &m_lightDepthStencil);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_lightDepthStencil);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    MemoryTracker::Get().TrackRenderbuffer(m_lightDepthStencil,
+                                           MemoryTracker::GetTextureSize(m_width, m_height, GL_DEPTH24_STENCIL8),
+                                           MemoryCategory::RenderTargets);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_lightFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_lightFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_outputTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_lightDepthStencil);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR: Deferred lighting framebuffer not complete!" << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredRenderer::DeleteGBuffer() {
+    if (m_gBufferFBO) {
+        glDeleteFramebuffers(1, &m_gBufferFBO);
+        glDeleteFramebuffers(1, &m_lightFBO);
+        m_gBufferFBO = m_lightFBO = 0;
+    }
+    if (m_albedoSpecTexture) {
+        GLuint textures[] = { m_albedoSpecTexture, m_normalMaterialTexture, m_outputTexture, m_depthTexture };
+        glDeleteTextures(4, textures);
+        for (GLuint texture : textures) {
+            MemoryTracker::Get().ReleaseTexture(texture);
+        }
+        m_albedoSpecTexture = m_normalMaterialTexture = m_outputTexture = m_depthTexture = 0;
+    }
+    if (m_lightDepthStencil) {
+        glDeleteRenderbuffers(1, &m_lightDepthStencil);
+        MemoryTracker::Get().ReleaseRenderbuffer(m_lightDepthStencil);
+        m_lightDepthStencil = 0;
+    }
+}
+
+void DeferredRenderer::SetupFullscreenTriangle() {
+    // One oversized triangle covers the viewport without a diagonal seam
+    const float vertices[] = {
+        -1.0f, -1.0f, 0.0f,
+         3.0f, -1.0f, 0.0f,
+        -1.0f,  3.0f, 0.0f
+    };
+
+    glGenVertexArrays(1, &m_fullscreenVAO);
+    glGenBuffers(1, &m_fullscreenVBO);
+
+    glBindVertexArray(m_fullscreenVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_fullscreenVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_fullscreenVBO, sizeof(vertices), MemoryCategory::RenderTargets);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+void DeferredRenderer::SetupSphereMesh(int segments, int rings) {
+    std::vector<glm::vec3> vertices;
+    std::vector<GLuint> indices;
+
+    for (int ring = 0; ring <= rings; ring++) {
+        float phi = (float)M_PI * ring / rings;
+        for (int segment = 0; segment <= segments; segment++) {
+            float theta = 2.0f * (float)M_PI * segment / segments;
+            vertices.push_back(glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)));
+        }
+    }
+
+    for (int ring = 0; ring < rings; ring++) {
+        for (int segment = 0; segment < segments; segment++) {
+            GLuint current = ring * (segments + 1) + segment;
+            GLuint next = current + segments + 1;
+
+            indices.push_back(current);
+            indices.push_back(current + 1);
+            indices.push_back(next);
+
+            indices.push_back(current + 1);
+            indices.push_back(next + 1);
+            indices.push_back(next);
+        }
+    }
+    m_sphereIndexCount = (GLsizei)indices.size();
+
+    // The tessellated faces sit inside the unit sphere; scale up so the
+    // mesh fully contains the light's range
+    m_sphereBoundScale = 1.0f / (std::cos((float)M_PI / segments) * std::cos((float)M_PI / (2.0f * rings)));
+
+    glGenVertexArrays(1, &m_sphereVAO);
+    glGenBuffers(1, &m_sphereVBO);
+    glGenBuffers(1, &m_sphereEBO);
+
+    glBindVertexArray(m_sphereVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_sphereVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_sphereEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_sphereVBO, vertices.size() * sizeof(glm::vec3), MemoryCategory::Lighting);
+    MemoryTracker::Get().TrackBuffer(m_sphereEBO, indices.size() * sizeof(GLuint), MemoryCategory::Lighting);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+void DeferredRenderer::BindGBufferTextures(ShaderManager& shader) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_albedoSpecTexture);
+    shader.setSampler2DValue("gAlbedoSpec", 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_normalMaterialTexture);
+    shader.setSampler2DValue("gNormalMaterial", 1);
+
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+    shader.setSampler2DValue("gDepth", 2);
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void DeferredRenderer::DrawLightVolume(const Light& light, const glm::mat4& viewProjection) {
+    float range = light.GetRange();
+    if (range <= 0.0f) return;
+
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), light.position);
+    model = glm::scale(model, glm::vec3(range * m_sphereBoundScale));
+    glm::mat4 mvp = viewProjection * model;
+
+    // Stencil pass: mark pixels whose geometry lies inside the volume
+    m_stencilShader->use();
+    m_stencilShader->setMat4Value("mvp", mvp);
+    glDrawBuffer(GL_NONE);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glStencilMask(0xFF);
+    glStencilFunc(GL_ALWAYS, 0, 0);
+    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+    glDrawElements(GL_TRIANGLES, m_sphereIndexCount, GL_UNSIGNED_INT, 0);
+
+    // Lighting pass: shade only the marked pixels, back faces so the
+    // camera can sit inside the volume. The back faces cover every marked
+    // pixel, so zeroing on pass leaves the stencil clear for the next light.
+    m_lightShader->use();
+    m_lightShader->setMat4Value("mvp", mvp);
+    m_lightShader->setIntValue("lightType", light.type == LightType::SPOT ? 2 : 1);
+    m_lightShader->setVec3Value("lightPosition", light.position);
+    m_lightShader->setVec3Value("lightDirection", light.direction);
+    m_lightShader->setVec3Value("lightColor", light.diffuse * light.intensity);
+    m_lightShader->setVec3Value("lightAttenuation", light.constant, light.linear, light.quadratic);
+    m_lightShader->setFloatValue("lightRange", range);
+    m_lightShader->setFloatValue("lightCutOff", std::cos(glm::radians(light.cutOff)));
+    m_lightShader->setFloatValue("lightOuterCutOff", std::cos(glm::radians(light.outerCutOff)));
+
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    glEnable(GL_BLEND);
+    glDrawElements(GL_TRIANGLES, m_sphereIndexCount, GL_UNSIGNED_INT, 0);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+
+class Light;
+class ShaderManager;
+
+// Optional deferred shading path. The scene is rasterized once into a
+// G-buffer (albedo/specular, octahedral normal/shininess/ambient, depth +
+// stencil); point and spot lights are then applied by drawing stencil-marked
+// sphere volumes so each light only shades the pixels it actually touches.
+// The lighting pass samples the G-buffer depth, so it tests against its own
+// copy in a separate renderbuffer rather than the texture it reads.
+//
+// Targets are allocated at window size; a smaller render size (dynamic
+// resolution) draws into their lower-left corner, so it never reallocates.
+class DeferredRenderer {
+public:
+    DeferredRenderer();
+    ~DeferredRenderer();
+
+    // Initialization
+    bool Initialize(int width, int height);
+    void Cleanup();
+    // Window size: reallocates the targets
+    void Resize(int width, int height);
+    // Render size for the next frames, clamped to the window size; no reallocation
+    void SetViewport(int width, int height);
+
+    // Geometry pass: binds the G-buffer and returns the shader to render the scene with
+    ShaderManager& BeginGeometryPass(const glm::mat4& view, const glm::mat4& projection);
+    void EndGeometryPass();
+
+    // Lighting pass: accumulates all lights into the G-buffer's output target
+    void LightingPass(const std::vector<std::shared_ptr<Light>>& lights, const glm::vec3& ambientLight,
+                      const glm::vec3& viewPos, const glm::mat4& view, const glm::mat4& projection);
+
+    // Copy the lit image and depth to a framebuffer so forward passes can draw on top
+    void Present(GLuint targetFramebuffer = 0);
+
+    // Statistics
+    int GetLightVolumeCount() const { return m_lightVolumeCount; }
+    GLuint GetDepthTexture() const { return m_depthTexture; }
+    int GetViewportWidth() const { return m_viewportWidth; }
+    int GetViewportHeight() const { return m_viewportHeight; }
+
+private:
+    int m_width;
+    int m_height;
+    int m_viewportWidth;
+    int m_viewportHeight;
+
+    // G-buffer and the lighting target with its copy of the depth
+    GLuint m_gBufferFBO;
+    GLuint m_lightFBO;
+    GLuint m_albedoSpecTexture;
+    GLuint m_normalMaterialTexture;
+    GLuint m_outputTexture;
+    GLuint m_depthTexture;
+    GLuint m_lightDepthStencil;
+
+    // Geometry for the lighting pass
+    GLuint m_fullscreenVAO, m_fullscreenVBO;
+    GLuint m_sphereVAO, m_sphereVBO, m_sphereEBO;
+    GLsizei m_sphereIndexCount;
+    float m_sphereBoundScale;
+
+    // Shaders
+    std::unique_ptr<ShaderManager> m_geometryShader;
+    std::unique_ptr<ShaderManager> m_lightShader;
+    std::unique_ptr<ShaderManager> m_stencilShader;
+
+    int m_lightVolumeCount;
+
+    // Helper methods
+    void SetupGBuffer();
+    void DeleteGBuffer();
+    void SetupFullscreenTriangle();
+    void SetupSphereMesh(int segments, int rings);
+    void BindGBufferTextures(ShaderManager& shader);
+    void DrawLightVolume(const Light& light, const glm::mat4& viewProjection);
+};
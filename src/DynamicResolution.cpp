@@ -0,0 +1,270 @@
+#include "DynamicResolution.h"
+#include "MemoryTracker.h"
+#include "ShaderManager.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Controller tuning. Frame cost is assumed to scale with pixel count
+    // (scale squared). Scale only moves when the smoothed time leaves the
+    // [LOWER, UPPER] band around the target, then aims for the band center;
+    // steps are quantized and followed by a cooldown so the controller
+    // settles instead of hunting around the budget.
+    const float SMOOTHING = 0.1f;
+    const float UPPER_BUDGET = 0.95f;
+    const float LOWER_BUDGET = 0.75f;
+    const float AIM_BUDGET = 0.85f;
+    const float MAX_STEP_DOWN = 0.15f;
+    const float MAX_STEP_UP = 0.05f;
+    const float SCALE_QUANTUM = 0.025f;
+    const int COOLDOWN_FRAMES = 20;
+}
+
+DynamicResolution::DynamicResolution()
+    : m_enabled(true), m_width(0), m_height(0),
+      m_scale(1.0f), m_minScale(0.5f), m_maxScale(1.0f), m_targetFrameTime(1000.0f / 60.0f),
+      m_smoothedFrameTime(0.0f), m_cooldownFrames(0), m_scaleChangeCount(0),
+      m_filter(UpscaleFilter::Sharpen), m_sharpness(0.25f),
+      m_framebuffer(0), m_colorTexture(0), m_depthStencilBuffer(0),
+      m_fullscreenVAO(0), m_fullscreenVBO(0), m_timerFrame(0) {
+    for (int i = 0; i < TIMER_FRAMES; i++) {
+        m_timestampQueries[i][0] = m_timestampQueries[i][1] = 0;
+        m_timerPending[i] = false;
+    }
+}
+
+DynamicResolution::~DynamicResolution() {
+    Cleanup();
+}
+
+bool DynamicResolution::Initialize(int width, int height) {
+    std::cout << "Initializing Dynamic Resolution..." << std::endl;
+
+    m_upscaleShader = std::make_unique<ShaderManager>();
+    if (m_upscaleShader->LoadShaders("shaders/upscale.vert", "shaders/upscale.frag") == 0) {
+        std::cout << "ERROR: Failed to load upscale shader!" << std::endl;
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    SetupTarget();
+    SetupFullscreenTriangle();
+    glGenQueries(TIMER_FRAMES * 2, &m_timestampQueries[0][0]);
+
+    return true;
+}
+
+void DynamicResolution::Cleanup() {
+    DeleteTarget();
+
+    if (m_fullscreenVAO) {
+        glDeleteVertexArrays(1, &m_fullscreenVAO);
+        glDeleteBuffers(1, &m_fullscreenVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_fullscreenVBO);
+        m_fullscreenVAO = m_fullscreenVBO = 0;
+    }
+    if (m_timestampQueries[0][0]) {
+        glDeleteQueries(TIMER_FRAMES * 2, &m_timestampQueries[0][0]);
+        for (int i = 0; i < TIMER_FRAMES; i++) {
+            m_timestampQueries[i][0] = m_timestampQueries[i][1] = 0;
+            m_timerPending[i] = false;
+        }
+    }
+}
+
+void DynamicResolution::Resize(int width, int height) {
+    if (width == m_width && height == m_height) return;
+
+    m_width = width;
+    m_height = height;
+
+    if (m_framebuffer) {
+        DeleteTarget();
+        SetupTarget();
+    }
+}
+
+void DynamicResolution::BeginScene() {
+    // Time the frame only if this slot's previous result has been consumed
+    bool timed = m_timestampQueries[m_timerFrame][0] && !m_timerPending[m_timerFrame];
+    if (timed) {
+        glQueryCounter(m_timestampQueries[m_timerFrame][0], GL_TIMESTAMP);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, GetRenderWidth(), GetRenderHeight());
+}
+
+void DynamicResolution::EndScene() {
+    if (m_timestampQueries[m_timerFrame][0] && !m_timerPending[m_timerFrame]) {
+        glQueryCounter(m_timestampQueries[m_timerFrame][1], GL_TIMESTAMP);
+        m_timerPending[m_timerFrame] = true;
+    }
+    m_timerFrame = (m_timerFrame + 1) % TIMER_FRAMES;
+
+    ReadTimers();
+}
+
+void DynamicResolution::Present(GLuint targetFramebuffer) {
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, m_width, m_height);
+    glDisable(GL_DEPTH_TEST);
+
+    int renderWidth = GetRenderWidth();
+    int renderHeight = GetRenderHeight();
+
+    m_upscaleShader->use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+    m_upscaleShader->setIntValue("sceneTexture", 0);
+
+    // Map the window to the rendered corner of the target, clamped half a
+    // texel inside it so bilinear taps never read past the rendered area
+    m_upscaleShader->setVec2Value("uvScale", (float)renderWidth / m_width, (float)renderHeight / m_height);
+    m_upscaleShader->setVec2Value("uvMax", (renderWidth - 0.5f) / m_width, (renderHeight - 0.5f) / m_height);
+    m_upscaleShader->setVec2Value("texelSize", 1.0f / m_width, 1.0f / m_height);
+    m_upscaleShader->setFloatValue("sharpness", m_filter == UpscaleFilter::Sharpen ? m_sharpness : 0.0f);
+
+    glBindVertexArray(m_fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DynamicResolution::Update(float gpuFrameTime) {
+    if (gpuFrameTime <= 0.0f) return;
+
+    if (m_smoothedFrameTime <= 0.0f) {
+        m_smoothedFrameTime = gpuFrameTime;
+    } else {
+        m_smoothedFrameTime += (gpuFrameTime - m_smoothedFrameTime) * SMOOTHING;
+    }
+
+    if (!m_enabled) return;
+    if (m_cooldownFrames > 0) {
+        m_cooldownFrames--;
+        return;
+    }
+
+    float load = m_smoothedFrameTime / m_targetFrameTime;
+    if (load <= UPPER_BUDGET && load >= LOWER_BUDGET) return;
+
+    // Pixel count follows scale squared, so aim for the band center
+    float desired = m_scale * std::sqrt(AIM_BUDGET / load);
+    desired = std::min(desired, m_scale + MAX_STEP_UP);
+    desired = std::max(desired, m_scale - MAX_STEP_DOWN);
+    desired = std::round(desired / SCALE_QUANTUM) * SCALE_QUANTUM;
+    desired = std::max(m_minScale, std::min(m_maxScale, desired));
+
+    if (std::fabs(desired - m_scale) < SCALE_QUANTUM * 0.5f) return;
+
+    // Predict the new cost so the filter doesn't keep pushing on stale history
+    float ratio = desired / m_scale;
+    m_smoothedFrameTime *= ratio * ratio;
+    m_scale = desired;
+    m_cooldownFrames = COOLDOWN_FRAMES;
+    m_scaleChangeCount++;
+}
+
+void DynamicResolution::SetEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!m_enabled) {
+        m_scale = m_maxScale;
+    }
+    m_cooldownFrames = 0;
+}
+
+void DynamicResolution::SetScaleBounds(float minScale, float maxScale) {
+    m_minScale = std::max(0.1f, std::min(minScale, 1.0f));
+    m_maxScale = std::max(m_minScale, std::min(maxScale, 1.0f));
+    m_scale = std::max(m_minScale, std::min(m_maxScale, m_scale));
+}
+
+int DynamicResolution::GetRenderWidth() const {
+    return std::max(1, (int)(m_width * m_scale + 0.5f));
+}
+
+int DynamicResolution::GetRenderHeight() const {
+    return std::max(1, (int)(m_height * m_scale + 0.5f));
+}
+
+void DynamicResolution::SetupTarget() {
+    glGenTextures(1, &m_colorTexture);
+    glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    MemoryTracker::Get().TrackTexture(m_colorTexture, MemoryTracker::GetTextureSize(m_width, m_height, GL_RGBA8),
+                                      MemoryCategory::RenderTargets);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &m_depthStencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    MemoryTracker::Get().TrackRenderbuffer(m_depthStencilBuffer, MemoryTracker::GetTextureSize(m_width, m_height, GL_DEPTH24_STENCIL8),
+                                           MemoryCategory::RenderTargets);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthStencilBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR: Dynamic resolution framebuffer not complete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::DeleteTarget() {
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteTextures(1, &m_colorTexture);
+        glDeleteRenderbuffers(1, &m_depthStencilBuffer);
+        MemoryTracker::Get().ReleaseTexture(m_colorTexture);
+        MemoryTracker::Get().ReleaseRenderbuffer(m_depthStencilBuffer);
+        m_framebuffer = m_colorTexture = m_depthStencilBuffer = 0;
+    }
+}
+
+void DynamicResolution::SetupFullscreenTriangle() {
+    const float vertices[] = {
+        -1.0f, -1.0f, 0.0f,
+         3.0f, -1.0f, 0.0f,
+        -1.0f,  3.0f, 0.0f
+    };
+
+    glGenVertexArrays(1, &m_fullscreenVAO);
+    glGenBuffers(1, &m_fullscreenVBO);
+
+    glBindVertexArray(m_fullscreenVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_fullscreenVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_fullscreenVBO, sizeof(vertices), MemoryCategory::RenderTargets);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+void DynamicResolution::ReadTimers() {
+    // Consume finished results oldest first; stop at the first one still in flight
+    for (int i = 0; i < TIMER_FRAMES; i++) {
+        int frame = (m_timerFrame + i) % TIMER_FRAMES;
+        if (!m_timerPending[frame]) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(m_timestampQueries[frame][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(m_timestampQueries[frame][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(m_timestampQueries[frame][1], GL_QUERY_RESULT, &end);
+        m_timerPending[frame] = false;
+
+        Update((end - start) / 1000000.0f);
+    }
+}
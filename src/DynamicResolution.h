@@ -0,0 +1,101 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+
+class ShaderManager;
+
+// Dynamic resolution scaling. The 3D scene is rendered into an offscreen
+// target at a fraction of the window size, and the fraction is adjusted from
+// a smoothed GPU frame time so the scene stays inside the frame budget. The
+// result is upscaled to the window before native-resolution overlays draw.
+//
+// The target is allocated at full window size and the scene is rendered into
+// its lower-left corner, so scale changes never reallocate textures.
+class DynamicResolution {
+public:
+    static constexpr int TIMER_FRAMES = 4;
+
+    enum class UpscaleFilter {
+        Bilinear,
+        Sharpen
+    };
+
+    DynamicResolution();
+    ~DynamicResolution();
+
+    // Initialization
+    bool Initialize(int width, int height);
+    void Cleanup();
+    void Resize(int width, int height);
+
+    // Scene rendering: binds the offscreen target at the current render size
+    void BeginScene();
+    void EndScene();
+
+    // Upscale the scene into a framebuffer at native resolution
+    void Present(GLuint targetFramebuffer = 0);
+
+    // Feed one GPU frame time (ms) to the controller. Called internally from
+    // EndScene() once a timer result is available; public for tests.
+    void Update(float gpuFrameTime);
+
+    // Settings
+    void SetEnabled(bool enabled);
+    void SetScaleBounds(float minScale, float maxScale);
+    void SetTargetFrameTime(float milliseconds) { m_targetFrameTime = milliseconds; }
+    void SetUpscaleFilter(UpscaleFilter filter) { m_filter = filter; }
+    void SetSharpness(float sharpness) { m_sharpness = sharpness; }
+
+    bool IsEnabled() const { return m_enabled; }
+    UpscaleFilter GetUpscaleFilter() const { return m_filter; }
+
+    // Render target information
+    float GetScale() const { return m_scale; }
+    int GetRenderWidth() const;
+    int GetRenderHeight() const;
+    GLuint GetFramebuffer() const { return m_framebuffer; }
+
+    // Statistics
+    float GetSmoothedFrameTime() const { return m_smoothedFrameTime; }
+    int GetScaleChangeCount() const { return m_scaleChangeCount; }
+
+private:
+    bool m_enabled;
+    int m_width;
+    int m_height;
+
+    // Controller state
+    float m_scale;
+    float m_minScale;
+    float m_maxScale;
+    float m_targetFrameTime;
+    float m_smoothedFrameTime;
+    int m_cooldownFrames;
+    int m_scaleChangeCount;
+
+    // Upscale settings
+    UpscaleFilter m_filter;
+    float m_sharpness;
+
+    // Offscreen target
+    GLuint m_framebuffer;
+    GLuint m_colorTexture;
+    GLuint m_depthStencilBuffer;
+
+    // Upscale pass
+    std::unique_ptr<ShaderManager> m_upscaleShader;
+    GLuint m_fullscreenVAO, m_fullscreenVBO;
+
+    // GPU timestamps, read back a few frames late to avoid stalling
+    GLuint m_timestampQueries[TIMER_FRAMES][2];
+    bool m_timerPending[TIMER_FRAMES];
+    int m_timerFrame;
+
+    // Helper methods
+    void SetupTarget();
+    void DeleteTarget();
+    void SetupFullscreenTriangle();
+    void ReadTimers();
+};
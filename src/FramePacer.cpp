@@ -0,0 +1,107 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <thread>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+namespace {
+    const float MIN_SPIN_THRESHOLD = 0.2f;
+    const float MAX_SPIN_THRESHOLD = 4.0f;
+    const float OVERSHOOT_SMOOTHING = 0.1f;
+
+    float ToMilliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+}
+
+FramePacer::FramePacer()
+    : m_targetFPS(0.0f), m_latencyReduction(false), m_started(false),
+      m_spinThreshold(1.0f), m_sleepOvershoot(0.0f), m_lastJitter(0.0f), m_lastWakeError(0.0f) {
+}
+
+FramePacer::~FramePacer() {
+}
+
+void FramePacer::SetTargetFPS(float fps) {
+    m_targetFPS = std::max(0.0f, fps);
+    Reset();
+}
+
+void FramePacer::Reset() {
+    m_started = false;
+    m_lastJitter = 0.0f;
+    m_lastWakeError = 0.0f;
+}
+
+void FramePacer::WaitForNextFrame() {
+    Clock::time_point now = Clock::now();
+
+    if (m_targetFPS <= 0.0f) {
+        m_lastWake = now;
+        m_started = true;
+        return;
+    }
+
+    Clock::duration period = GetPeriod();
+    if (!m_started) {
+        m_nextDeadline = now + period;
+        m_lastWake = now;
+        m_started = true;
+        return;
+    }
+
+    // Sleep through most of the wait, leaving a margin for oversleeping
+    float remaining = ToMilliseconds(m_nextDeadline - now);
+    if (remaining > m_spinThreshold) {
+        float requested = remaining - m_spinThreshold;
+        Clock::time_point sleepStart = now;
+        SleepFor(requested);
+        now = Clock::now();
+
+        float overshoot = std::max(0.0f, ToMilliseconds(now - sleepStart) - requested);
+        m_sleepOvershoot += (overshoot - m_sleepOvershoot) * OVERSHOOT_SMOOTHING;
+        m_spinThreshold = std::max(MIN_SPIN_THRESHOLD, std::min(MAX_SPIN_THRESHOLD,
+                                   m_sleepOvershoot * 2.0f + MIN_SPIN_THRESHOLD));
+    }
+
+    // Spin the last stretch for sub-millisecond accuracy
+    while (now < m_nextDeadline) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+
+    m_lastWakeError = ToMilliseconds(now - m_nextDeadline);
+    m_lastJitter = std::fabs(ToMilliseconds(now - m_lastWake) - ToMilliseconds(period));
+    m_lastWake = now;
+
+    // Late by more than a frame: start a fresh schedule rather than bursting
+    m_nextDeadline += period;
+    if (m_nextDeadline <= now) {
+        m_nextDeadline = now + period;
+    }
+}
+
+void FramePacer::SleepFor(float milliseconds) {
+#ifdef __linux__
+    long long nanoseconds = (long long)(milliseconds * 1000000.0f);
+    timespec request;
+    request.tv_sec = (time_t)(nanoseconds / 1000000000LL);
+    request.tv_nsec = (long)(nanoseconds % 1000000000LL);
+
+    // Restart with the remaining time if a signal interrupts the sleep
+    timespec remaining;
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &request, &remaining) == EINTR) {
+        request = remaining;
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(milliseconds));
+#endif
+}
+
+FramePacer::Clock::duration FramePacer::GetPeriod() const {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_targetFPS));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+
+// Frame limiter with even frame delivery. Waits for each frame deadline by
+// sleeping until shortly before it and spinning the rest of the way, since
+// OS sleeps routinely overshoot by a fraction of a millisecond. The spin
+// margin adapts to the overshoot actually observed on this machine.
+//
+// Deadlines advance by a fixed period; a frame that runs late resyncs the
+// schedule instead of rushing the following frames to catch up.
+class FramePacer {
+public:
+    FramePacer();
+    ~FramePacer();
+
+    // Settings (target FPS of 0 disables limiting)
+    void SetTargetFPS(float fps);
+    float GetTargetFPS() const { return m_targetFPS; }
+    void SetLatencyReduction(bool enabled) { m_latencyReduction = enabled; }
+    bool GetLatencyReduction() const { return m_latencyReduction; }
+
+    // Block until the next frame deadline
+    void WaitForNextFrame();
+    void Reset();
+
+    // Statistics (milliseconds)
+    float GetLastJitter() const { return m_lastJitter; }
+    float GetLastWakeError() const { return m_lastWakeError; }
+    float GetSpinThreshold() const { return m_spinThreshold; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    float m_targetFPS;
+    bool m_latencyReduction;
+    bool m_started;
+    Clock::time_point m_nextDeadline;
+    Clock::time_point m_lastWake;
+
+    // Adaptive sleep margin
+    float m_spinThreshold;
+    float m_sleepOvershoot;
+
+    float m_lastJitter;
+    float m_lastWakeError;
+
+    // Helper methods
+    void SleepFor(float milliseconds);
+    Clock::duration GetPeriod() const;
+};
@@ -0,0 +1,103 @@
+#include "FrameTimeHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    int HighestBit(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 31 - __builtin_clz(value);
+#else
+        int bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+#endif
+    }
+}
+
+FrameTimeHistogram::FrameTimeHistogram() {
+    Clear();
+}
+
+void FrameTimeHistogram::Add(uint32_t microseconds) {
+    microseconds = std::min(microseconds, MAX_VALUE);
+    size_t bucket = GetBucket(microseconds);
+    m_counts[bucket]++;
+    m_count++;
+    m_sum += microseconds;
+    m_max = std::max(m_max, microseconds);
+    m_highestBucket = std::max(m_highestBucket, bucket);
+}
+
+void FrameTimeHistogram::Remove(uint32_t microseconds) {
+    microseconds = std::min(microseconds, MAX_VALUE);
+    size_t bucket = GetBucket(microseconds);
+    if (m_counts[bucket] == 0) return;
+    m_counts[bucket]--;
+    m_count--;
+    m_sum -= microseconds;
+}
+
+void FrameTimeHistogram::Clear() {
+    std::memset(m_counts, 0, sizeof(m_counts));
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+    m_highestBucket = 0;
+}
+
+double FrameTimeHistogram::GetMean() const {
+    return m_count > 0 ? (double)m_sum / m_count : 0.0;
+}
+
+uint32_t FrameTimeHistogram::GetQuantile(double q) const {
+    if (m_count == 0) return 0;
+
+    // Smallest value with at least q of the samples at or below it
+    q = std::min(std::max(q, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(q * m_count));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket <= m_highestBucket; bucket++) {
+        seen += m_counts[bucket];
+        if (seen >= rank) {
+            uint32_t low = GetBucketLow(bucket);
+            uint32_t middle = low + (GetBucketHigh(bucket) - low) / 2;
+            return std::min(middle, GetMax());
+        }
+    }
+    return GetMax();
+}
+
+uint32_t FrameTimeHistogram::GetMax() const {
+    if (m_count == 0) return 0;
+
+    size_t bucket = m_highestBucket;
+    while (bucket > 0 && m_counts[bucket] == 0) {
+        bucket--;
+    }
+    // m_max may have been removed since; it is only exact inside its own bucket
+    return GetBucket(m_max) == bucket ? m_max : GetBucketHigh(bucket);
+}
+
+size_t FrameTimeHistogram::GetBucket(uint32_t microseconds) {
+    if (microseconds < SUB_BUCKET_COUNT) return microseconds;
+
+    // Shift so the value's top SUB_BUCKET_BITS - 1 bits select one of the 64 linear buckets
+    int shift = HighestBit(microseconds) - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKET_COUNT + (size_t)(shift - 1) * SUB_BUCKET_HALF + ((microseconds >> shift) - SUB_BUCKET_HALF);
+}
+
+uint32_t FrameTimeHistogram::GetBucketLow(size_t bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return (uint32_t)bucket;
+
+    int shift = (int)((bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF) + 1;
+    uint32_t mantissa = (uint32_t)((bucket - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF) + SUB_BUCKET_HALF;
+    return mantissa << shift;
+}
+
+uint32_t FrameTimeHistogram::GetBucketHigh(size_t bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return (uint32_t)bucket;
+
+    int shift = (int)((bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF) + 1;
+    return GetBucketLow(bucket) + (1u << shift) - 1;
+}
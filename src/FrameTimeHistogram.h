@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size log-linear histogram of durations in microseconds, in the
+// style of an HDR histogram: values below 128 us get a bucket each, and
+// every power-of-two range above that is split into 64 linear buckets, so
+// a reported quantile is within half a bucket (under 1%) of the true value.
+// Add() and Remove() are constant time with no allocation; Remove() lets a
+// ring buffer keep a sliding window. Quantile queries scan the buckets.
+class FrameTimeHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr uint32_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;   // exact buckets below this
+    static constexpr uint32_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;     // buckets per power of two above
+    static constexpr int MAX_VALUE_BITS = 30;
+    static constexpr uint32_t MAX_VALUE = (1u << MAX_VALUE_BITS) - 1;     // larger values are clamped (~18 min)
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+    FrameTimeHistogram();
+
+    void Add(uint32_t microseconds);
+    // Undo an earlier Add() of the same value
+    void Remove(uint32_t microseconds);
+    void Clear();
+
+    uint64_t GetCount() const { return m_count; }
+    // Mean of the recorded values (exact)
+    double GetMean() const;
+    // Value at quantile q in [0, 1] (the median of its bucket), 0 when empty
+    uint32_t GetQuantile(double q) const;
+    // Largest value: exact while it is still recorded, otherwise its bucket's upper edge
+    uint32_t GetMax() const;
+
+    // Bucket layout (exposed for tests)
+    static size_t GetBucket(uint32_t microseconds);
+    static uint32_t GetBucketLow(size_t bucket);
+    static uint32_t GetBucketHigh(size_t bucket);
+
+private:
+    uint32_t m_counts[BUCKET_COUNT];
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint32_t m_max;          // largest value added since Clear()
+    size_t m_highestBucket;  // upper bound on the highest non-empty bucket
+};
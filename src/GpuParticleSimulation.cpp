@@ -0,0 +1,186 @@
+#include "GpuParticleSimulation.h"
+#include "MemoryTracker.h"
+#include "ShaderManager.h"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+static_assert(sizeof(GpuParticle) == 15 * sizeof(float), "GpuParticle must match the transform feedback outputs");
+static_assert(sizeof(GpuEmitterBlock) == 128, "GpuEmitterBlock must match the std140 Emitter block");
+
+GpuParticleSimulation::GpuParticleSimulation()
+    : m_capacity(0), m_current(0), m_spawnCursor(0), m_frameSeed(0),
+      m_particleVBO{0, 0}, m_updateVAO{0, 0}, m_renderVAO{0, 0}, m_quadVBO(0), m_emitterUBO(0) {
+}
+
+GpuParticleSimulation::~GpuParticleSimulation() {
+    Cleanup();
+}
+
+bool GpuParticleSimulation::Initialize(size_t capacity) {
+    Cleanup();
+    std::cout << "Initializing GPU Particle Simulation (" << capacity << " particles)..." << std::endl;
+
+    // Captured in GpuParticle order
+    const char* varyings[] = { "outPositionSize", "outVelocityRotation", "outColor", "outLife" };
+    std::unique_ptr<ShaderManager> updateShader = std::make_unique<ShaderManager>();
+    if (updateShader->LoadTransformFeedbackShader("shaders/particle_update.vert", varyings, 4) == 0) {
+        std::cout << "ERROR: Failed to load particle simulation shader!" << std::endl;
+        return false;
+    }
+
+    GLuint blockIndex = glGetUniformBlockIndex(updateShader->m_programID, "Emitter");
+    if (blockIndex == GL_INVALID_INDEX) {
+        std::cout << "ERROR: Particle simulation shader has no Emitter block!" << std::endl;
+        glDeleteProgram(updateShader->m_programID);
+        return false;
+    }
+    glUniformBlockBinding(updateShader->m_programID, blockIndex, EMITTER_BINDING);
+    m_updateShader = std::move(updateShader);
+
+    m_capacity = std::max<size_t>(capacity, 1);
+
+    // Both buffers start zeroed: every slot free, zero size, zero alpha
+    std::vector<GpuParticle> particles(m_capacity, GpuParticle{});
+    glGenBuffers(2, m_particleVBO);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_particleVBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(GpuParticle), particles.data(), GL_DYNAMIC_COPY);
+        MemoryTracker::Get().TrackBuffer(m_particleVBO[i], m_capacity * sizeof(GpuParticle), MemoryCategory::Particles);
+    }
+
+    const float corners[] = {
+        -0.5f, -0.5f,
+         0.5f, -0.5f,
+        -0.5f,  0.5f,
+         0.5f,  0.5f
+    };
+    glGenBuffers(1, &m_quadVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_quadVBO, sizeof(corners), MemoryCategory::Particles);
+
+    glGenVertexArrays(2, m_updateVAO);
+    glGenVertexArrays(2, m_renderVAO);
+    for (int i = 0; i < 2; i++) {
+        SetupUpdateVAO(m_updateVAO[i], m_particleVBO[i]);
+        SetupRenderVAO(m_renderVAO[i], m_particleVBO[i]);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &m_emitterUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_emitterUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(GpuEmitterBlock), nullptr, GL_DYNAMIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_emitterUBO, sizeof(GpuEmitterBlock), MemoryCategory::Particles);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    m_current = 0;
+    m_spawnCursor = 0;
+    return true;
+}
+
+void GpuParticleSimulation::Cleanup() {
+    if (m_updateShader) {
+        glDeleteProgram(m_updateShader->m_programID);
+        m_updateShader.reset();
+    }
+    if (m_particleVBO[0]) {
+        glDeleteVertexArrays(2, m_updateVAO);
+        glDeleteVertexArrays(2, m_renderVAO);
+        glDeleteBuffers(2, m_particleVBO);
+        glDeleteBuffers(1, &m_quadVBO);
+        glDeleteBuffers(1, &m_emitterUBO);
+        for (GLuint buffer : { m_particleVBO[0], m_particleVBO[1], m_quadVBO, m_emitterUBO }) {
+            MemoryTracker::Get().ReleaseBuffer(buffer);
+        }
+    }
+    m_particleVBO[0] = m_particleVBO[1] = 0;
+    m_updateVAO[0] = m_updateVAO[1] = 0;
+    m_renderVAO[0] = m_renderVAO[1] = 0;
+    m_quadVBO = m_emitterUBO = 0;
+    m_capacity = 0;
+}
+
+void GpuParticleSimulation::Update(GpuEmitterBlock emitter, int spawnCount) {
+    if (!IsInitialized()) return;
+
+    emitter.spawn[0] = (int32_t)m_spawnCursor;
+    emitter.spawn[1] = (int32_t)std::min<size_t>(std::max(spawnCount, 0), m_capacity);
+    emitter.spawn[2] = (int32_t)m_capacity;
+    emitter.spawn[3] = (int32_t)m_frameSeed++;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_emitterUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GpuEmitterBlock), &emitter);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, EMITTER_BINDING, m_emitterUBO);
+
+    // Read the latest state, write the other buffer; nothing is rasterized
+    int next = 1 - m_current;
+    m_updateShader->use();
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(m_updateVAO[m_current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_particleVBO[next]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)m_capacity);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    m_current = next;
+    m_spawnCursor = AdvanceSpawnCursor(m_spawnCursor, spawnCount, m_capacity);
+}
+
+void GpuParticleSimulation::Reset() {
+    if (!IsInitialized()) return;
+
+    std::vector<GpuParticle> particles(m_capacity, GpuParticle{});
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_particleVBO[i]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_capacity * sizeof(GpuParticle), particles.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_spawnCursor = 0;
+}
+
+void GpuParticleSimulation::BindForRender() {
+    glBindVertexArray(m_renderVAO[m_current]);
+}
+
+uint32_t GpuParticleSimulation::AdvanceSpawnCursor(uint32_t cursor, int spawnCount, size_t capacity) {
+    if (capacity == 0 || spawnCount <= 0) return cursor;
+    return (uint32_t)((cursor + (size_t)spawnCount % capacity) % capacity);
+}
+
+void GpuParticleSimulation::SetupUpdateVAO(GLuint vao, GLuint buffer) {
+    const GLsizei stride = sizeof(GpuParticle);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, position));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, velocity));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, color));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, life));
+    for (GLuint attribute = 0; attribute <= 3; attribute++) {
+        glEnableVertexAttribArray(attribute);
+    }
+}
+
+void GpuParticleSimulation::SetupRenderVAO(GLuint vao, GLuint buffer) {
+    // Same attribute layout as BindParticleInstances, with float color
+    const GLsizei stride = sizeof(GpuParticle);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, position));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, rotation));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GpuParticle, color));
+    for (GLuint attribute = 1; attribute <= 3; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class ShaderManager;
+
+// One particle as stored in the simulation buffers. The first 28 bytes
+// double as the particle.vert instance layout (position + size, rotation),
+// so rendering reads the buffer the simulation just wrote.
+struct GpuParticle {
+    glm::vec3 position;
+    float size;
+    glm::vec3 velocity;
+    float rotation;       // degrees
+    glm::vec4 color;
+    float life;           // seconds left; <= 0 means the slot is free
+    float maxLife;
+    float rotationSpeed;  // degrees per second
+};
+
+// CPU mirror of the std140 Emitter block in particle_update.vert
+struct GpuEmitterBlock {
+    glm::vec4 position;
+    glm::vec4 velocityMin;
+    glm::vec4 velocityMax;
+    glm::vec4 acceleration;
+    glm::vec4 color;
+    glm::vec4 lifeSize;   // life min/max, size min/max
+    glm::vec4 timing;     // x = delta time
+    int32_t spawn[4];     // first slot, slot count, capacity, frame seed (set by Update)
+};
+
+// Particle simulation that stays on the GPU (GL 3.3 transform feedback).
+// Particles live in two vertex buffers; each Update() runs a vertex-only
+// pass that reads one buffer, integrates and ages every particle, respawns
+// free slots inside this frame's spawn window and writes the other buffer.
+// The window is a ring cursor over the slots, so emission needs no readback:
+// a slot still alive when the window reaches it simply skips that spawn.
+// Per-frame CPU work is one uniform upload and two draws regardless of count.
+class GpuParticleSimulation {
+public:
+    GpuParticleSimulation();
+    ~GpuParticleSimulation();
+
+    // Initialization (allocates both buffers; all slots start free)
+    bool Initialize(size_t capacity);
+    void Cleanup();
+    bool IsInitialized() const { return m_updateShader != nullptr; }
+
+    // Simulation
+    void Update(GpuEmitterBlock emitter, int spawnCount);
+    void Reset();
+
+    // Binds a VAO that reads the latest buffer as particle.vert instances;
+    // draw GetCapacity() instances, free slots have zero size
+    void BindForRender();
+
+    size_t GetCapacity() const { return m_capacity; }
+    uint32_t GetSpawnCursor() const { return m_spawnCursor; }
+
+    // Start of the next spawn window after spawning spawnCount particles
+    static uint32_t AdvanceSpawnCursor(uint32_t cursor, int spawnCount, size_t capacity);
+
+private:
+    static constexpr GLuint EMITTER_BINDING = 0;
+
+    size_t m_capacity;
+    int m_current;           // buffer holding the latest particle state
+    uint32_t m_spawnCursor;
+    uint32_t m_frameSeed;
+
+    GLuint m_particleVBO[2];
+    GLuint m_updateVAO[2];   // reads buffer i as per-vertex input
+    GLuint m_renderVAO[2];   // reads buffer i as per-instance input
+    GLuint m_quadVBO;
+    GLuint m_emitterUBO;
+    std::unique_ptr<ShaderManager> m_updateShader;
+
+    // Helper methods
+    void SetupUpdateVAO(GLuint vao, GLuint buffer);
+    void SetupRenderVAO(GLuint vao, GLuint buffer);
+};
@@ -0,0 +1,182 @@
+#include "GpuProfiler.h"
+#include <cstring>
+#include <iostream>
+
+GpuProfiler::GpuProfiler()
+    : m_currentSlot(-1), m_nextSlot(0), m_frameNumber(0), m_resultFrame(0), m_skippedFrames(0), m_droppedZones(0) {
+    for (FrameSlot& slot : m_slots) {
+        for (GLuint& query : slot.queries) {
+            query = 0;
+        }
+        slot.frameNumber = 0;
+        slot.pending = false;
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    Cleanup();
+}
+
+void GpuProfiler::Initialize() {
+    if (IsInitialized()) return;
+
+    for (FrameSlot& slot : m_slots) {
+        CreateQueries(slot.queries, MAX_ZONES * 2);
+        slot.zones.reserve(MAX_ZONES);
+        slot.pending = false;
+    }
+}
+
+void GpuProfiler::Cleanup() {
+    if (!IsInitialized()) return;
+
+    for (FrameSlot& slot : m_slots) {
+        DeleteQueries(slot.queries, MAX_ZONES * 2);
+        for (GLuint& query : slot.queries) {
+            query = 0;
+        }
+        slot.pending = false;
+    }
+    m_currentSlot = -1;
+    m_openZones.clear();
+}
+
+void GpuProfiler::BeginFrame() {
+    if (!IsInitialized()) return;
+
+    ReadResults();
+
+    // Record only into a slot whose previous results have been consumed
+    m_openZones.clear();
+    if (m_slots[m_nextSlot].pending) {
+        m_currentSlot = -1;
+        m_skippedFrames++;
+    } else {
+        m_currentSlot = m_nextSlot;
+        m_nextSlot = (m_nextSlot + 1) % FRAME_LATENCY;
+        FrameSlot& slot = m_slots[m_currentSlot];
+        slot.zones.clear();
+        slot.frameNumber = m_frameNumber;
+    }
+
+    // The frame is the root zone
+    BeginZone("Frame");
+}
+
+void GpuProfiler::EndFrame() {
+    if (!IsInitialized()) return;
+
+    if (m_openZones.size() > 1) {
+        std::cout << "Warning: GPU zone '" << GetOpenZoneName() << "' is still open at the end of the frame!" << std::endl;
+    }
+    while (!m_openZones.empty()) {
+        EndZone();
+    }
+
+    if (m_currentSlot >= 0) {
+        m_slots[m_currentSlot].pending = true;
+    }
+    m_currentSlot = -1;
+    m_frameNumber++;
+}
+
+void GpuProfiler::BeginZone(const char* name) {
+    if (!IsInitialized()) {
+        Initialize();
+    }
+
+    // Zones outside a timed frame still nest, so EndZone() pairs up, but record nothing
+    if (m_currentSlot < 0 || (int)m_slots[m_currentSlot].zones.size() >= MAX_ZONES) {
+        if (m_currentSlot >= 0) {
+            m_droppedZones++;
+        }
+        m_openZones.push_back(-1);
+        return;
+    }
+
+    FrameSlot& slot = m_slots[m_currentSlot];
+    int index = (int)slot.zones.size();
+    int parent = -1;
+    for (int i = (int)m_openZones.size() - 1; i >= 0 && parent < 0; i--) {
+        parent = m_openZones[i];
+    }
+    slot.zones.push_back({ name, (int)m_openZones.size(), parent });
+    WriteTimestamp(slot.queries[index * 2]);
+    m_openZones.push_back(index);
+}
+
+void GpuProfiler::EndZone() {
+    if (m_openZones.empty()) return;
+
+    int index = m_openZones.back();
+    m_openZones.pop_back();
+    if (index >= 0 && m_currentSlot >= 0) {
+        WriteTimestamp(m_slots[m_currentSlot].queries[index * 2 + 1]);
+    }
+}
+
+const char* GpuProfiler::GetOpenZoneName() const {
+    if (m_openZones.empty() || m_currentSlot < 0 || m_openZones.back() < 0) return "";
+    return m_slots[m_currentSlot].zones[m_openZones.back()].name;
+}
+
+float GpuProfiler::GetZoneTime(const char* name) const {
+    float time = 0.0f;
+    for (const GpuZoneResult& result : m_results) {
+        if (std::strcmp(result.name, name) == 0) {
+            time += result.time;
+        }
+    }
+    return time;
+}
+
+void GpuProfiler::ReadResults() {
+    // Consume finished slots oldest first; stop at the first one still in flight
+    for (int i = 0; i < FRAME_LATENCY; i++) {
+        FrameSlot& slot = m_slots[(m_nextSlot + i) % FRAME_LATENCY];
+        if (!slot.pending) continue;
+
+        // The frame zone's end is the slot's last timestamp, and queries complete in order
+        if (!IsTimestampAvailable(slot.queries[1])) break;
+
+        uint64_t frameStart = ReadTimestamp(slot.queries[0]);
+        m_results.resize(slot.zones.size());
+        for (size_t zone = 0; zone < slot.zones.size(); zone++) {
+            uint64_t start = ReadTimestamp(slot.queries[zone * 2]);
+            uint64_t end = ReadTimestamp(slot.queries[zone * 2 + 1]);
+
+            GpuZoneResult& result = m_results[zone];
+            result.name = slot.zones[zone].name;
+            result.depth = slot.zones[zone].depth;
+            result.parent = slot.zones[zone].parent;
+            result.start = (start - frameStart) / 1000000.0f;
+            result.time = (end - start) / 1000000.0f;
+        }
+        m_resultFrame = slot.frameNumber;
+        slot.pending = false;
+    }
+}
+
+void GpuProfiler::CreateQueries(GLuint* queries, int count) {
+    glGenQueries(count, queries);
+}
+
+void GpuProfiler::DeleteQueries(GLuint* queries, int count) {
+    glDeleteQueries(count, queries);
+}
+
+void GpuProfiler::WriteTimestamp(GLuint query) {
+    glQueryCounter(query, GL_TIMESTAMP);
+}
+
+bool GpuProfiler::IsTimestampAvailable(GLuint query) {
+    GLint available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+uint64_t GpuProfiler::ReadTimestamp(GLuint query) {
+    GLuint64 timestamp = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timestamp);
+    return timestamp;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One timed GPU zone of a finished frame
+struct GpuZoneResult {
+    const char* name;  // the pointer passed to BeginZone()
+    int depth;       // 0 = the frame itself
+    int parent;      // index into the same results, -1 for the frame
+    float start;     // ms since the frame's first timestamp
+    float time;      // ms
+};
+
+// GPU zone timer that never waits on the GPU. Every zone is a pair of
+// GL_TIMESTAMP queries, so zones nest freely (GL_TIME_ELAPSED queries
+// cannot). Each frame writes into its own slot in a ring of FRAME_LATENCY
+// slots; a slot is read back only once its last query reports
+// GL_QUERY_RESULT_AVAILABLE, typically two or three frames later, and the
+// results keep the number of the frame that produced them. If every slot
+// is still in flight, a frame goes untimed rather than stalling. Zone names
+// are stored by pointer, like PROFILE_SCOPE names, so they must outlive the
+// results (string literals do).
+class GpuProfiler {
+public:
+    static constexpr int FRAME_LATENCY = 4;
+    // Zones per frame, including the frame zone; extra zones are dropped and counted
+    static constexpr int MAX_ZONES = 64;
+
+    GpuProfiler();
+    virtual ~GpuProfiler();
+
+    // Query objects are created on first use (a GL context must be current)
+    void Initialize();
+    void Cleanup();
+    bool IsInitialized() const { return m_slots[0].queries[0] != 0; }
+
+    // Frame brackets; BeginFrame() also collects every finished slot
+    void BeginFrame();
+    void EndFrame();
+
+    // Zones between BeginFrame() and EndFrame(); EndZone() closes the innermost one
+    void BeginZone(const char* name);
+    void EndZone();
+    int GetOpenZoneCount() const { return (int)m_openZones.size(); }
+    // Innermost recorded zone, or "" if none
+    const char* GetOpenZoneName() const;
+
+    // Latest finished frame
+    const std::vector<GpuZoneResult>& GetResults() const { return m_results; }
+    uint64_t GetResultFrame() const { return m_resultFrame; }
+    // Summed time of every zone with this name in the latest finished frame (ms)
+    float GetZoneTime(const char* name) const;
+
+    // Statistics
+    uint64_t GetFrameNumber() const { return m_frameNumber; }
+    size_t GetSkippedFrameCount() const { return m_skippedFrames; }
+    size_t GetDroppedZoneCount() const { return m_droppedZones; }
+
+protected:
+    // GL query calls; tests override them to run the slot logic without a context
+    virtual void CreateQueries(GLuint* queries, int count);
+    virtual void DeleteQueries(GLuint* queries, int count);
+    virtual void WriteTimestamp(GLuint query);
+    virtual bool IsTimestampAvailable(GLuint query);
+    virtual uint64_t ReadTimestamp(GLuint query);
+
+private:
+    struct Zone {
+        const char* name;
+        int depth;
+        int parent;
+    };
+
+    struct FrameSlot {
+        GLuint queries[MAX_ZONES * 2];  // begin and end timestamp per zone
+        std::vector<Zone> zones;
+        uint64_t frameNumber;
+        bool pending;                   // queries issued, results not read yet
+    };
+
+    FrameSlot m_slots[FRAME_LATENCY];
+    int m_currentSlot;      // slot being recorded, -1 outside a frame or when untimed
+    int m_nextSlot;
+    uint64_t m_frameNumber;
+    std::vector<int> m_openZones;
+
+    std::vector<GpuZoneResult> m_results;
+    uint64_t m_resultFrame;
+
+    size_t m_skippedFrames;
+    size_t m_droppedZones;
+
+    // Helper methods
+    void ReadResults();
+};
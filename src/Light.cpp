@@ -1,5 +1,6 @@
 #include "Light.h"
 #include <algorithm>
+#include <cmath>
 
 Light::Light(const std::string& name, LightType type) 
     : name(name), type(type), position(0.0f), direction(0.0f, -1.0f, 0.0f),
@@ -37,6 +38,26 @@ void Light::SetSpotlightAngles(float cutOff, float outerCutOff) {
     this->outerCutOff = outerCutOff;
 }
 
+float Light::GetRange(float threshold) const {
+    if (type == LightType::DIRECTIONAL) return 0.0f;
+    
+    // Solve quadratic * d^2 + linear * d + constant = brightness / threshold
+    const float maxRange = 1000.0f;
+    float brightness = std::max(diffuse.r, std::max(diffuse.g, diffuse.b)) * intensity;
+    float target = brightness / std::max(threshold, 1e-6f);
+    float c = constant - target;
+    if (c >= 0.0f) return 0.0f; // never brighter than the threshold
+    
+    if (quadratic > 1e-6f) {
+        float discriminant = linear * linear - 4.0f * quadratic * c;
+        return std::min((-linear + std::sqrt(discriminant)) / (2.0f * quadratic), maxRange);
+    }
+    if (linear > 1e-6f) {
+        return std::min(-c / linear, maxRange);
+    }
+    return maxRange;
+}
+
 glm::vec3 Light::GetContribution(const glm::vec3& worldPos) const {
     if (!enabled) return glm::vec3(0.0f);
     
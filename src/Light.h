@@ -42,6 +42,10 @@ public:
     void SetAttenuation(float constant, float linear, float quadratic);
     void SetSpotlightAngles(float cutOff, float outerCutOff);
     
+    // Distance at which the attenuated contribution drops below threshold
+    // (relative to full brightness). Directional lights return 0.
+    float GetRange(float threshold = 1.0f / 256.0f) const;
+    
     // Virtual methods for different light types
     virtual void Update(float deltaTime) {}
     virtual glm::vec3 GetContribution(const glm::vec3& worldPos) const;
@@ -2,6 +2,9 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -9,6 +12,20 @@
 #include "ShaderManager.h"
 #include "SceneManager.h"
 #include "ViewManager.h"
+#include "ClusteredLighting.h"
+#include "DeferredRenderer.h"
+#include "DynamicResolution.h"
+#include "FramePacer.h"
+#include "StreamBuffer.h"
+#include "ParticleSystem.h"
+#include "ParticleRibbons.h"
+#include "ParticleManager.h"
+#include "DebugRenderer.h"
+#include "Light.h"
+#include "PerformanceMonitor.h"
+#include "AllocationTracker.h"
+#include "Profiler.h"
+#include "TraceCapture.h"
 
 // Window dimensions
 const unsigned int WINDOW_WIDTH = 1200;
@@ -23,19 +40,86 @@ bool firstMouse = true;
 // Timing
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
+// Frames run before --alloc-check starts failing on allocations
+const int ALLOCATION_CHECK_WARMUP_FRAMES = 300;
 
 // Managers
 std::unique_ptr<SceneManager> sceneManager;
 std::unique_ptr<ViewManager> viewManager;
 std::unique_ptr<ShaderManager> shaderManager;
+std::unique_ptr<ShaderManager> clusteredShader;
+std::unique_ptr<ShaderManager> depthShader;
+std::unique_ptr<ClusteredLighting> clusteredLighting;
+std::unique_ptr<DeferredRenderer> deferredRenderer;
+std::unique_ptr<DynamicResolution> dynamicResolution;
+std::unique_ptr<FramePacer> framePacer;
+std::unique_ptr<StreamBuffer> streamBuffer;
+std::unique_ptr<ShaderManager> particleShader;
+std::unique_ptr<ShaderManager> ribbonShader;
+std::unique_ptr<ShaderManager> debugShader;
+std::unique_ptr<ParticleSystem> particleSystem;
+std::unique_ptr<ParticleManager> particleManager;
+std::unique_ptr<ParticleColliders> particleColliders;
+std::unique_ptr<DebugRenderer> debugRenderer;
+std::unique_ptr<PerformanceMonitor> performanceMonitor;
+std::unique_ptr<TraceCapture> traceCapture;
+
+// Render settings, switchable per frame so paths can be compared on the same scene
+enum class RenderPath {
+    Forward,
+    Clustered,
+    Deferred
+};
+RenderPath renderPath = RenderPath::Clustered;
+bool clusteredAvailable = true;
+bool deferredAvailable = true;
+bool useDepthPrePass = false;
+bool depthPrePassAvailable = true;
+bool dynamicResolutionAvailable = true;
+bool particlesAvailable = true;
+bool ribbonsAvailable = true;
+bool debugOverlayAvailable = true;
+bool showDebugOverlay = false;
+
+const char* GetRenderPathName(RenderPath path);
+void renderScene(const glm::mat4& view, const glm::mat4& projection, GLuint sceneFramebuffer, int width, int height);
+void renderDebugOverlay(const glm::mat4& view, const glm::mat4& projection);
 
 // Callback functions
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void processInput(GLFWwindow* window);
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Trace capture options: --trace <frames> [file] records from the first
+    // frame, --trace-threshold <ms> [frames] records once a frame is that slow.
+    // --alloc-check [frames] fails the run if any frame after the warm-up
+    // allocates (needs an ENABLE_ALLOCATION_TRACKING build)
+    int traceFrames = 0;
+    std::string traceFile;
+    float traceThreshold = 0.0f;
+    int traceThresholdFrames = TraceCapture::DEFAULT_FRAME_COUNT;
+    int allocationCheckWarmup = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceFrames = std::atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') traceFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace-threshold") == 0 && i + 1 < argc) {
+            traceThreshold = (float)std::atof(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') traceThresholdFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--alloc-check") == 0) {
+            allocationCheckWarmup = ALLOCATION_CHECK_WARMUP_FRAMES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') allocationCheckWarmup = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            std::cout << "Warning: Unknown argument " << argv[i] << "!" << std::endl;
+        }
+    }
+    if (allocationCheckWarmup > 0 && !AllocationTracker::IsCompiledIn()) {
+        std::cout << "Warning: --alloc-check needs a build with ENABLE_ALLOCATION_TRACKING!" << std::endl;
+    }
+
     // Initialize GLFW
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -51,6 +135,9 @@ int main() {
     }
     glfwMakeContextCurrent(window);
 
+    // Frame timing is owned by the frame pacer rather than vsync
+    glfwSwapInterval(0);
+
     // Initialize GLEW
     if (glewInit() != GLEW_OK) {
         std::cout << "Failed to initialize GLEW" << std::endl;
@@ -61,12 +148,36 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     // Initialize managers
     sceneManager = std::make_unique<SceneManager>();
     viewManager = std::make_unique<ViewManager>();
     shaderManager = std::make_unique<ShaderManager>();
+    clusteredShader = std::make_unique<ShaderManager>();
+    depthShader = std::make_unique<ShaderManager>();
+    clusteredLighting = std::make_unique<ClusteredLighting>();
+    deferredRenderer = std::make_unique<DeferredRenderer>();
+    dynamicResolution = std::make_unique<DynamicResolution>();
+    framePacer = std::make_unique<FramePacer>();
+    framePacer->SetTargetFPS(60.0f);
+    streamBuffer = std::make_unique<StreamBuffer>();
+    particleShader = std::make_unique<ShaderManager>();
+    ribbonShader = std::make_unique<ShaderManager>();
+    debugShader = std::make_unique<ShaderManager>();
+    particleSystem = std::make_unique<ParticleSystem>();
+    particleManager = std::make_unique<ParticleManager>();
+    debugRenderer = std::make_unique<DebugRenderer>();
+    performanceMonitor = std::make_unique<PerformanceMonitor>();
+    Profiler::Get().SetThreadName("Main");
+    traceCapture = std::make_unique<TraceCapture>();
+    if (traceFrames > 0) {
+        traceCapture->Start(traceFrames, traceFile);
+    }
+    if (traceThreshold > 0.0f) {
+        traceCapture->SetFrameTimeTrigger(traceThreshold, traceThresholdFrames);
+    }
 
     // Initialize scene
     sceneManager->Initialize();
@@ -77,12 +188,112 @@ int main() {
         std::cout << "Failed to load shaders" << std::endl;
         return -1;
     }
+    if (clusteredShader->LoadShaders("shaders/vertex.glsl", "shaders/clustered.frag") == 0) {
+        std::cout << "Failed to load clustered lighting shader, using forward lighting" << std::endl;
+        clusteredAvailable = false;
+        renderPath = RenderPath::Forward;
+    }
+    if (depthShader->LoadShaders("shaders/position_only.vert", "shaders/depth_only.frag") == 0) {
+        std::cout << "Failed to load depth pre-pass shader" << std::endl;
+        depthPrePassAvailable = false;
+    }
+    clusteredLighting->Initialize();
+    deferredAvailable = deferredRenderer->Initialize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    dynamicResolutionAvailable = dynamicResolution->Initialize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    dynamicResolution->SetScaleBounds(0.5f, 1.0f);
+    dynamicResolution->SetTargetFrameTime(1000.0f / 60.0f);
+
+    // Per-frame vertex data (particles, debug lines) streams through one shared buffer
+    streamBuffer->Initialize(1024 * 1024);
+    if (particleShader->LoadShaders("shaders/particle.vert", "shaders/particle.frag") == 0) {
+        std::cout << "Failed to load particle shader" << std::endl;
+        particlesAvailable = false;
+    }
+    if (ribbonShader->LoadShaders("shaders/ribbon.vert", "shaders/ribbon.frag") == 0) {
+        std::cout << "Failed to load ribbon shader" << std::endl;
+        ribbonsAvailable = false;
+    }
+    if (debugShader->LoadShaders("shaders/debug_line.vert", "shaders/debug_line.frag") == 0) {
+        std::cout << "Failed to load debug line shader" << std::endl;
+        debugOverlayAvailable = false;
+    }
+    // Particles bounce off the scene's objects and a ground plane under the floor
+    particleColliders = std::make_unique<ParticleColliders>();
+    particleColliders->SetBoxesFromObjects(sceneManager->GetObjects());
+    particleColliders->AddPlane(glm::vec3(0.0f, 1.0f, 0.0f), 1.05f);
+
+    particleSystem->Initialize();
+    particleSystem->SetStreamBuffer(streamBuffer.get());
+    particleSystem->SetColliders(particleColliders.get());
+    particleSystem->SetPosition(glm::vec3(0.0f, 0.5f, 0.0f));
+    particleSystem->SetVelocityRange(glm::vec3(-0.5f, 1.5f, -0.5f), glm::vec3(0.5f, 3.0f, 0.5f));
+    particleSystem->SetParticleColor(glm::vec4(1.0f, 0.6f, 0.2f, 1.0f));
+    particleSystem->SetParticleSize(0.02f, 0.06f);
+    particleSystem->SetEmissionRate(200.0f);
+    particleSystem->SetDepthSort(true);
+
+    // Drifting turbulence plus air drag on the fountain
+    auto fountainNoise = std::make_shared<CurlNoiseForce>(1.5f, 0.8f);
+    fountainNoise->SetScrollVelocity(glm::vec3(0.0f, 0.5f, 0.0f));
+    particleSystem->AddForce(fountainNoise);
+    particleSystem->AddForce(std::make_shared<DragForce>(0.3f, 0.05f));
+
+    // Short trails behind the fountain's particles, a history point every 1/30 s
+    particleSystem->EnableRibbons(256, 16);
+    particleSystem->GetRibbons()->SetRecordInterval(1.0f / 30.0f);
+    particleSystem->Start();
+
+    // Small additive sparks around the scene and their smoke share one buffer, one draw per blend mode
+    particleManager->Initialize();
+    particleManager->SetStreamBuffer(streamBuffer.get());
+    particleManager->SetParticleBudget(20000);
+    const glm::vec3 sparkPositions[] = {
+        glm::vec3(-3.0f, 0.2f, -3.0f), glm::vec3(3.0f, 0.2f, -3.0f),
+        glm::vec3(-3.0f, 0.2f, 3.0f), glm::vec3(3.0f, 0.2f, 3.0f)
+    };
+    for (const glm::vec3& position : sparkPositions) {
+        ParticleSystem& sparks = particleManager->GetEmitter(particleManager->CreateEmitter(ParticleBlendMode::Additive));
+        sparks.SetCapacity(1000);
+        sparks.SetPosition(position);
+        sparks.SetVelocityRange(glm::vec3(-0.3f, 0.5f, -0.3f), glm::vec3(0.3f, 1.5f, 0.3f));
+        sparks.SetParticleColor(glm::vec4(1.0f, 0.8f, 0.3f, 1.0f));
+        sparks.SetParticleLife(0.5f, 1.0f);
+        sparks.SetParticleSize(0.01f, 0.03f);
+        sparks.SetEmissionRate(100.0f);
+        sparks.SetColliders(particleColliders.get());
+        sparks.SetCollisionSettings({ 0.5f, 0.05f, false });
+        sparks.Start();
+
+        // Each spark leaves a puff of smoke where it burns out
+        ParticleSystem& smoke = particleManager->GetEmitter(particleManager->CreateEmitter(ParticleBlendMode::Alpha));
+        smoke.SetCapacity(500);
+        smoke.SetPosition(position);
+        smoke.SetEmissionRate(0.0f);
+        smoke.SetVelocityRange(glm::vec3(-0.1f, 0.1f, -0.1f), glm::vec3(0.1f, 0.3f, 0.1f));
+        smoke.SetAcceleration(glm::vec3(0.0f, 0.2f, 0.0f));
+        smoke.SetParticleColor(glm::vec4(0.4f, 0.4f, 0.4f, 0.3f));
+        smoke.SetParticleLife(1.0f, 2.0f);
+        smoke.SetParticleSize(0.05f, 0.12f);
+        smoke.Start();
+        sparks.AddSubEmitter({ SubEmitterTrigger::Death, &smoke, 1, 0.2f });
+    }
+    debugRenderer->Initialize();
+    debugRenderer->SetStreamBuffer(streamBuffer.get());
+    debugRenderer->SetDepthTest(false);
 
     // Enable depth testing
     glEnable(GL_DEPTH_TEST);
 
     // Render loop
     while (!glfwWindowShouldClose(window)) {
+        // With latency reduction the wait happens here, so input is sampled
+        // right before rendering instead of a whole wait earlier
+        if (framePacer->GetLatencyReduction()) {
+            framePacer->WaitForNextFrame();
+            performanceMonitor->RecordPacingJitter(framePacer->GetLastJitter());
+        }
+        glfwPollEvents();
+
         // Calculate delta time
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
@@ -91,41 +302,219 @@ int main() {
         // Process input
         processInput(window);
 
+        performanceMonitor->BeginFrame();
+        streamBuffer->BeginFrame();
+
+        // Set view and projection matrices (the particle budget scores emitters against them)
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), viewManager->GetAspectRatio(), 0.1f, 100.0f);
+
+        // Update scene
+        {
+            PROFILE_SCOPE("Update");
+            sceneManager->Update(deltaTime);
+            particleSystem->Update(deltaTime);
+            particleManager->SetCamera(view, projection);
+            particleManager->Update(deltaTime);
+        }
+
+        // Pick the scene target: the scaled offscreen buffer or the window.
+        // BeginScene() issues the GPU start timestamp, so it comes after the
+        // CPU updates; otherwise GPU idle time while simulating counts as
+        // scene time and the controller drops resolution on CPU-bound frames.
+        bool scaledScene = dynamicResolutionAvailable && dynamicResolution->IsEnabled();
+        GLuint sceneFramebuffer = 0;
+        int sceneWidth = viewManager->GetWidth();
+        int sceneHeight = viewManager->GetHeight();
+        if (scaledScene) {
+            dynamicResolution->BeginScene();
+            sceneFramebuffer = dynamicResolution->GetFramebuffer();
+            sceneWidth = dynamicResolution->GetRenderWidth();
+            sceneHeight = dynamicResolution->GetRenderHeight();
+        }
+
         // Clear screen
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Update scene
-        sceneManager->Update(deltaTime);
+        // Render scene (each pass records its own GPU timer)
+        renderScene(view, projection, sceneFramebuffer, sceneWidth, sceneHeight);
 
-        // Render scene
-        shaderManager->use();
-        
-        // Set view and projection matrices
-        glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
-        
-        shaderManager->setMat4Value("view", view);
-        shaderManager->setMat4Value("projection", projection);
+        // Particles blend over the lit scene at scene resolution
+        if (particlesAvailable) {
+            PROFILE_SCOPE("Render Particles");
+            performanceMonitor->BeginGPUTimer("Particles");
+            particleShader->use();
+            particleSystem->Render(*particleShader, view, projection);
+            particleManager->Render(*particleShader, view, projection);
+            if (ribbonsAvailable) {
+                ribbonShader->use();
+                particleSystem->RenderRibbons(*ribbonShader, view, projection);
+            }
+            performanceMonitor->EndGPUTimer("Particles");
+        }
+
+        // Upscale to the window; HUD and debug overlays draw after this at native resolution
+        if (scaledScene) {
+            dynamicResolution->EndScene();
+            performanceMonitor->BeginGPUTimer("Upscale");
+            dynamicResolution->Present(0);
+            performanceMonitor->EndGPUTimer("Upscale");
+        }
+        if (showDebugOverlay && debugOverlayAvailable) {
+            renderDebugOverlay(view, projection);
+        }
+        streamBuffer->EndFrame();
+
+        performanceMonitor->EndFrame();
+        Profiler::Get().EndFrame();
+        traceCapture->SetCounter("Particles", (float)(particleSystem->GetParticleCount() + particleManager->GetParticleCount()));
+        traceCapture->SetCounter("Stream Buffer (KB)", streamBuffer->GetFrameBytes() / 1024.0f);
+        traceCapture->SetCounter("GPU Memory (MB)", performanceMonitor->GetGpuMemoryUsage() / (1024.0f * 1024.0f));
+        if (scaledScene) {
+            traceCapture->SetCounter("Render Scale", dynamicResolution->GetScale());
+        }
+        traceCapture->EndFrame(Profiler::Get(), &performanceMonitor->GetGpuProfiler());
 
-        // Render objects
-        sceneManager->Render(*shaderManager);
+        // Steady state starts once the warm-up has filled every pool and buffer
+        AllocationTracker::Get().EndFrame();
+        if (allocationCheckWarmup > 0 && --allocationCheckWarmup == 0) {
+            AllocationTracker::Get().SetSteadyStateCheck(true);
+        }
 
-        // Swap buffers and poll events
+        // Otherwise pace the presentation of the finished frame
+        if (!framePacer->GetLatencyReduction()) {
+            framePacer->WaitForNextFrame();
+            performanceMonitor->RecordPacingJitter(framePacer->GetLastJitter());
+        }
+
+        // Swap buffers
         glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 
     // Cleanup
+    traceCapture->WaitForWriter();
+    debugRenderer->Cleanup();
+    particleSystem->Cleanup();
+    particleManager->Cleanup();
+    streamBuffer->Cleanup();
+    dynamicResolution->Cleanup();
+    deferredRenderer->Cleanup();
+    clusteredLighting->Cleanup();
     glfwTerminate();
+
+    size_t allocationViolations = AllocationTracker::Get().GetSteadyStateViolationCount();
+    if (allocationViolations > 0) {
+        std::cout << "ERROR: " << allocationViolations << " steady-state frames allocated!" << std::endl;
+        return 1;
+    }
     return 0;
 }
 
+const char* GetRenderPathName(RenderPath path) {
+    switch (path) {
+        case RenderPath::Forward: return "Forward";
+        case RenderPath::Clustered: return "Clustered";
+        case RenderPath::Deferred: return "Deferred";
+    }
+    return "Unknown";
+}
+
+void renderScene(const glm::mat4& view, const glm::mat4& projection, GLuint sceneFramebuffer, int width, int height) {
+    PROFILE_SCOPE("Render Scene");
+    const char* pathName = GetRenderPathName(renderPath);
+
+    if (renderPath == RenderPath::Deferred) {
+        // G-buffer fill, light volumes, then copy color + depth to the scene target
+        deferredRenderer->SetViewport(width, height);
+        performanceMonitor->BeginGPUTimer(pathName);
+        performanceMonitor->BeginGPUTimer("Deferred Geometry");
+        ShaderManager& geometryShader = deferredRenderer->BeginGeometryPass(view, projection);
+        sceneManager->Render(geometryShader);
+        deferredRenderer->EndGeometryPass();
+        performanceMonitor->EndGPUTimer("Deferred Geometry");
+
+        performanceMonitor->BeginGPUTimer("Deferred Lighting");
+        deferredRenderer->LightingPass(sceneManager->GetLights(), sceneManager->GetAmbientLight(),
+                                       camera.Position, view, projection);
+        deferredRenderer->Present(sceneFramebuffer);
+        performanceMonitor->EndGPUTimer("Deferred Lighting");
+        performanceMonitor->EndGPUTimer(pathName);
+        return;
+    }
+
+    bool prePass = useDepthPrePass && depthPrePassAvailable;
+    if (prePass) {
+        // Lay down depth with the position-only stream and no color writes
+        performanceMonitor->BeginGPUTimer("Depth Pre-Pass");
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+
+        depthShader->use();
+        depthShader->setMat4Value("view", view);
+        depthShader->setMat4Value("projection", projection);
+        sceneManager->RenderDepth(*depthShader);
+
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        performanceMonitor->EndGPUTimer("Depth Pre-Pass");
+
+        // Shade only the visible surface of each pixel
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    performanceMonitor->BeginGPUTimer(pathName);
+    ShaderManager& sceneShader = renderPath == RenderPath::Clustered ? *clusteredShader : *shaderManager;
+    sceneShader.use();
+    sceneShader.setMat4Value("view", view);
+    sceneShader.setMat4Value("projection", projection);
+    sceneShader.setVec3Value("viewPos", camera.Position);
+    
+    if (renderPath == RenderPath::Clustered) {
+        // Bin point/spot lights into the froxel grid for this view
+        PROFILE_SCOPE("Light Binning");
+        clusteredLighting->SetProjection(camera.Zoom, width, height, 0.1f, 100.0f);
+        clusteredLighting->Update(sceneManager->GetLights(), view);
+        clusteredLighting->Bind(sceneShader, 2);
+    }
+
+    // Render objects
+    sceneManager->Render(sceneShader);
+    performanceMonitor->EndGPUTimer(pathName);
+
+    if (prePass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+}
+
+void renderDebugOverlay(const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_SCOPE("Debug Overlay");
+
+    // Light ranges as wireframe spheres, drawn over the final image
+    debugRenderer->Clear();
+    for (const auto& light : sceneManager->GetLights()) {
+        if (!light->enabled || light->type == LightType::DIRECTIONAL) continue;
+        debugRenderer->DrawWireframeSphere(light->position, light->GetRange(), light->diffuse);
+    }
+
+    debugShader->use();
+    debugRenderer->Render(*debugShader, view, projection);
+    glEnable(GL_DEPTH_TEST);
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
     if (viewManager) {
         viewManager->UpdateViewport(width, height);
     }
+    if (dynamicResolution) {
+        dynamicResolution->Resize(width, height);
+    }
+    if (deferredRenderer) {
+        deferredRenderer->Resize(width, height);
+    }
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
@@ -148,6 +537,107 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     camera.ProcessMouseScroll(yoffset);
 }
 
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (action != GLFW_PRESS) return;
+
+    // Select the render path: 1 = forward, 2 = clustered, 3 = deferred
+    RenderPath requested = renderPath;
+    if (key == GLFW_KEY_1) requested = RenderPath::Forward;
+    if (key == GLFW_KEY_2 && clusteredAvailable) requested = RenderPath::Clustered;
+    if (key == GLFW_KEY_3 && deferredAvailable) requested = RenderPath::Deferred;
+    if (requested != renderPath) {
+        renderPath = requested;
+        std::cout << "Render path: " << GetRenderPathName(renderPath) << std::endl;
+    }
+
+    // Toggle the depth pre-pass for the forward paths
+    if (key == GLFW_KEY_Z && depthPrePassAvailable) {
+        useDepthPrePass = !useDepthPrePass;
+        std::cout << "Depth pre-pass: " << (useDepthPrePass ? "on" : "off") << std::endl;
+    }
+
+    // Dynamic resolution: R toggles scaling, F switches the upscale filter
+    if (key == GLFW_KEY_R && dynamicResolutionAvailable) {
+        dynamicResolution->SetEnabled(!dynamicResolution->IsEnabled());
+        std::cout << "Dynamic resolution: " << (dynamicResolution->IsEnabled() ? "on" : "off") << std::endl;
+    }
+    if (key == GLFW_KEY_F && dynamicResolutionAvailable) {
+        bool sharpen = dynamicResolution->GetUpscaleFilter() == DynamicResolution::UpscaleFilter::Bilinear;
+        dynamicResolution->SetUpscaleFilter(sharpen ? DynamicResolution::UpscaleFilter::Sharpen
+                                                    : DynamicResolution::UpscaleFilter::Bilinear);
+        std::cout << "Upscale filter: " << (sharpen ? "sharpen" : "bilinear") << std::endl;
+    }
+
+    // Frame pacing: T cycles the frame rate cap, L toggles latency reduction
+    if (key == GLFW_KEY_T) {
+        const float targets[] = { 30.0f, 60.0f, 120.0f, 0.0f };
+        int next = 0;
+        for (int i = 0; i < 4; i++) {
+            if (framePacer->GetTargetFPS() == targets[i]) next = (i + 1) % 4;
+        }
+        framePacer->SetTargetFPS(targets[next]);
+        if (targets[next] > 0.0f) {
+            std::cout << "Frame rate cap: " << targets[next] << " FPS" << std::endl;
+        } else {
+            std::cout << "Frame rate cap: off" << std::endl;
+        }
+    }
+    if (key == GLFW_KEY_L) {
+        framePacer->SetLatencyReduction(!framePacer->GetLatencyReduction());
+        std::cout << "Latency reduction: " << (framePacer->GetLatencyReduction() ? "on" : "off") << std::endl;
+    }
+
+    // Toggle between CPU and GPU (transform feedback) particle simulation
+    if (key == GLFW_KEY_U && particlesAvailable) {
+        bool gpu = particleSystem->GetSimulationMode() == SimulationMode::CPU;
+        if (particleSystem->SetSimulationMode(gpu ? SimulationMode::GPU : SimulationMode::CPU)) {
+            std::cout << "Particle simulation: " << (gpu ? "GPU" : "CPU") << std::endl;
+        }
+    }
+
+    // Toggle the native-resolution debug overlay
+    if (key == GLFW_KEY_G) {
+        showDebugOverlay = !showDebugOverlay;
+    }
+
+    // Print per-pass GPU times for comparison
+    if (key == GLFW_KEY_P) {
+        performanceMonitor->UpdateMemoryUsage();
+        performanceMonitor->PrintStatistics();
+        std::cout << "Stream buffer: " << streamBuffer->GetFrameBytes() / 1024 << " KB this frame, "
+                  << streamBuffer->GetReallocationCount() << " reallocations, "
+                  << streamBuffer->GetFenceWaitCount() << " fence waits" << std::endl;
+        const char* sortMethods[] = { "none", "insertion", "radix" };
+        std::cout << "Particle sort: " << particleSystem->GetSortTime() << " ms ("
+                  << sortMethods[(int)particleSystem->GetLastSortMethod()] << ")" << std::endl;
+        for (size_t i = 0; i < particleSystem->GetForceCount(); i++) {
+            std::cout << "Particle force " << particleSystem->GetForce(i).GetName() << ": "
+                      << particleSystem->GetForceTime(i) << " ms" << std::endl;
+        }
+        std::cout << "Particle manager: " << particleManager->GetEmitterCount() << " emitters, "
+                  << particleManager->GetParticleCount() << " particles, "
+                  << particleManager->GetDrawCallCount() << " draws, "
+                  << particleManager->GetUpdateTime() << " ms update" << std::endl;
+        if (dynamicResolutionAvailable && dynamicResolution->IsEnabled()) {
+            std::cout << "Render scale: " << dynamicResolution->GetScale()
+                      << " (" << dynamicResolution->GetRenderWidth() << "x" << dynamicResolution->GetRenderHeight()
+                      << ", smoothed GPU " << dynamicResolution->GetSmoothedFrameTime() << " ms)" << std::endl;
+        }
+        std::cout << Profiler::Get().GetFrameReport();
+        if (AllocationTracker::IsCompiledIn()) {
+            AllocationTracker& allocations = AllocationTracker::Get();
+            std::cout << "Heap: " << allocations.GetFrameAllocationCount() << " allocations ("
+                      << allocations.GetFrameAllocatedBytes() << " bytes) last frame" << std::endl
+                      << allocations.GetFrameReport();
+        }
+    }
+
+    // Capture the next frames as a Chrome/Perfetto trace
+    if (key == GLFW_KEY_C) {
+        traceCapture->Start(TraceCapture::DEFAULT_FRAME_COUNT);
+    }
+}
+
 void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
@@ -0,0 +1,168 @@
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+MemoryTracker::MemoryTracker()
+    : m_total(0), m_peakTotal(0) {
+    std::fill(m_current, m_current + (int)MemoryCategory::Count, 0);
+    std::fill(m_peak, m_peak + (int)MemoryCategory::Count, 0);
+}
+
+MemoryTracker& MemoryTracker::Get() {
+    static MemoryTracker tracker;
+    return tracker;
+}
+
+void MemoryTracker::TrackBuffer(GLuint buffer, size_t bytes, MemoryCategory category) {
+    Track(ObjectType::Buffer, buffer, bytes, category);
+}
+
+void MemoryTracker::TrackTexture(GLuint texture, size_t bytes, MemoryCategory category) {
+    Track(ObjectType::Texture, texture, bytes, category);
+}
+
+void MemoryTracker::TrackRenderbuffer(GLuint renderbuffer, size_t bytes, MemoryCategory category) {
+    Track(ObjectType::Renderbuffer, renderbuffer, bytes, category);
+}
+
+void MemoryTracker::ReleaseBuffer(GLuint buffer) {
+    Release(ObjectType::Buffer, buffer);
+}
+
+void MemoryTracker::ReleaseTexture(GLuint texture) {
+    Release(ObjectType::Texture, texture);
+}
+
+void MemoryTracker::ReleaseRenderbuffer(GLuint renderbuffer) {
+    Release(ObjectType::Renderbuffer, renderbuffer);
+}
+
+void MemoryTracker::ResetPeaks() {
+    std::copy(m_current, m_current + (int)MemoryCategory::Count, m_peak);
+    m_peakTotal = m_total;
+}
+
+const char* MemoryTracker::GetCategoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Meshes: return "Meshes";
+        case MemoryCategory::Particles: return "Particles";
+        case MemoryCategory::Shadows: return "Shadows";
+        case MemoryCategory::Debug: return "Debug";
+        case MemoryCategory::Lighting: return "Lighting";
+        case MemoryCategory::RenderTargets: return "Render Targets";
+        case MemoryCategory::Streaming: return "Streaming";
+        case MemoryCategory::Count: break;
+    }
+    return "Unknown";
+}
+
+size_t MemoryTracker::GetTextureSize(int width, int height, GLenum internalFormat) {
+    size_t bytesPerTexel = 4;
+    switch (internalFormat) {
+        case GL_R8:
+            bytesPerTexel = 1;
+            break;
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            bytesPerTexel = 2;
+            break;
+        case GL_RGB8:
+        case GL_RGB:
+            bytesPerTexel = 3;
+            break;
+        case GL_RGB16F:
+            bytesPerTexel = 6;
+            break;
+        case GL_RGBA16F:
+        case GL_RG32F:
+        case GL_DEPTH32F_STENCIL8:
+            bytesPerTexel = 8;
+            break;
+        case GL_RGB32F:
+            bytesPerTexel = 12;
+            break;
+        case GL_RGBA32F:
+            bytesPerTexel = 16;
+            break;
+        default:
+            // RGBA8, RGB10_A2, R11F_G11F_B10F, RG16F, R32F, 24/32-bit depth,
+            // DEPTH24_STENCIL8 and unsized depth are all 32 bits per texel
+            break;
+    }
+    return (size_t)std::max(width, 0) * (size_t)std::max(height, 0) * bytesPerTexel;
+}
+
+bool MemoryTracker::ReadProcessMemory(ProcessMemoryInfo& info) {
+    info = ProcessMemoryInfo();
+#ifdef __linux__
+    // statm: total, resident and file-backed pages (one small read)
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return false;
+    unsigned long long pages = 0, resident = 0, shared = 0;
+    int fields = std::fscanf(statm, "%llu %llu %llu", &pages, &resident, &shared);
+    std::fclose(statm);
+    if (fields != 3) return false;
+
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    info.virtualBytes = (size_t)pages * pageSize;
+    info.residentBytes = (size_t)resident * pageSize;
+    info.sharedBytes = (size_t)shared * pageSize;
+
+    // smaps_rollup (Linux 4.14+): proportional, private and swapped totals in kB
+    FILE* rollup = std::fopen("/proc/self/smaps_rollup", "r");
+    if (rollup) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), rollup)) {
+            unsigned long long kilobytes = 0;
+            char key[64];
+            if (std::sscanf(line, "%63[^:]: %llu kB", key, &kilobytes) != 2) continue;
+            size_t bytes = (size_t)kilobytes * 1024;
+            if (std::strcmp(key, "Pss") == 0) info.proportionalBytes = bytes;
+            else if (std::strcmp(key, "Private_Clean") == 0) info.privateBytes += bytes;
+            else if (std::strcmp(key, "Private_Dirty") == 0) info.privateBytes += bytes;
+            else if (std::strcmp(key, "Swap") == 0) info.swapBytes = bytes;
+        }
+        std::fclose(rollup);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MemoryTracker::Track(ObjectType type, GLuint name, size_t bytes, MemoryCategory category) {
+    if (name == 0) return;
+
+    // Look up first: emplace builds a node even when the key exists, and
+    // streamed buffers are re-tracked every frame
+    uint64_t key = GetKey(type, name);
+    auto it = m_allocations.find(key);
+    if (it == m_allocations.end()) {
+        it = m_allocations.emplace(key, Allocation{ 0, category }).first;
+    }
+    Allocation& allocation = it->second;
+    m_current[(int)allocation.category] -= allocation.bytes;
+    m_total -= allocation.bytes;
+
+    allocation = { bytes, category };
+    int index = (int)category;
+    m_current[index] += bytes;
+    m_total += bytes;
+    m_peak[index] = std::max(m_peak[index], m_current[index]);
+    m_peakTotal = std::max(m_peakTotal, m_total);
+}
+
+void MemoryTracker::Release(ObjectType type, GLuint name) {
+    auto it = m_allocations.find(GetKey(type, name));
+    if (it == m_allocations.end()) return;
+
+    m_current[(int)it->second.category] -= it->second.bytes;
+    m_total -= it->second.bytes;
+    m_allocations.erase(it);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Subsystems GPU allocations are attributed to
+enum class MemoryCategory {
+    Meshes,
+    Particles,
+    Shadows,
+    Debug,
+    Lighting,
+    RenderTargets,
+    Streaming,     // the shared per-frame stream buffer (particles and debug lines)
+    Count
+};
+
+// CPU-side memory of this process in bytes (0 where the platform has no source)
+struct ProcessMemoryInfo {
+    size_t virtualBytes = 0;
+    size_t residentBytes = 0;      // RSS
+    size_t sharedBytes = 0;        // resident pages backed by files
+    size_t proportionalBytes = 0;  // PSS: shared pages split between the processes mapping them
+    size_t privateBytes = 0;       // resident pages only this process maps
+    size_t swapBytes = 0;
+};
+
+// Memory accounting without vendor extensions. CPU numbers come from
+// /proc/self/statm and /proc/self/smaps_rollup on Linux. GPU numbers come
+// from the engine itself: every buffer, texture and renderbuffer is
+// reported with its size when its storage is (re)specified and released
+// when deleted, so the totals are what the engine asked for (drivers add
+// alignment and padding on top). Tracking calls belong on the GL thread.
+class MemoryTracker {
+public:
+    static MemoryTracker& Get();
+
+    // Storage of a GL object was (re)allocated; replaces its previous size
+    void TrackBuffer(GLuint buffer, size_t bytes, MemoryCategory category);
+    void TrackTexture(GLuint texture, size_t bytes, MemoryCategory category);
+    void TrackRenderbuffer(GLuint renderbuffer, size_t bytes, MemoryCategory category);
+    // The object was deleted (unknown or zero names are ignored)
+    void ReleaseBuffer(GLuint buffer);
+    void ReleaseTexture(GLuint texture);
+    void ReleaseRenderbuffer(GLuint renderbuffer);
+
+    // Bytes per category; peaks since start or ResetPeaks()
+    size_t GetGpuUsage(MemoryCategory category) const { return m_current[(int)category]; }
+    size_t GetPeakGpuUsage(MemoryCategory category) const { return m_peak[(int)category]; }
+    size_t GetTotalGpuUsage() const { return m_total; }
+    size_t GetPeakTotalGpuUsage() const { return m_peakTotal; }
+    size_t GetTrackedObjectCount() const { return m_allocations.size(); }
+    void ResetPeaks();
+
+    static const char* GetCategoryName(MemoryCategory category);
+    // Bytes of a level-0 image in a sized (or common unsized) internal format
+    static size_t GetTextureSize(int width, int height, GLenum internalFormat);
+
+    // Read the process counters; false where they are unavailable
+    static bool ReadProcessMemory(ProcessMemoryInfo& info);
+
+private:
+    enum class ObjectType : uint64_t {
+        Buffer,
+        Texture,
+        Renderbuffer
+    };
+
+    struct Allocation {
+        size_t bytes;
+        MemoryCategory category;
+    };
+
+    MemoryTracker();
+
+    // GL names are unique per object type only
+    std::unordered_map<uint64_t, Allocation> m_allocations;
+    size_t m_current[(int)MemoryCategory::Count];
+    size_t m_peak[(int)MemoryCategory::Count];
+    size_t m_total;
+    size_t m_peakTotal;
+
+    // Helper methods
+    void Track(ObjectType type, GLuint name, size_t bytes, MemoryCategory category);
+    void Release(ObjectType type, GLuint name);
+    static uint64_t GetKey(ObjectType type, GLuint name) { return ((uint64_t)type << 32) | name; }
+};
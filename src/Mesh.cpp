@@ -0,0 +1,184 @@
+#include "Mesh.h"
+#include "MemoryTracker.h"
+#include <cmath>
+#include <cstddef>
+
+Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+    : m_vertices(vertices), m_indices(indices),
+      m_VAO(0), m_VBO(0), m_EBO(0), m_positionVAO(0), m_positionVBO(0) {
+}
+
+Mesh::~Mesh() {
+    Cleanup();
+}
+
+void Mesh::Draw() {
+    if (!m_VAO) Upload();
+
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, (GLsizei)m_indices.size(), GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+void Mesh::DrawPositions() {
+    if (!m_VAO) Upload();
+
+    glBindVertexArray(m_positionVAO);
+    glDrawElements(GL_TRIANGLES, (GLsizei)m_indices.size(), GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+void Mesh::Cleanup() {
+    if (m_VAO) {
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteVertexArrays(1, &m_positionVAO);
+        glDeleteBuffers(1, &m_VBO);
+        glDeleteBuffers(1, &m_positionVBO);
+        glDeleteBuffers(1, &m_EBO);
+        MemoryTracker::Get().ReleaseBuffer(m_VBO);
+        MemoryTracker::Get().ReleaseBuffer(m_positionVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_EBO);
+    }
+    m_VAO = m_VBO = m_EBO = 0;
+    m_positionVAO = m_positionVBO = 0;
+}
+
+void Mesh::Upload() {
+    std::vector<glm::vec3> positions;
+    positions.reserve(m_vertices.size());
+    for (const auto& vertex : m_vertices) {
+        positions.push_back(vertex.position);
+    }
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenVertexArrays(1, &m_positionVAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_positionVBO);
+    glGenBuffers(1, &m_EBO);
+
+    // Shading stream, matches the vertex.glsl attribute locations
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex), m_vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(GLuint), m_indices.data(), GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_VBO, m_vertices.size() * sizeof(Vertex), MemoryCategory::Meshes);
+    MemoryTracker::Get().TrackBuffer(m_EBO, m_indices.size() * sizeof(GLuint), MemoryCategory::Meshes);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    glEnableVertexAttribArray(2);
+
+    // Position-only stream for depth passes
+    glBindVertexArray(m_positionVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_positionVBO);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(m_positionVBO, positions.size() * sizeof(glm::vec3), MemoryCategory::Meshes);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+std::shared_ptr<Mesh> Mesh::CreateBox() {
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+
+    // One quad per face so each face gets its own normal
+    const glm::vec3 normals[6] = {
+        glm::vec3( 1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3( 0.0f, 1.0f, 0.0f), glm::vec3( 0.0f, -1.0f, 0.0f),
+        glm::vec3( 0.0f, 0.0f, 1.0f), glm::vec3( 0.0f, 0.0f, -1.0f)
+    };
+
+    for (const glm::vec3& normal : normals) {
+        // Two axes spanning the face, ordered for counter-clockwise winding
+        glm::vec3 u = glm::vec3(normal.y, normal.z, normal.x);
+        glm::vec3 v = glm::cross(normal, u);
+
+        GLuint base = (GLuint)vertices.size();
+        const glm::vec2 corners[4] = {
+            glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f)
+        };
+        for (const glm::vec2& corner : corners) {
+            Vertex vertex;
+            vertex.position = (normal + u * corner.x + v * corner.y) * 0.5f;
+            vertex.normal = normal;
+            vertex.texCoord = corner * 0.5f + glm::vec2(0.5f);
+            vertices.push_back(vertex);
+        }
+
+        indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+    }
+
+    return std::make_shared<Mesh>(vertices, indices);
+}
+
+std::shared_ptr<Mesh> Mesh::CreateCylinder(int segments) {
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    const float radius = 0.5f;
+    const float halfHeight = 0.5f;
+
+    // Side wall
+    for (int i = 0; i <= segments; i++) {
+        float angle = 2.0f * (float)M_PI * i / segments;
+        glm::vec3 normal(std::cos(angle), 0.0f, std::sin(angle));
+        float u = (float)i / segments;
+
+        Vertex bottom;
+        bottom.position = glm::vec3(normal.x * radius, -halfHeight, normal.z * radius);
+        bottom.normal = normal;
+        bottom.texCoord = glm::vec2(u, 0.0f);
+
+        Vertex top = bottom;
+        top.position.y = halfHeight;
+        top.texCoord = glm::vec2(u, 1.0f);
+
+        vertices.push_back(bottom);
+        vertices.push_back(top);
+    }
+    for (int i = 0; i < segments; i++) {
+        GLuint base = i * 2;
+        indices.insert(indices.end(), { base, base + 1, base + 3, base, base + 3, base + 2 });
+    }
+
+    // Caps as triangle fans around a center vertex
+    for (int side = 0; side < 2; side++) {
+        float y = side == 0 ? -halfHeight : halfHeight;
+        glm::vec3 normal(0.0f, side == 0 ? -1.0f : 1.0f, 0.0f);
+
+        GLuint center = (GLuint)vertices.size();
+        Vertex centerVertex;
+        centerVertex.position = glm::vec3(0.0f, y, 0.0f);
+        centerVertex.normal = normal;
+        centerVertex.texCoord = glm::vec2(0.5f);
+        vertices.push_back(centerVertex);
+
+        for (int i = 0; i <= segments; i++) {
+            float angle = 2.0f * (float)M_PI * i / segments;
+            Vertex rim;
+            rim.position = glm::vec3(std::cos(angle) * radius, y, std::sin(angle) * radius);
+            rim.normal = normal;
+            rim.texCoord = glm::vec2(std::cos(angle), std::sin(angle)) * 0.5f + glm::vec2(0.5f);
+            vertices.push_back(rim);
+        }
+
+        for (int i = 0; i < segments; i++) {
+            GLuint rim = center + 1 + i;
+            if (side == 0) {
+                indices.insert(indices.end(), { center, rim, rim + 1 });
+            } else {
+                indices.insert(indices.end(), { center, rim + 1, rim });
+            }
+        }
+    }
+
+    return std::make_shared<Mesh>(vertices, indices);
+}
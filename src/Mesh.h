@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+
+// Indexed triangle mesh. Besides the interleaved vertex buffer used for
+// shading, it keeps a tightly packed position-only stream so depth-only
+// passes fetch 12 bytes per vertex instead of 32. GPU buffers are created
+// lazily on the first draw, so meshes can be built without a GL context.
+class Mesh {
+public:
+    Mesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
+    ~Mesh();
+
+    // Rendering
+    void Draw();
+    void DrawPositions();
+    void Cleanup();
+
+    // Mesh information
+    size_t GetVertexCount() const { return m_vertices.size(); }
+    size_t GetIndexCount() const { return m_indices.size(); }
+
+    // Primitive factories (unit size, centered on the origin)
+    static std::shared_ptr<Mesh> CreateBox();
+    static std::shared_ptr<Mesh> CreateCylinder(int segments = 16);
+
+private:
+    std::vector<Vertex> m_vertices;
+    std::vector<GLuint> m_indices;
+
+    // Full vertex format (position, normal, texcoord)
+    GLuint m_VAO, m_VBO, m_EBO;
+    // Position-only stream sharing the same index buffer
+    GLuint m_positionVAO, m_positionVBO;
+
+    void Upload();
+};
@@ -1,6 +1,8 @@
 #include "Object3D.h"
 #include "ShaderManager.h"
+#include "Mesh.h"
 #include <algorithm>
+#include <cmath>
 
 Object3D::Object3D(const std::string& name) 
     : name(name), position(0.0f), rotation(0.0f), scale(1.0f), 
@@ -77,6 +79,11 @@ void Object3D::Render(ShaderManager& shader) {
     shader.setFloatValue("material.shininess", shininess);
     shader.setBoolValue("useTexture", useTexture);
     
+    // Draw geometry
+    if (mesh) {
+        mesh->Draw();
+    }
+    
     // Render children
     RenderChildren(shader, modelMatrix);
 }
@@ -95,10 +102,40 @@ void Object3D::Render(ShaderManager& shader, const glm::mat4& parentMatrix) {
     shader.setFloatValue("material.shininess", shininess);
     shader.setBoolValue("useTexture", useTexture);
     
+    // Draw geometry
+    if (mesh) {
+        mesh->Draw();
+    }
+    
     // Render children
     RenderChildren(shader, worldMatrix);
 }
 
+void Object3D::RenderDepth(ShaderManager& shader) {
+    if (!visible) return;
+    
+    // Same matrix path as Render() so depth values match exactly
+    glm::mat4 modelMatrix = GetWorldMatrix();
+    if (mesh) {
+        shader.setMat4Value("model", modelMatrix);
+        mesh->DrawPositions();
+    }
+    
+    RenderChildrenDepth(shader, modelMatrix);
+}
+
+void Object3D::RenderDepth(ShaderManager& shader, const glm::mat4& parentMatrix) {
+    if (!visible) return;
+    
+    glm::mat4 worldMatrix = parentMatrix * GetModelMatrix();
+    if (mesh) {
+        shader.setMat4Value("model", worldMatrix);
+        mesh->DrawPositions();
+    }
+    
+    RenderChildrenDepth(shader, worldMatrix);
+}
+
 void Object3D::AddChild(std::shared_ptr<Object3D> child) {
     if (child) {
         child->SetParent(shared_from_this());
@@ -134,6 +171,22 @@ void Object3D::SetBoundingBox(const glm::vec3& min, const glm::vec3& max) {
     m_boundingBoxMax = max;
 }
 
+void Object3D::GetWorldBoundingBox(glm::vec3& min, glm::vec3& max) const {
+    // Transform the center, and bound the rotated extents by their absolute projections
+    glm::mat4 world = GetWorldMatrix();
+    glm::vec3 center = (m_boundingBoxMin + m_boundingBoxMax) * 0.5f;
+    glm::vec3 extent = (m_boundingBoxMax - m_boundingBoxMin) * 0.5f;
+    glm::vec3 worldCenter(world * glm::vec4(center, 1.0f));
+    glm::vec3 worldExtent(0.0f);
+    for (int axis = 0; axis < 3; axis++) {
+        for (int column = 0; column < 3; column++) {
+            worldExtent[axis] += std::abs(world[column][axis]) * extent[column];
+        }
+    }
+    min = worldCenter - worldExtent;
+    max = worldCenter + worldExtent;
+}
+
 void Object3D::UpdateChildren(float deltaTime) {
     for (auto& child : m_children) {
         child->Update(deltaTime);
@@ -145,3 +198,9 @@ void Object3D::RenderChildren(ShaderManager& shader, const glm::mat4& parentMatr
         child->Render(shader, parentMatrix);
     }
 }
+
+void Object3D::RenderChildrenDepth(ShaderManager& shader, const glm::mat4& parentMatrix) {
+    for (auto& child : m_children) {
+        child->RenderDepth(shader, parentMatrix);
+    }
+}
@@ -7,8 +7,9 @@
 #include <memory>
 
 class ShaderManager;
+class Mesh;
 
-class Object3D {
+class Object3D : public std::enable_shared_from_this<Object3D> {
 public:
     Object3D(const std::string& name);
     virtual ~Object3D() = default;
@@ -23,6 +24,9 @@ public:
     float shininess;
     bool useTexture;
     
+    // Geometry (optional; objects without a mesh only act as transform nodes)
+    std::shared_ptr<Mesh> mesh;
+    
     // Object identification
     std::string name;
     bool visible;
@@ -44,6 +48,10 @@ public:
     virtual void Render(ShaderManager& shader);
     virtual void Render(ShaderManager& shader, const glm::mat4& parentMatrix);
     
+    // Depth-only rendering with the position-only vertex stream
+    virtual void RenderDepth(ShaderManager& shader);
+    virtual void RenderDepth(ShaderManager& shader, const glm::mat4& parentMatrix);
+    
     // Object hierarchy
     void AddChild(std::shared_ptr<Object3D> child);
     void RemoveChild(const std::string& childName);
@@ -57,6 +65,8 @@ public:
     glm::vec3 GetBoundingBoxMin() const { return m_boundingBoxMin; }
     glm::vec3 GetBoundingBoxMax() const { return m_boundingBoxMax; }
     void SetBoundingBox(const glm::vec3& min, const glm::vec3& max);
+    // Axis-aligned bounds of the local box after the world transform
+    void GetWorldBoundingBox(glm::vec3& min, glm::vec3& max) const;
 
 protected:
     std::vector<std::shared_ptr<Object3D>> m_children;
@@ -66,4 +76,5 @@ protected:
     
     void UpdateChildren(float deltaTime);
     void RenderChildren(ShaderManager& shader, const glm::mat4& parentMatrix);
+    void RenderChildrenDepth(ShaderManager& shader, const glm::mat4& parentMatrix);
 };
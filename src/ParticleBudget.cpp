@@ -0,0 +1,128 @@
+#include "ParticleBudget.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    // Gribb-Hartmann planes; the sphere test allows for unnormalized normals
+    bool SphereInFrustum(const glm::mat4& viewProjection, const glm::vec3& center, float radius) {
+        glm::vec4 rows[4];
+        for (int row = 0; row < 4; row++) {
+            rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+                                  viewProjection[2][row], viewProjection[3][row]);
+        }
+
+        for (int axis = 0; axis < 3; axis++) {
+            for (float side : { 1.0f, -1.0f }) {
+                glm::vec4 plane = rows[3] + rows[axis] * side;
+                float normalLength = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+                float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+                if (distance < -radius * normalLength) return false;
+            }
+        }
+        return true;
+    }
+}
+
+ParticleBudget::ParticleBudget()
+    : m_budget(0), m_freezeDistance(50.0f) {
+}
+
+void ParticleBudget::Allocate(const glm::mat4& view, const glm::mat4& projection,
+                              const std::vector<ParticleBudgetRequest>& requests,
+                              std::vector<ParticleBudgetGrant>& grants) {
+    grants.assign(requests.size(), ParticleBudgetGrant());
+
+    // Camera position from the inverse of the view's rigid transform
+    glm::vec3 translation(view[3]);
+    glm::vec3 cameraPosition(
+        -(view[0][0] * translation.x + view[0][1] * translation.y + view[0][2] * translation.z),
+        -(view[1][0] * translation.x + view[1][1] * translation.y + view[1][2] * translation.z),
+        -(view[2][0] * translation.x + view[2][1] * translation.y + view[2][2] * translation.z));
+    glm::mat4 viewProjection = projection * view;
+    float focalScale = projection[1][1];   // cot(fov / 2)
+
+    // Score every emitter, and charge frozen emitters' particles up front
+    size_t frozenLive = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        const ParticleBudgetRequest& request = requests[i];
+        ParticleBudgetGrant& grant = grants[i];
+
+        glm::vec3 offset = request.position - cameraPosition;
+        float distance = std::sqrt(offset.x * offset.x + offset.y * offset.y + offset.z * offset.z);
+        grant.visible = SphereInFrustum(viewProjection, request.position, request.radius);
+
+        // Fraction of the screen height the bounding sphere covers
+        grant.importance = std::min(1.0f, request.radius * focalScale / std::max(distance, request.radius));
+        if (!grant.visible) {
+            grant.importance *= OFFSCREEN_IMPORTANCE;
+            grant.updateInterval = distance > m_freezeDistance ? 0 : COARSE_UPDATE_INTERVAL;
+        }
+
+        if (grant.updateInterval == 0) {
+            grant.importance = 0.0f;
+            grant.emissionScale = 0.0f;
+            grant.maxLive = request.liveCount;
+            frozenLive += request.liveCount;
+        } else {
+            // Demand is the mean live count; random lifetimes run above it,
+            // so only the over-budget water-fill caps live particles
+            grant.maxLive = SIZE_MAX;
+        }
+    }
+
+    if (m_budget == 0) return;
+
+    size_t totalDemand = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (grants[i].updateInterval != 0) totalDemand += requests[i].demand;
+    }
+    size_t available = m_budget > frozenLive ? m_budget - frozenLive : 0;
+    if (totalDemand <= available) return;
+
+    // Water-fill: emitters whose demand fits their weighted share are
+    // satisfied and leave the pass; the remainder is shared again
+    std::vector<float>& granted = m_granted;
+    std::vector<char>& open = m_open;
+    granted.assign(requests.size(), 0.0f);
+    open.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        open[i] = grants[i].updateInterval != 0 && grants[i].importance > 0.0f && requests[i].demand > 0;
+    }
+
+    float remaining = (float)available;
+    for (size_t pass = 0; pass < requests.size(); pass++) {
+        float weightSum = 0.0f;
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (open[i]) weightSum += grants[i].importance;
+        }
+        if (weightSum <= 0.0f || remaining <= 0.0f) break;
+
+        bool satisfied = false;
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (open[i] && (float)requests[i].demand <= remaining * grants[i].importance / weightSum) {
+                granted[i] = (float)requests[i].demand;
+                open[i] = false;
+                satisfied = true;
+            }
+        }
+        if (!satisfied) {
+            for (size_t i = 0; i < requests.size(); i++) {
+                if (open[i]) granted[i] = remaining * grants[i].importance / weightSum;
+            }
+            break;
+        }
+
+        remaining = (float)available;
+        for (size_t i = 0; i < requests.size(); i++) {
+            remaining -= granted[i];
+        }
+    }
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        ParticleBudgetGrant& grant = grants[i];
+        if (grant.updateInterval == 0) continue;
+        grant.maxLive = (size_t)granted[i];
+        grant.emissionScale = requests[i].demand > 0 ? granted[i] / (float)requests[i].demand : 1.0f;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// What the budget needs to know about one emitter
+struct ParticleBudgetRequest {
+    glm::vec3 position;
+    float radius = 1.0f;        // bounding sphere of the emitter's particles
+    size_t demand = 0;          // live particles at full emission rate
+    size_t liveCount = 0;       // particles alive right now
+};
+
+// The budget's decision for one emitter
+struct ParticleBudgetGrant {
+    float importance = 0.0f;    // projected size, reduced when off-screen
+    bool visible = true;
+    size_t maxLive = SIZE_MAX;  // cap on live particles (SIZE_MAX = none)
+    float emissionScale = 1.0f; // multiplier for the emission rate
+    int updateInterval = 1;     // update every N frames; 0 = frozen
+};
+
+// Global particle budget. Emitters are scored by projected size (bounding
+// radius over distance), with off-screen emitters scaled down; the budget
+// is then water-filled by importance, so emitters that need less than their
+// share are satisfied in full and the rest is split among the others.
+// Off-screen emitters update coarsely, and beyond the freeze distance they
+// stop updating and emitting; their live particles stay charged against
+// the budget until they are gone (ParticleManager keeps aging them out).
+class ParticleBudget {
+public:
+    static constexpr float OFFSCREEN_IMPORTANCE = 0.1f;
+    static constexpr int COARSE_UPDATE_INTERVAL = 4;
+
+    ParticleBudget();
+
+    // 0 disables the budget: every emitter gets its full demand
+    void SetBudget(size_t maxParticles) { m_budget = maxParticles; }
+    size_t GetBudget() const { return m_budget; }
+    void SetFreezeDistance(float distance) { m_freezeDistance = distance; }
+    float GetFreezeDistance() const { return m_freezeDistance; }
+
+    // One grant per request, in the same order. Allocation-free once the
+    // scratch buffers have grown to the emitter count.
+    void Allocate(const glm::mat4& view, const glm::mat4& projection,
+                  const std::vector<ParticleBudgetRequest>& requests,
+                  std::vector<ParticleBudgetGrant>& grants);
+
+private:
+    size_t m_budget;
+    float m_freezeDistance;
+
+    // Water-fill scratch, reused every frame
+    std::vector<float> m_granted;
+    std::vector<char> m_open;
+};
@@ -0,0 +1,298 @@
+#include "ParticleCollision.h"
+#include "ParticleData.h"
+#include "Object3D.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_USE_SSE 1
+#endif
+
+namespace {
+    // Added to the penetration of faces the particle is moving away from
+    const float AWAY_PENALTY = 1.0e6f;
+
+    void RespondScalar(ParticleData& p, size_t i, float nx, float ny, float nz, float push,
+                       const ParticleCollisionSettings& settings, float* contacts) {
+        if (contacts) {
+            contacts[i] = 1.0f;
+        }
+        p.px[i] += nx * push;
+        p.py[i] += ny * push;
+        p.pz[i] += nz * push;
+        if (settings.killOnContact) {
+            p.life[i] = 0.0f;
+            return;
+        }
+
+        float vn = p.vx[i] * nx + p.vy[i] * ny + p.vz[i] * nz;
+        if (vn < 0.0f) {
+            float tangentScale = 1.0f - settings.friction;
+            float normalScale = vn * settings.restitution;
+            p.vx[i] = (p.vx[i] - nx * vn) * tangentScale - nx * normalScale;
+            p.vy[i] = (p.vy[i] - ny * vn) * tangentScale - ny * normalScale;
+            p.vz[i] = (p.vz[i] - nz * vn) * tangentScale - nz * normalScale;
+        }
+    }
+
+#ifdef PARTICLE_USE_SSE
+    inline __m128 Select(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+    }
+
+    // Same operations as RespondScalar for the lanes in hit
+    void RespondSSE(ParticleData& p, size_t i, __m128 hit, __m128 nx, __m128 ny, __m128 nz, __m128 push,
+                    const ParticleCollisionSettings& settings, float* contacts) {
+        if (contacts) {
+            _mm_storeu_ps(&contacts[i], _mm_or_ps(_mm_loadu_ps(&contacts[i]), _mm_and_ps(hit, _mm_set1_ps(1.0f))));
+        }
+        __m128 px = _mm_loadu_ps(&p.px[i]);
+        __m128 py = _mm_loadu_ps(&p.py[i]);
+        __m128 pz = _mm_loadu_ps(&p.pz[i]);
+        _mm_storeu_ps(&p.px[i], Select(hit, _mm_add_ps(px, _mm_mul_ps(nx, push)), px));
+        _mm_storeu_ps(&p.py[i], Select(hit, _mm_add_ps(py, _mm_mul_ps(ny, push)), py));
+        _mm_storeu_ps(&p.pz[i], Select(hit, _mm_add_ps(pz, _mm_mul_ps(nz, push)), pz));
+        if (settings.killOnContact) {
+            _mm_storeu_ps(&p.life[i], _mm_andnot_ps(hit, _mm_loadu_ps(&p.life[i])));
+            return;
+        }
+
+        __m128 vx = _mm_loadu_ps(&p.vx[i]);
+        __m128 vy = _mm_loadu_ps(&p.vy[i]);
+        __m128 vz = _mm_loadu_ps(&p.vz[i]);
+        __m128 vn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, nx), _mm_mul_ps(vy, ny)), _mm_mul_ps(vz, nz));
+        __m128 respond = _mm_and_ps(hit, _mm_cmplt_ps(vn, _mm_setzero_ps()));
+        __m128 tangentScale = _mm_set1_ps(1.0f - settings.friction);
+        __m128 normalScale = _mm_mul_ps(vn, _mm_set1_ps(settings.restitution));
+
+        __m128 rx = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(vx, _mm_mul_ps(nx, vn)), tangentScale), _mm_mul_ps(nx, normalScale));
+        __m128 ry = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(vy, _mm_mul_ps(ny, vn)), tangentScale), _mm_mul_ps(ny, normalScale));
+        __m128 rz = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(vz, _mm_mul_ps(nz, vn)), tangentScale), _mm_mul_ps(nz, normalScale));
+        _mm_storeu_ps(&p.vx[i], Select(respond, rx, vx));
+        _mm_storeu_ps(&p.vy[i], Select(respond, ry, vy));
+        _mm_storeu_ps(&p.vz[i], Select(respond, rz, vz));
+    }
+#endif
+}
+
+void CollideParticlesWithPlane(ParticleData& p, size_t begin, size_t end,
+                               const CollisionPlane& plane, const ParticleCollisionSettings& settings, float* contacts) {
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const __m128 nx = _mm_set1_ps(plane.normal.x);
+    const __m128 ny = _mm_set1_ps(plane.normal.y);
+    const __m128 nz = _mm_set1_ps(plane.normal.z);
+    const __m128 distance = _mm_set1_ps(plane.distance);
+    for (; i + 4 <= end; i += 4) {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&p.px[i]), nx),
+                                                    _mm_mul_ps(_mm_loadu_ps(&p.py[i]), ny)),
+                                         _mm_mul_ps(_mm_loadu_ps(&p.pz[i]), nz)), distance);
+        __m128 hit = _mm_cmplt_ps(d, _mm_setzero_ps());
+        if (_mm_movemask_ps(hit) == 0) continue;
+        RespondSSE(p, i, hit, nx, ny, nz, _mm_sub_ps(_mm_setzero_ps(), d), settings, contacts);
+    }
+#endif
+
+    for (; i < end; i++) {
+        float d = p.px[i] * plane.normal.x + p.py[i] * plane.normal.y + p.pz[i] * plane.normal.z + plane.distance;
+        if (d < 0.0f) {
+            RespondScalar(p, i, plane.normal.x, plane.normal.y, plane.normal.z, 0.0f - d, settings, contacts);
+        }
+    }
+}
+
+void CollideParticlesWithBox(ParticleData& p, size_t begin, size_t end,
+                             const CollisionBox& box, const ParticleCollisionSettings& settings, float* contacts) {
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const __m128 minX = _mm_set1_ps(box.min.x), maxX = _mm_set1_ps(box.max.x);
+    const __m128 minY = _mm_set1_ps(box.min.y), maxY = _mm_set1_ps(box.max.y);
+    const __m128 minZ = _mm_set1_ps(box.min.z), maxZ = _mm_set1_ps(box.max.z);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 penalty = _mm_set1_ps(AWAY_PENALTY);
+    for (; i + 4 <= end; i += 4) {
+        __m128 px = _mm_loadu_ps(&p.px[i]);
+        __m128 py = _mm_loadu_ps(&p.py[i]);
+        __m128 pz = _mm_loadu_ps(&p.pz[i]);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(px, minX), _mm_cmplt_ps(px, maxX)),
+                                   _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(py, minY), _mm_cmplt_ps(py, maxY)),
+                                              _mm_and_ps(_mm_cmpgt_ps(pz, minZ), _mm_cmplt_ps(pz, maxZ))));
+        if (_mm_movemask_ps(inside) == 0) continue;
+
+        __m128 vx = _mm_loadu_ps(&p.vx[i]);
+        __m128 vy = _mm_loadu_ps(&p.vy[i]);
+        __m128 vz = _mm_loadu_ps(&p.vz[i]);
+
+        // Faces in order -x, +x, -y, +y, -z, +z; the first smallest wins
+        const __m128 depths[6] = {
+            _mm_sub_ps(px, minX), _mm_sub_ps(maxX, px),
+            _mm_sub_ps(py, minY), _mm_sub_ps(maxY, py),
+            _mm_sub_ps(pz, minZ), _mm_sub_ps(maxZ, pz)
+        };
+        const __m128 away[6] = {
+            _mm_cmple_ps(vx, zero), _mm_cmpge_ps(vx, zero),
+            _mm_cmple_ps(vy, zero), _mm_cmpge_ps(vy, zero),
+            _mm_cmple_ps(vz, zero), _mm_cmpge_ps(vz, zero)
+        };
+
+        __m128 best = _mm_add_ps(depths[0], _mm_and_ps(away[0], penalty));
+        __m128 push = depths[0];
+        __m128 nx = minusOne, ny = zero, nz = zero;
+        for (int face = 1; face < 6; face++) {
+            __m128 score = _mm_add_ps(depths[face], _mm_and_ps(away[face], penalty));
+            __m128 better = _mm_cmplt_ps(score, best);
+            __m128 sign = (face & 1) ? one : minusOne;
+            best = Select(better, score, best);
+            push = Select(better, depths[face], push);
+            nx = Select(better, face / 2 == 0 ? sign : zero, nx);
+            ny = Select(better, face / 2 == 1 ? sign : zero, ny);
+            nz = Select(better, face / 2 == 2 ? sign : zero, nz);
+        }
+
+        RespondSSE(p, i, inside, nx, ny, nz, push, settings, contacts);
+    }
+#endif
+
+    for (; i < end; i++) {
+        float x = p.px[i], y = p.py[i], z = p.pz[i];
+        if (!(x > box.min.x && x < box.max.x && y > box.min.y && y < box.max.y && z > box.min.z && z < box.max.z)) {
+            continue;
+        }
+
+        const float depths[6] = { x - box.min.x, box.max.x - x, y - box.min.y, box.max.y - y, z - box.min.z, box.max.z - z };
+        const float velocity[3] = { p.vx[i], p.vy[i], p.vz[i] };
+        int bestFace = 0;
+        float best = depths[0] + (velocity[0] <= 0.0f ? AWAY_PENALTY : 0.0f);
+        for (int face = 1; face < 6; face++) {
+            float v = velocity[face / 2];
+            bool movingAway = (face & 1) ? v >= 0.0f : v <= 0.0f;
+            float score = depths[face] + (movingAway ? AWAY_PENALTY : 0.0f);
+            if (score < best) {
+                best = score;
+                bestFace = face;
+            }
+        }
+
+        float normal[3] = { 0.0f, 0.0f, 0.0f };
+        normal[bestFace / 2] = (bestFace & 1) ? 1.0f : -1.0f;
+        RespondScalar(p, i, normal[0], normal[1], normal[2], depths[bestFace], settings, contacts);
+    }
+}
+
+ParticleColliders::ParticleColliders()
+    : m_gridLow(0), m_gridHigh(0), m_cellSize(DEFAULT_CELL_SIZE) {
+}
+
+void ParticleColliders::AddPlane(const glm::vec3& normal, float distance) {
+    float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    if (length <= 0.0f) return;
+    m_planes.push_back({ normal / length, distance / length });
+}
+
+void ParticleColliders::SetBoxes(const std::vector<CollisionBox>& boxes) {
+    m_boxes = boxes;
+    BuildGrid();
+}
+
+void ParticleColliders::SetBoxesFromObjects(const std::vector<std::shared_ptr<Object3D>>& objects) {
+    std::vector<CollisionBox> boxes;
+    for (const std::shared_ptr<Object3D>& object : objects) {
+        if (!object || !object->visible || !object->mesh) continue;
+        CollisionBox box;
+        object->GetWorldBoundingBox(box.min, box.max);
+        boxes.push_back(box);
+    }
+    SetBoxes(boxes);
+}
+
+void ParticleColliders::SetCellSize(float cellSize) {
+    m_cellSize = std::max(cellSize, 0.01f);
+    BuildGrid();
+}
+
+void ParticleColliders::Query(const glm::vec3& center, float radius, std::vector<uint32_t>& boxes) const {
+    boxes.assign(m_largeBoxes.begin(), m_largeBoxes.end());
+    if (m_cells.empty()) return;
+
+    // Clamp to the occupied cells first: cells outside them are all empty.
+    // Done in float, since a huge radius does not fit an int cell index.
+    glm::ivec3 low, high;
+    for (int axis = 0; axis < 3; axis++) {
+        float first = std::floor((center[axis] - radius) / m_cellSize);
+        float last = std::floor((center[axis] + radius) / m_cellSize);
+        if (first > (float)m_gridHigh[axis] || last < (float)m_gridLow[axis]) return;
+        low[axis] = (int)std::max(first, (float)m_gridLow[axis]);
+        high[axis] = (int)std::min(last, (float)m_gridHigh[axis]);
+    }
+    size_t cellCount = (size_t)(high.x - low.x + 1) * (high.y - low.y + 1) * (high.z - low.z + 1);
+    if (cellCount > m_cells.size()) {
+        // Mostly empty cells: one pass over the boxes is cheaper than a lookup per cell
+        for (uint32_t index = 0; index < m_boxes.size(); index++) {
+            glm::ivec3 boxLow = GetCell(m_boxes[index].min);
+            glm::ivec3 boxHigh = GetCell(m_boxes[index].max);
+            if (boxLow.x <= high.x && boxLow.y <= high.y && boxLow.z <= high.z &&
+                boxHigh.x >= low.x && boxHigh.y >= low.y && boxHigh.z >= low.z) {
+                boxes.push_back(index);
+            }
+        }
+    } else {
+        for (int x = low.x; x <= high.x; x++) {
+            for (int y = low.y; y <= high.y; y++) {
+                for (int z = low.z; z <= high.z; z++) {
+                    auto cell = m_cells.find(GetCellKey(x, y, z));
+                    if (cell != m_cells.end()) {
+                        boxes.insert(boxes.end(), cell->second.begin(), cell->second.end());
+                    }
+                }
+            }
+        }
+    }
+
+    // Boxes spanning several cells show up once per cell
+    std::sort(boxes.begin(), boxes.end());
+    boxes.erase(std::unique(boxes.begin(), boxes.end()), boxes.end());
+}
+
+void ParticleColliders::BuildGrid() {
+    m_cells.clear();
+    m_largeBoxes.clear();
+    m_gridLow = glm::ivec3(0);
+    m_gridHigh = glm::ivec3(0);
+
+    for (uint32_t index = 0; index < m_boxes.size(); index++) {
+        glm::ivec3 low = GetCell(m_boxes[index].min);
+        glm::ivec3 high = GetCell(m_boxes[index].max);
+        size_t cellCount = (size_t)(high.x - low.x + 1) * (high.y - low.y + 1) * (high.z - low.z + 1);
+        if (cellCount > MAX_CELLS_PER_BOX) {
+            m_largeBoxes.push_back(index);
+            continue;
+        }
+
+        bool first = m_cells.empty();
+        m_gridLow = first ? low : glm::min(m_gridLow, low);
+        m_gridHigh = first ? high : glm::max(m_gridHigh, high);
+
+        for (int x = low.x; x <= high.x; x++) {
+            for (int y = low.y; y <= high.y; y++) {
+                for (int z = low.z; z <= high.z; z++) {
+                    m_cells[GetCellKey(x, y, z)].push_back(index);
+                }
+            }
+        }
+    }
+}
+
+glm::ivec3 ParticleColliders::GetCell(const glm::vec3& point) const {
+    return glm::ivec3((int)std::floor(point.x / m_cellSize),
+                      (int)std::floor(point.y / m_cellSize),
+                      (int)std::floor(point.z / m_cellSize));
+}
+
+uint64_t ParticleColliders::GetCellKey(int x, int y, int z) {
+    // 21 bits per axis covers +-1M cells
+    const uint64_t mask = (1u << 21) - 1;
+    return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct ParticleData;
+class Object3D;
+
+// Half-space collider: points with dot(normal, p) + distance < 0 are inside
+struct CollisionPlane {
+    glm::vec3 normal;
+    float distance;
+};
+
+// World-space axis-aligned box collider
+struct CollisionBox {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// Contact response
+struct ParticleCollisionSettings {
+    float restitution = 0.3f;   // fraction of normal speed kept, reflected
+    float friction = 0.1f;      // fraction of tangential speed lost per contact
+    bool killOnContact = false; // contact ends the particle's life instead
+};
+
+// Collision kernels over particles [begin, end). A penetrating particle is
+// pushed back to the surface and, if moving inward, its velocity is split
+// into normal and tangential parts for restitution and friction. Box
+// contacts use the nearest face the particle is moving into, so fast
+// particles are not pushed out the far side of thin boxes. SSE processes
+// four particles per iteration; the scalar tail does the same operations.
+// If contacts is set, contacts[i] becomes 1 for every particle that touched
+// (it is indexed like the particle streams and never cleared here).
+void CollideParticlesWithPlane(ParticleData& particles, size_t begin, size_t end,
+                               const CollisionPlane& plane, const ParticleCollisionSettings& settings,
+                               float* contacts = nullptr);
+void CollideParticlesWithBox(ParticleData& particles, size_t begin, size_t end,
+                             const CollisionBox& box, const ParticleCollisionSettings& settings,
+                             float* contacts = nullptr);
+
+// Scene colliders shared by all emitters: a few planes plus boxes binned
+// into a uniform grid, so each emitter only tests boxes near its bounds.
+// Queries are const and safe to run from several threads.
+class ParticleColliders {
+public:
+    static constexpr float DEFAULT_CELL_SIZE = 4.0f;
+    // Boxes covering more cells than this are tested by every query
+    static constexpr size_t MAX_CELLS_PER_BOX = 256;
+
+    ParticleColliders();
+
+    // Planes
+    void AddPlane(const glm::vec3& normal, float distance);
+    void ClearPlanes() { m_planes.clear(); }
+    const std::vector<CollisionPlane>& GetPlanes() const { return m_planes; }
+
+    // Boxes (rebuilds the grid)
+    void SetBoxes(const std::vector<CollisionBox>& boxes);
+    // World bounds of every visible object with a mesh
+    void SetBoxesFromObjects(const std::vector<std::shared_ptr<Object3D>>& objects);
+    const CollisionBox& GetBox(uint32_t index) const { return m_boxes[index]; }
+    size_t GetBoxCount() const { return m_boxes.size(); }
+
+    void SetCellSize(float cellSize);
+    float GetCellSize() const { return m_cellSize; }
+
+    // Indices of boxes that may overlap the sphere, sorted and unique. Only
+    // cells inside the occupied bounds are probed, and a query spanning more
+    // cells than are occupied scans the boxes instead, so a large radius
+    // costs at most one pass over the boxes.
+    void Query(const glm::vec3& center, float radius, std::vector<uint32_t>& boxes) const;
+
+private:
+    std::vector<CollisionPlane> m_planes;
+    std::vector<CollisionBox> m_boxes;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    std::vector<uint32_t> m_largeBoxes;
+    // Cell range of the boxes in m_cells; queries never look outside it
+    glm::ivec3 m_gridLow;
+    glm::ivec3 m_gridHigh;
+    float m_cellSize;
+
+    // Helper methods
+    void BuildGrid();
+    glm::ivec3 GetCell(const glm::vec3& point) const;
+    static uint64_t GetCellKey(int x, int y, int z);
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Allocator for SIMD-friendly arrays (32 bytes covers AVX loads)
+template <typename T, size_t Alignment>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+using AlignedFloatArray = std::vector<float, AlignedAllocator<float, 32>>;
+
+// Particle state as structure-of-arrays: one aligned float stream per
+// component, so update kernels load 4 or 8 particles per instruction.
+// The streams are preallocated to the pool capacity; only the first
+// Count() entries are live, and removal swaps the last particle into
+// the hole so it never shifts the rest of the pool.
+struct ParticleData {
+    static constexpr size_t STREAM_COUNT = 19;
+
+    AlignedFloatArray px, py, pz;
+    AlignedFloatArray vx, vy, vz;
+    AlignedFloatArray ax, ay, az;
+    AlignedFloatArray r, g, b, a;
+    AlignedFloatArray life, maxLife;
+    AlignedFloatArray size, rotation, rotationSpeed;
+    AlignedFloatArray trail;  // ParticleRibbons slot, or -1 without a ribbon
+
+    ParticleData() : m_count(0) {}
+
+    size_t Count() const { return m_count; }
+    size_t Capacity() const { return px.size(); }
+    bool Empty() const { return m_count == 0; }
+    bool Full() const { return m_count == px.size(); }
+
+    // Reallocates the streams; particles beyond the new capacity are dropped
+    void SetCapacity(size_t capacity);
+    // Sets the live count, growing the capacity if needed
+    void Resize(size_t count);
+    void Clear() { m_count = 0; }
+
+    // Claim the next free slot (the caller checks Full() first)
+    size_t Add() { return m_count++; }
+    // Claim count contiguous slots and return the first (the caller checks space)
+    size_t AddRange(size_t count) { size_t first = m_count; m_count += count; return first; }
+    // O(1) removal: the last live particle moves into the hole
+    void SwapRemove(size_t index);
+    // Copy one particle over another across all streams
+    void Move(size_t destination, size_t source);
+    // Replace the contents with source's particles in the given order. The
+    // capacity becomes source's, so the two can be swapped.
+    void Gather(ParticleData& source, const uint32_t* order, size_t count);
+    // Gather in parts: BeginGather sizes this pool, then GatherRange copies
+    // [begin, end) of the order. Disjoint ranges may run on different threads.
+    void BeginGather(const ParticleData& source, size_t count);
+    void GatherRange(ParticleData& source, const uint32_t* order, size_t begin, size_t end);
+
+private:
+    size_t m_count;
+
+    void GetStreams(AlignedFloatArray* streams[STREAM_COUNT]) {
+        AlignedFloatArray* all[STREAM_COUNT] = {
+            &px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az,
+            &r, &g, &b, &a, &life, &maxLife, &size, &rotation, &rotationSpeed,
+            &trail
+        };
+        for (size_t i = 0; i < STREAM_COUNT; i++) {
+            streams[i] = all[i];
+        }
+    }
+
+    template <typename Function>
+    void ForEachStream(Function function) {
+        AlignedFloatArray* streams[STREAM_COUNT];
+        GetStreams(streams);
+        for (AlignedFloatArray* stream : streams) {
+            function(*stream);
+        }
+    }
+};
+
+inline void ParticleData::SetCapacity(size_t capacity) {
+    ForEachStream([capacity](AlignedFloatArray& stream) {
+        stream.resize(capacity);
+        stream.shrink_to_fit();
+    });
+    if (m_count > capacity) {
+        m_count = capacity;
+    }
+}
+
+inline void ParticleData::Resize(size_t count) {
+    if (count > Capacity()) {
+        SetCapacity(count);
+    }
+    m_count = count;
+}
+
+inline void ParticleData::SwapRemove(size_t index) {
+    m_count--;
+    if (index != m_count) {
+        Move(index, m_count);
+    }
+}
+
+inline void ParticleData::Move(size_t destination, size_t source) {
+    ForEachStream([destination, source](AlignedFloatArray& stream) { stream[destination] = stream[source]; });
+}
+
+inline void ParticleData::Gather(ParticleData& source, const uint32_t* order, size_t count) {
+    BeginGather(source, count);
+    GatherRange(source, order, 0, count);
+}
+
+inline void ParticleData::BeginGather(const ParticleData& source, size_t count) {
+    // Match exactly: a larger pool swapped into an emitter would outgrow its
+    // per-particle scratch after a SetCapacity shrink
+    if (Capacity() != source.Capacity()) {
+        SetCapacity(source.Capacity());
+    }
+    m_count = count;
+}
+
+inline void ParticleData::GatherRange(ParticleData& source, const uint32_t* order, size_t begin, size_t end) {
+    // Stream by stream keeps each pass to one source and one destination array
+    AlignedFloatArray* destinations[STREAM_COUNT];
+    AlignedFloatArray* sources[STREAM_COUNT];
+    GetStreams(destinations);
+    source.GetStreams(sources);
+    for (size_t stream = 0; stream < STREAM_COUNT; stream++) {
+        float* destination = destinations[stream]->data();
+        const float* from = sources[stream]->data();
+        for (size_t i = begin; i < end; i++) {
+            destination[i] = from[order[i]];
+        }
+    }
+}
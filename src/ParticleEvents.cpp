@@ -0,0 +1,55 @@
+#include "ParticleEvents.h"
+#include <algorithm>
+#include <cstring>
+
+ParticleEventQueue::ParticleEventQueue()
+    : m_mask(0), m_head(0), m_tail(0), m_cachedHead(0), m_overflowCount(0) {
+}
+
+void ParticleEventQueue::SetCapacity(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_events.assign(capacity == 0 ? 0 : size, ParticleEvent{});
+    m_mask = m_events.empty() ? 0 : m_events.size() - 1;
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_cachedHead = 0;
+}
+
+bool ParticleEventQueue::Push(const ParticleEvent& event) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cachedHead >= m_events.size()) {
+        // Looks full; refresh the consumer's position before giving up
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        if (tail - m_cachedHead >= m_events.size()) {
+            m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    m_events[tail & m_mask] = event;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+size_t ParticleEventQueue::PopBulk(ParticleEvent* events, size_t maxCount) {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    size_t count = std::min(tail - head, maxCount);
+    if (count == 0) return 0;
+
+    // At most two contiguous runs around the wrap
+    size_t first = head & m_mask;
+    size_t firstRun = std::min(count, m_events.size() - first);
+    std::memcpy(events, &m_events[first], firstRun * sizeof(ParticleEvent));
+    std::memcpy(events + firstRun, &m_events[0], (count - firstRun) * sizeof(ParticleEvent));
+
+    m_head.store(head + count, std::memory_order_release);
+    return count;
+}
+
+size_t ParticleEventQueue::Size() const {
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+}
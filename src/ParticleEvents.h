@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ParticleSystem;
+
+// What makes a particle fire its emitter's sub-emitters
+enum class SubEmitterTrigger {
+    Death,      // life ran out (or a kill-on-contact collision)
+    Collision   // any collider contact during the update
+};
+
+// Spawns particles in another emitter when particles of this one trigger
+struct SubEmitter {
+    SubEmitterTrigger trigger = SubEmitterTrigger::Death;
+    ParticleSystem* target = nullptr;
+    int count = 1;                 // particles spawned per event
+    float inheritVelocity = 0.0f;  // fraction of the parent's velocity added to the children
+};
+
+// Spawn request recorded during the update sweep (28 bytes)
+struct ParticleEvent {
+    float position[3];
+    float velocity[3];
+    uint32_t subEmitter;  // index into the source emitter's sub-emitters
+};
+
+// Bounded single-producer, single-consumer ring of events. The emitter's
+// update pushes while it runs on a worker; the queue is drained in bulk at
+// the start of the next step. Head and tail sit on separate cache lines and
+// the producer caches the consumer's head, so a push is a plain store plus
+// one release store. A push into a full queue is dropped and counted.
+class ParticleEventQueue {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    ParticleEventQueue();
+
+    // Rounded up to a power of two; discards queued events (not thread-safe)
+    void SetCapacity(size_t capacity);
+    size_t GetCapacity() const { return m_events.size(); }
+
+    // Producer side
+    bool Push(const ParticleEvent& event);
+    // Consumer side: move up to maxCount events into events, oldest first
+    size_t PopBulk(ParticleEvent* events, size_t maxCount);
+
+    size_t Size() const;
+    // Events dropped because the queue was full (lifetime total)
+    size_t GetOverflowCount() const { return m_overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<ParticleEvent> m_events;
+    size_t m_mask;
+
+    alignas(64) std::atomic<size_t> m_head;  // next event to pop, written by the consumer
+    alignas(64) std::atomic<size_t> m_tail;  // next free slot, written by the producer
+    size_t m_cachedHead;                     // producer's last view of m_head
+    std::atomic<size_t> m_overflowCount;
+};
@@ -0,0 +1,117 @@
+#include "ParticleFluid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+namespace {
+    const float PI = 3.14159265358979f;
+    // Lower bound on density, so isolated particles do not divide by zero
+    const float MIN_DENSITY = 1.0e-3f;
+}
+
+SphFluidSolver::SphFluidSolver()
+    : m_threadPool(&ThreadPool::GetShared()), m_reorderParticles(true), m_gridTime(0.0f), m_solveTime(0.0f) {
+}
+
+void SphFluidSolver::SetThreadPool(ThreadPool* threadPool) {
+    m_threadPool = threadPool;
+    m_grid.SetThreadPool(threadPool);
+}
+
+void SphFluidSolver::Step(ParticleData& particles, float deltaTime) {
+    const size_t count = particles.Count();
+    if (count == 0) return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    const float h = m_settings.smoothingRadius;
+    m_grid.Build(particles, h);
+    if (m_reorderParticles) {
+        // Each worker copies one slice of the sorted order across all streams
+        m_reordered.BeginGather(particles, count);
+        Run(count, [this, &particles](size_t begin, size_t end) {
+            m_reordered.GatherRange(particles, m_grid.GetSortedIndices().data(), begin, end);
+        });
+        std::swap(particles, m_reordered);
+        m_grid.SetIdentityOrder();
+    }
+
+    auto gridEnd = std::chrono::high_resolution_clock::now();
+
+    m_density.resize(count);
+    m_pressure.resize(count);
+    m_accelerationX.resize(count);
+    m_accelerationY.resize(count);
+    m_accelerationZ.resize(count);
+
+    const float h2 = h * h;
+    const float mass = m_settings.particleMass;
+    const float poly6 = 315.0f / (64.0f * PI * std::pow(h, 9.0f));
+    const float spikyGradient = 45.0f / (PI * std::pow(h, 6.0f));
+    const float viscosityLaplacian = 45.0f / (PI * std::pow(h, 6.0f));
+    const ParticleData& p = particles;
+
+    // Density and pressure
+    Run(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            float sum = 0.0f;
+            m_grid.ForEachNeighbor(glm::vec3(p.px[i], p.py[i], p.pz[i]),
+                [&sum, h2](uint32_t, const glm::vec3&, float distanceSquared) {
+                    float d = h2 - distanceSquared;
+                    sum += d * d * d;
+                });
+            m_density[i] = std::max(mass * poly6 * sum, MIN_DENSITY);
+            m_pressure[i] = m_settings.stiffness * (m_density[i] - m_settings.restDensity);
+        }
+    });
+
+    // Pressure and viscosity acceleration
+    Run(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            glm::vec3 acceleration(0.0f);
+            glm::vec3 velocity(p.vx[i], p.vy[i], p.vz[i]);
+            m_grid.ForEachNeighbor(glm::vec3(p.px[i], p.py[i], p.pz[i]),
+                [&](uint32_t j, const glm::vec3& offset, float distanceSquared) {
+                    // Coincident particles have no direction to push along
+                    if (j == i || distanceSquared <= 0.0f) return;
+                    float distance = std::sqrt(distanceSquared);
+                    float falloff = h - distance;
+
+                    // Symmetric pressure pushes i away from j (offset points at j)
+                    float pressure = -mass * (m_pressure[i] + m_pressure[j]) / (2.0f * m_density[j])
+                                   * spikyGradient * falloff * falloff / distance;
+                    acceleration += offset * pressure;
+
+                    float viscosity = m_settings.viscosity * mass / m_density[j] * viscosityLaplacian * falloff;
+                    acceleration += (glm::vec3(p.vx[j], p.vy[j], p.vz[j]) - velocity) * viscosity;
+                });
+            float inverseDensity = 1.0f / m_density[i];
+            m_accelerationX[i] = acceleration.x * inverseDensity;
+            m_accelerationY[i] = acceleration.y * inverseDensity;
+            m_accelerationZ[i] = acceleration.z * inverseDensity;
+        }
+    });
+
+    // Velocities change only after every particle has read its neighbors'
+    Run(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            particles.vx[i] += m_accelerationX[i] * deltaTime;
+            particles.vy[i] += m_accelerationY[i] * deltaTime;
+            particles.vz[i] += m_accelerationZ[i] * deltaTime;
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_gridTime = std::chrono::duration_cast<std::chrono::microseconds>(gridEnd - start).count() / 1000.0f;
+    m_solveTime = std::chrono::duration_cast<std::chrono::microseconds>(end - gridEnd).count() / 1000.0f;
+}
+
+void SphFluidSolver::Run(size_t count, const std::function<void(size_t, size_t)>& task) {
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(count, GRAIN_SIZE, task);
+    } else {
+        task(0, count);
+    }
+}
@@ -0,0 +1,568 @@
+#include "ParticleForces.h"
+#include "ParticleData.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_USE_SSE 1
+#endif
+
+namespace {
+    // Lattice hashing for value noise
+    const uint32_t PRIME_X = 73856093u;
+    const uint32_t PRIME_Y = 19349663u;
+    const uint32_t PRIME_Z = 83492791u;
+    const uint32_t HASH_MULTIPLIER = 0x5bd1e995u;
+    // One noise field per component of the curl potential
+    const uint32_t POTENTIAL_SEEDS[3] = { 0x68bc21ebu, 0x02e5be93u, 0x967a889bu };
+
+    // Keeps directions finite at the attractor or vortex axis
+    const float EPSILON = 1.0e-4f;
+    // Lattice values span 2 and the quintic fade's slope peaks at 1.875, so
+    // each gradient component is within 3.75 and each curl component within
+    // 7.5; the curl's length is at most 7.5 * sqrt(3)
+    const float MAX_CURL = 12.991f;
+
+    // Hash to [-1, 1)
+    inline float LatticeValue(uint32_t h) {
+        h ^= h >> 13;
+        h *= HASH_MULTIPLIER;
+        h ^= h >> 15;
+        return (float)(int)(h & 0xFFFFFFu) * (1.0f / 8388608.0f) - 1.0f;
+    }
+
+    // Analytic gradient of quintic-interpolated value noise
+    void NoiseGradient(float x, float y, float z, uint32_t seed, float& gx, float& gy, float& gz) {
+        float flx = std::floor(x), fly = std::floor(y), flz = std::floor(z);
+        float fx = x - flx, fy = y - fly, fz = z - flz;
+
+        uint32_t hx0 = (uint32_t)(int)flx * PRIME_X, hx1 = hx0 + PRIME_X;
+        uint32_t hy0 = (uint32_t)(int)fly * PRIME_Y, hy1 = hy0 + PRIME_Y;
+        uint32_t hz0 = ((uint32_t)(int)flz * PRIME_Z) ^ seed, hz1 = (((uint32_t)(int)flz * PRIME_Z) + PRIME_Z) ^ seed;
+
+        float a = LatticeValue(hx0 ^ hy0 ^ hz0), b = LatticeValue(hx1 ^ hy0 ^ hz0);
+        float c = LatticeValue(hx0 ^ hy1 ^ hz0), d = LatticeValue(hx1 ^ hy1 ^ hz0);
+        float e = LatticeValue(hx0 ^ hy0 ^ hz1), f = LatticeValue(hx1 ^ hy0 ^ hz1);
+        float g = LatticeValue(hx0 ^ hy1 ^ hz1), h = LatticeValue(hx1 ^ hy1 ^ hz1);
+
+        float k1 = b - a, k2 = c - a, k3 = e - a;
+        float k4 = (d - b) - k2, k5 = (g - c) - k3, k6 = (f - b) - k3;
+        float k7 = ((h - g) - (f - e)) - ((d - c) - k1);
+
+        float sx = fx * fx * fx * (fx * (fx * 6.0f - 15.0f) + 10.0f);
+        float sy = fy * fy * fy * (fy * (fy * 6.0f - 15.0f) + 10.0f);
+        float sz = fz * fz * fz * (fz * (fz * 6.0f - 15.0f) + 10.0f);
+        float dsx = 30.0f * fx * fx * (fx * (fx - 2.0f) + 1.0f);
+        float dsy = 30.0f * fy * fy * (fy * (fy - 2.0f) + 1.0f);
+        float dsz = 30.0f * fz * fz * (fz * (fz - 2.0f) + 1.0f);
+
+        gx = dsx * (((k1 + k4 * sy) + k6 * sz) + k7 * sy * sz);
+        gy = dsy * (((k2 + k4 * sx) + k5 * sz) + k7 * sx * sz);
+        gz = dsz * (((k3 + k5 * sy) + k6 * sx) + k7 * sx * sy);
+    }
+
+    void CurlScalar(float x, float y, float z, uint32_t seed, float& cx, float& cy, float& cz) {
+        float g1x, g1y, g1z, g2x, g2y, g2z, g3x, g3y, g3z;
+        NoiseGradient(x, y, z, POTENTIAL_SEEDS[0] ^ seed, g1x, g1y, g1z);
+        NoiseGradient(x, y, z, POTENTIAL_SEEDS[1] ^ seed, g2x, g2y, g2z);
+        NoiseGradient(x, y, z, POTENTIAL_SEEDS[2] ^ seed, g3x, g3y, g3z);
+        cx = g3y - g2z;
+        cy = g1z - g3x;
+        cz = g2x - g1y;
+    }
+
+#ifdef PARTICLE_USE_SSE
+    // 32-bit lane multiply without SSE4.1's _mm_mullo_epi32
+    inline __m128i MulLo32(__m128i a, __m128i b) {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    // floor() as float and int; truncation rounds negative fractions up, so step those down
+    inline __m128 Floor(__m128 x, __m128i& integer) {
+        __m128i truncated = _mm_cvttps_epi32(x);
+        __m128 truncatedFloat = _mm_cvtepi32_ps(truncated);
+        __m128 roundedUp = _mm_cmpgt_ps(truncatedFloat, x);
+        integer = _mm_add_epi32(truncated, _mm_castps_si128(roundedUp));
+        return _mm_sub_ps(truncatedFloat, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+    }
+
+    inline __m128 LatticeValueSSE(__m128i h) {
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 13));
+        h = MulLo32(h, _mm_set1_epi32((int)HASH_MULTIPLIER));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+        __m128 value = _mm_cvtepi32_ps(_mm_and_si128(h, _mm_set1_epi32(0xFFFFFF)));
+        return _mm_sub_ps(_mm_mul_ps(value, _mm_set1_ps(1.0f / 8388608.0f)), _mm_set1_ps(1.0f));
+    }
+
+    inline __m128 Fade(__m128 f) {
+        __m128 inner = _mm_add_ps(_mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(f, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(f, f), f), inner);
+    }
+
+    inline __m128 FadeDerivative(__m128 f) {
+        __m128 inner = _mm_add_ps(_mm_mul_ps(f, _mm_sub_ps(f, _mm_set1_ps(2.0f))), _mm_set1_ps(1.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(30.0f), f), f), inner);
+    }
+
+    // Same operations as NoiseGradient, four points at a time
+    void NoiseGradientSSE(__m128 x, __m128 y, __m128 z, uint32_t seed, __m128& gx, __m128& gy, __m128& gz) {
+        __m128i ix, iy, iz;
+        __m128 fx = _mm_sub_ps(x, Floor(x, ix));
+        __m128 fy = _mm_sub_ps(y, Floor(y, iy));
+        __m128 fz = _mm_sub_ps(z, Floor(z, iz));
+
+        const __m128i seedLanes = _mm_set1_epi32((int)seed);
+        __m128i hx0 = MulLo32(ix, _mm_set1_epi32((int)PRIME_X));
+        __m128i hx1 = _mm_add_epi32(hx0, _mm_set1_epi32((int)PRIME_X));
+        __m128i hy0 = MulLo32(iy, _mm_set1_epi32((int)PRIME_Y));
+        __m128i hy1 = _mm_add_epi32(hy0, _mm_set1_epi32((int)PRIME_Y));
+        __m128i hz = MulLo32(iz, _mm_set1_epi32((int)PRIME_Z));
+        __m128i hz0 = _mm_xor_si128(hz, seedLanes);
+        __m128i hz1 = _mm_xor_si128(_mm_add_epi32(hz, _mm_set1_epi32((int)PRIME_Z)), seedLanes);
+
+        __m128i h00 = _mm_xor_si128(hx0, hy0), h10 = _mm_xor_si128(hx1, hy0);
+        __m128i h01 = _mm_xor_si128(hx0, hy1), h11 = _mm_xor_si128(hx1, hy1);
+        __m128 a = LatticeValueSSE(_mm_xor_si128(h00, hz0)), b = LatticeValueSSE(_mm_xor_si128(h10, hz0));
+        __m128 c = LatticeValueSSE(_mm_xor_si128(h01, hz0)), d = LatticeValueSSE(_mm_xor_si128(h11, hz0));
+        __m128 e = LatticeValueSSE(_mm_xor_si128(h00, hz1)), f = LatticeValueSSE(_mm_xor_si128(h10, hz1));
+        __m128 g = LatticeValueSSE(_mm_xor_si128(h01, hz1)), h = LatticeValueSSE(_mm_xor_si128(h11, hz1));
+
+        __m128 k1 = _mm_sub_ps(b, a), k2 = _mm_sub_ps(c, a), k3 = _mm_sub_ps(e, a);
+        __m128 k4 = _mm_sub_ps(_mm_sub_ps(d, b), k2);
+        __m128 k5 = _mm_sub_ps(_mm_sub_ps(g, c), k3);
+        __m128 k6 = _mm_sub_ps(_mm_sub_ps(f, b), k3);
+        __m128 k7 = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(h, g), _mm_sub_ps(f, e)), _mm_sub_ps(_mm_sub_ps(d, c), k1));
+
+        __m128 sx = Fade(fx), sy = Fade(fy), sz = Fade(fz);
+        gx = _mm_mul_ps(FadeDerivative(fx), _mm_add_ps(_mm_add_ps(_mm_add_ps(k1, _mm_mul_ps(k4, sy)), _mm_mul_ps(k6, sz)),
+                                                       _mm_mul_ps(_mm_mul_ps(k7, sy), sz)));
+        gy = _mm_mul_ps(FadeDerivative(fy), _mm_add_ps(_mm_add_ps(_mm_add_ps(k2, _mm_mul_ps(k4, sx)), _mm_mul_ps(k5, sz)),
+                                                       _mm_mul_ps(_mm_mul_ps(k7, sx), sz)));
+        gz = _mm_mul_ps(FadeDerivative(fz), _mm_add_ps(_mm_add_ps(_mm_add_ps(k3, _mm_mul_ps(k5, sy)), _mm_mul_ps(k6, sx)),
+                                                       _mm_mul_ps(_mm_mul_ps(k7, sx), sy)));
+    }
+
+    // max(0, 1 - distance / radius)
+    inline __m128 LinearFalloff(__m128 distance, __m128 inverseRadius) {
+        return _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(distance, inverseRadius)), _mm_setzero_ps());
+    }
+
+    inline __m128 Length(__m128 x, __m128 y, __m128 z) {
+        return _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+    }
+
+    inline __m128 Lerp(__m128 a, __m128 b, __m128 t) {
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+    }
+#endif
+
+    inline float LinearFalloff(float distance, float inverseRadius) {
+        return std::max(1.0f - distance * inverseRadius, 0.0f);
+    }
+
+    inline float Length(float x, float y, float z) {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+
+    inline float Lerp(float a, float b, float t) {
+        return a + (b - a) * t;
+    }
+}
+
+// CurlNoiseForce
+
+CurlNoiseForce::CurlNoiseForce(float strength, float frequency)
+    : m_strength(strength), m_frequency(frequency), m_scrollVelocity(0.0f), m_seed(0) {
+}
+
+void CurlNoiseForce::Apply(ParticleData& p, size_t begin, size_t end, float deltaTime, float time) const {
+    // The field drifts with the scroll velocity: sample at (p - scroll * time) * frequency
+    const glm::vec3 offset = m_scrollVelocity * time;
+    const float scale = m_strength * deltaTime;
+
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const __m128 frequency = _mm_set1_ps(m_frequency);
+    const __m128 offsetX = _mm_set1_ps(offset.x), offsetY = _mm_set1_ps(offset.y), offsetZ = _mm_set1_ps(offset.z);
+    const __m128 scaleLanes = _mm_set1_ps(scale);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.px[i]), offsetX), frequency);
+        __m128 y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.py[i]), offsetY), frequency);
+        __m128 z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.pz[i]), offsetZ), frequency);
+
+        __m128 g1x, g1y, g1z, g2x, g2y, g2z, g3x, g3y, g3z;
+        NoiseGradientSSE(x, y, z, POTENTIAL_SEEDS[0] ^ m_seed, g1x, g1y, g1z);
+        NoiseGradientSSE(x, y, z, POTENTIAL_SEEDS[1] ^ m_seed, g2x, g2y, g2z);
+        NoiseGradientSSE(x, y, z, POTENTIAL_SEEDS[2] ^ m_seed, g3x, g3y, g3z);
+
+        _mm_storeu_ps(&p.vx[i], _mm_add_ps(_mm_loadu_ps(&p.vx[i]), _mm_mul_ps(_mm_sub_ps(g3y, g2z), scaleLanes)));
+        _mm_storeu_ps(&p.vy[i], _mm_add_ps(_mm_loadu_ps(&p.vy[i]), _mm_mul_ps(_mm_sub_ps(g1z, g3x), scaleLanes)));
+        _mm_storeu_ps(&p.vz[i], _mm_add_ps(_mm_loadu_ps(&p.vz[i]), _mm_mul_ps(_mm_sub_ps(g2x, g1y), scaleLanes)));
+    }
+#endif
+
+    for (; i < end; i++) {
+        float cx, cy, cz;
+        CurlScalar((p.px[i] - offset.x) * m_frequency, (p.py[i] - offset.y) * m_frequency,
+                   (p.pz[i] - offset.z) * m_frequency, m_seed, cx, cy, cz);
+        p.vx[i] += cx * scale;
+        p.vy[i] += cy * scale;
+        p.vz[i] += cz * scale;
+    }
+}
+
+float CurlNoiseForce::GetMaxAcceleration() const {
+    return std::abs(m_strength) * MAX_CURL;
+}
+
+glm::vec3 CurlNoiseForce::Sample(const glm::vec3& position, float time) const {
+    glm::vec3 point = (position - m_scrollVelocity * time) * m_frequency;
+    glm::vec3 curl;
+    CurlScalar(point.x, point.y, point.z, m_seed, curl.x, curl.y, curl.z);
+    return curl;
+}
+
+// AttractorForce
+
+AttractorForce::AttractorForce(const glm::vec3& position, float strength, float radius)
+    : m_position(position), m_strength(strength), m_radius(radius) {
+}
+
+void AttractorForce::Apply(ParticleData& p, size_t begin, size_t end, float deltaTime, float) const {
+    const float strength = m_strength * deltaTime;
+    const float inverseRadius = 1.0f / m_radius;
+
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const __m128 centerX = _mm_set1_ps(m_position.x), centerY = _mm_set1_ps(m_position.y), centerZ = _mm_set1_ps(m_position.z);
+    const __m128 strengthLanes = _mm_set1_ps(strength);
+    const __m128 inverseRadiusLanes = _mm_set1_ps(inverseRadius);
+    const __m128 epsilon = _mm_set1_ps(EPSILON);
+    for (; i + 4 <= end; i += 4) {
+        __m128 dx = _mm_sub_ps(centerX, _mm_loadu_ps(&p.px[i]));
+        __m128 dy = _mm_sub_ps(centerY, _mm_loadu_ps(&p.py[i]));
+        __m128 dz = _mm_sub_ps(centerZ, _mm_loadu_ps(&p.pz[i]));
+        __m128 distance = Length(dx, dy, dz);
+        __m128 scale = _mm_div_ps(_mm_mul_ps(strengthLanes, LinearFalloff(distance, inverseRadiusLanes)),
+                                  _mm_add_ps(distance, epsilon));
+        _mm_storeu_ps(&p.vx[i], _mm_add_ps(_mm_loadu_ps(&p.vx[i]), _mm_mul_ps(dx, scale)));
+        _mm_storeu_ps(&p.vy[i], _mm_add_ps(_mm_loadu_ps(&p.vy[i]), _mm_mul_ps(dy, scale)));
+        _mm_storeu_ps(&p.vz[i], _mm_add_ps(_mm_loadu_ps(&p.vz[i]), _mm_mul_ps(dz, scale)));
+    }
+#endif
+
+    for (; i < end; i++) {
+        float dx = m_position.x - p.px[i];
+        float dy = m_position.y - p.py[i];
+        float dz = m_position.z - p.pz[i];
+        float distance = Length(dx, dy, dz);
+        float scale = (strength * LinearFalloff(distance, inverseRadius)) / (distance + EPSILON);
+        p.vx[i] += dx * scale;
+        p.vy[i] += dy * scale;
+        p.vz[i] += dz * scale;
+    }
+}
+
+float AttractorForce::GetMaxAcceleration() const {
+    // The direction is normalised and the falloff is at most one
+    return std::abs(m_strength);
+}
+
+// VortexForce
+
+VortexForce::VortexForce(const glm::vec3& position, const glm::vec3& axis, float strength, float radius)
+    : m_position(position), m_axis(0.0f, 1.0f, 0.0f), m_strength(strength), m_radius(radius), m_pull(0.0f) {
+    SetAxis(axis);
+}
+
+void VortexForce::SetAxis(const glm::vec3& axis) {
+    float length = Length(axis.x, axis.y, axis.z);
+    if (length > 0.0f) {
+        m_axis = axis / length;
+    }
+}
+
+void VortexForce::Apply(ParticleData& p, size_t begin, size_t end, float deltaTime, float) const {
+    const float swirl = m_strength * deltaTime;
+    const float pull = m_pull * deltaTime;
+    const float inverseRadius = 1.0f / m_radius;
+    const glm::vec3& a = m_axis;
+
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const __m128 centerX = _mm_set1_ps(m_position.x), centerY = _mm_set1_ps(m_position.y), centerZ = _mm_set1_ps(m_position.z);
+    const __m128 axisX = _mm_set1_ps(a.x), axisY = _mm_set1_ps(a.y), axisZ = _mm_set1_ps(a.z);
+    const __m128 swirlLanes = _mm_set1_ps(swirl);
+    const __m128 pullLanes = _mm_set1_ps(pull);
+    const __m128 inverseRadiusLanes = _mm_set1_ps(inverseRadius);
+    const __m128 epsilon = _mm_set1_ps(EPSILON);
+    for (; i + 4 <= end; i += 4) {
+        __m128 rx = _mm_sub_ps(_mm_loadu_ps(&p.px[i]), centerX);
+        __m128 ry = _mm_sub_ps(_mm_loadu_ps(&p.py[i]), centerY);
+        __m128 rz = _mm_sub_ps(_mm_loadu_ps(&p.pz[i]), centerZ);
+
+        // Offset from the axis
+        __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, axisX), _mm_mul_ps(ry, axisY)), _mm_mul_ps(rz, axisZ));
+        __m128 qx = _mm_sub_ps(rx, _mm_mul_ps(axisX, along));
+        __m128 qy = _mm_sub_ps(ry, _mm_mul_ps(axisY, along));
+        __m128 qz = _mm_sub_ps(rz, _mm_mul_ps(axisZ, along));
+        __m128 distance = Length(qx, qy, qz);
+        __m128 scale = _mm_div_ps(LinearFalloff(distance, inverseRadiusLanes), _mm_add_ps(distance, epsilon));
+
+        // Tangent = axis x offset
+        __m128 tx = _mm_sub_ps(_mm_mul_ps(axisY, qz), _mm_mul_ps(axisZ, qy));
+        __m128 ty = _mm_sub_ps(_mm_mul_ps(axisZ, qx), _mm_mul_ps(axisX, qz));
+        __m128 tz = _mm_sub_ps(_mm_mul_ps(axisX, qy), _mm_mul_ps(axisY, qx));
+
+        __m128 ax = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(tx, swirlLanes), _mm_mul_ps(qx, pullLanes)), scale);
+        __m128 ay = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ty, swirlLanes), _mm_mul_ps(qy, pullLanes)), scale);
+        __m128 az = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(tz, swirlLanes), _mm_mul_ps(qz, pullLanes)), scale);
+        _mm_storeu_ps(&p.vx[i], _mm_add_ps(_mm_loadu_ps(&p.vx[i]), ax));
+        _mm_storeu_ps(&p.vy[i], _mm_add_ps(_mm_loadu_ps(&p.vy[i]), ay));
+        _mm_storeu_ps(&p.vz[i], _mm_add_ps(_mm_loadu_ps(&p.vz[i]), az));
+    }
+#endif
+
+    for (; i < end; i++) {
+        float rx = p.px[i] - m_position.x;
+        float ry = p.py[i] - m_position.y;
+        float rz = p.pz[i] - m_position.z;
+
+        float along = rx * a.x + ry * a.y + rz * a.z;
+        float qx = rx - a.x * along;
+        float qy = ry - a.y * along;
+        float qz = rz - a.z * along;
+        float distance = Length(qx, qy, qz);
+        float scale = LinearFalloff(distance, inverseRadius) / (distance + EPSILON);
+
+        float tx = a.y * qz - a.z * qy;
+        float ty = a.z * qx - a.x * qz;
+        float tz = a.x * qy - a.y * qx;
+
+        p.vx[i] += (tx * swirl - qx * pull) * scale;
+        p.vy[i] += (ty * swirl - qy * pull) * scale;
+        p.vz[i] += (tz * swirl - qz * pull) * scale;
+    }
+}
+
+float VortexForce::GetMaxAcceleration() const {
+    // The tangent and the offset from the axis are perpendicular and equally long
+    return std::sqrt(m_strength * m_strength + m_pull * m_pull);
+}
+
+// DragForce
+
+DragForce::DragForce(float linear, float quadratic)
+    : m_linear(linear), m_quadratic(quadratic) {
+}
+
+void DragForce::Apply(ParticleData& p, size_t begin, size_t end, float deltaTime, float) const {
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const __m128 linear = _mm_set1_ps(m_linear);
+    const __m128 quadratic = _mm_set1_ps(m_quadratic);
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(&p.vx[i]);
+        __m128 vy = _mm_loadu_ps(&p.vy[i]);
+        __m128 vz = _mm_loadu_ps(&p.vz[i]);
+        __m128 drag = _mm_add_ps(linear, _mm_mul_ps(quadratic, Length(vx, vy, vz)));
+        // Clamped so a large step stops particles rather than reversing them
+        __m128 scale = _mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(drag, dt)), _mm_setzero_ps());
+        _mm_storeu_ps(&p.vx[i], _mm_mul_ps(vx, scale));
+        _mm_storeu_ps(&p.vy[i], _mm_mul_ps(vy, scale));
+        _mm_storeu_ps(&p.vz[i], _mm_mul_ps(vz, scale));
+    }
+#endif
+
+    for (; i < end; i++) {
+        float drag = m_linear + m_quadratic * Length(p.vx[i], p.vy[i], p.vz[i]);
+        float scale = std::max(1.0f - drag * deltaTime, 0.0f);
+        p.vx[i] *= scale;
+        p.vy[i] *= scale;
+        p.vz[i] *= scale;
+    }
+}
+
+// VectorFieldForce
+
+VectorFieldForce::VectorFieldForce()
+    : m_dimensions(0), m_boundsMin(0.0f), m_boundsMax(0.0f), m_offset(0.0f), m_strength(1.0f), m_maxMagnitude(0.0f) {
+}
+
+bool VectorFieldForce::LoadFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cout << "ERROR: Could not open vector field " << filePath << "!" << std::endl;
+        return false;
+    }
+
+    // Values are comma separated, possibly across lines
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+    std::replace(text.begin(), text.end(), ',', ' ');
+    std::istringstream values(text);
+
+    glm::ivec3 dimensions;
+    glm::vec3 boundsMin, boundsMax;
+    if (!(values >> dimensions.x >> dimensions.y >> dimensions.z
+                 >> boundsMin.x >> boundsMin.y >> boundsMin.z
+                 >> boundsMax.x >> boundsMax.y >> boundsMax.z)) {
+        std::cout << "ERROR: Vector field " << filePath << " has no valid header!" << std::endl;
+        return false;
+    }
+    if (dimensions.x < 2 || dimensions.y < 2 || dimensions.z < 2) {
+        std::cout << "ERROR: Vector field " << filePath << " needs at least 2 samples per axis!" << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> vectors((size_t)dimensions.x * dimensions.y * dimensions.z);
+    for (glm::vec3& vector : vectors) {
+        if (!(values >> vector.x >> vector.y >> vector.z)) {
+            std::cout << "ERROR: Vector field " << filePath << " is missing samples!" << std::endl;
+            return false;
+        }
+    }
+
+    return SetField(dimensions, boundsMin, boundsMax, vectors);
+}
+
+bool VectorFieldForce::SetField(const glm::ivec3& dimensions, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                                const std::vector<glm::vec3>& vectors) {
+    size_t count = (size_t)std::max(dimensions.x, 0) * std::max(dimensions.y, 0) * std::max(dimensions.z, 0);
+    if (dimensions.x < 2 || dimensions.y < 2 || dimensions.z < 2 || vectors.size() != count) {
+        std::cout << "ERROR: Vector field size does not match its dimensions!" << std::endl;
+        return false;
+    }
+    if (!(boundsMax.x > boundsMin.x && boundsMax.y > boundsMin.y && boundsMax.z > boundsMin.z)) {
+        std::cout << "ERROR: Vector field bounds are empty!" << std::endl;
+        return false;
+    }
+
+    m_dimensions = dimensions;
+    m_boundsMin = boundsMin;
+    m_boundsMax = boundsMax;
+    m_x.resize(count);
+    m_y.resize(count);
+    m_z.resize(count);
+    m_maxMagnitude = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        m_x[i] = vectors[i].x;
+        m_y[i] = vectors[i].y;
+        m_z[i] = vectors[i].z;
+        m_maxMagnitude = std::max(m_maxMagnitude, Length(vectors[i].x, vectors[i].y, vectors[i].z));
+    }
+    return true;
+}
+
+float VectorFieldForce::GetMaxAcceleration() const {
+    return std::abs(m_strength) * m_maxMagnitude;
+}
+
+void VectorFieldForce::Apply(ParticleData& p, size_t begin, size_t end, float deltaTime, float) const {
+    if (m_x.empty()) return;
+
+    const float strength = m_strength * deltaTime;
+    size_t i = begin;
+#ifdef PARTICLE_USE_SSE
+    const glm::vec3 origin = m_boundsMin + m_offset;
+    const glm::vec3 cellScale = (glm::vec3(m_dimensions) - glm::vec3(1.0f)) / (m_boundsMax - m_boundsMin);
+    const glm::vec3 lastCell = glm::vec3(m_dimensions) - glm::vec3(2.0f);
+    const __m128 originX = _mm_set1_ps(origin.x), originY = _mm_set1_ps(origin.y), originZ = _mm_set1_ps(origin.z);
+    const __m128 scaleX = _mm_set1_ps(cellScale.x), scaleY = _mm_set1_ps(cellScale.y), scaleZ = _mm_set1_ps(cellScale.z);
+    const __m128 maxX = _mm_set1_ps(lastCell.x + 1.0f), maxY = _mm_set1_ps(lastCell.y + 1.0f), maxZ = _mm_set1_ps(lastCell.z + 1.0f);
+    const __m128 lastX = _mm_set1_ps(lastCell.x), lastY = _mm_set1_ps(lastCell.y), lastZ = _mm_set1_ps(lastCell.z);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 strengthLanes = _mm_set1_ps(strength);
+    const size_t strideY = (size_t)m_dimensions.x;
+    const size_t strideZ = strideY * m_dimensions.y;
+
+    for (; i + 4 <= end; i += 4) {
+        // Grid coordinates, clamped to the field
+        __m128 ux = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.px[i]), originX), scaleX), zero), maxX);
+        __m128 uy = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.py[i]), originY), scaleY), zero), maxY);
+        __m128 uz = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&p.pz[i]), originZ), scaleZ), zero), maxZ);
+        __m128 cellX = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(ux)), lastX);
+        __m128 cellY = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(uy)), lastY);
+        __m128 cellZ = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(uz)), lastZ);
+        __m128 tx = _mm_sub_ps(ux, cellX), ty = _mm_sub_ps(uy, cellY), tz = _mm_sub_ps(uz, cellZ);
+
+        alignas(16) int ix[4], iy[4], iz[4];
+        _mm_store_si128((__m128i*)ix, _mm_cvttps_epi32(cellX));
+        _mm_store_si128((__m128i*)iy, _mm_cvttps_epi32(cellY));
+        _mm_store_si128((__m128i*)iz, _mm_cvttps_epi32(cellZ));
+        size_t base[4];
+        for (int lane = 0; lane < 4; lane++) {
+            base[lane] = (size_t)iz[lane] * strideZ + (size_t)iy[lane] * strideY + (size_t)ix[lane];
+        }
+
+        // Eight corners per component; SSE2 has no gather, so lanes load one by one
+        __m128 result[3];
+        const std::vector<float>* components[3] = { &m_x, &m_y, &m_z };
+        for (int component = 0; component < 3; component++) {
+            const float* grid = components[component]->data();
+            __m128 corner[8];
+            for (int c = 0; c < 8; c++) {
+                size_t offset = ((c & 1) ? 1 : 0) + ((c & 2) ? strideY : 0) + ((c & 4) ? strideZ : 0);
+                corner[c] = _mm_setr_ps(grid[base[0] + offset], grid[base[1] + offset],
+                                        grid[base[2] + offset], grid[base[3] + offset]);
+            }
+            __m128 y0 = Lerp(Lerp(corner[0], corner[1], tx), Lerp(corner[2], corner[3], tx), ty);
+            __m128 y1 = Lerp(Lerp(corner[4], corner[5], tx), Lerp(corner[6], corner[7], tx), ty);
+            result[component] = Lerp(y0, y1, tz);
+        }
+
+        _mm_storeu_ps(&p.vx[i], _mm_add_ps(_mm_loadu_ps(&p.vx[i]), _mm_mul_ps(result[0], strengthLanes)));
+        _mm_storeu_ps(&p.vy[i], _mm_add_ps(_mm_loadu_ps(&p.vy[i]), _mm_mul_ps(result[1], strengthLanes)));
+        _mm_storeu_ps(&p.vz[i], _mm_add_ps(_mm_loadu_ps(&p.vz[i]), _mm_mul_ps(result[2], strengthLanes)));
+    }
+#endif
+
+    for (; i < end; i++) {
+        glm::vec3 field = Sample(glm::vec3(p.px[i], p.py[i], p.pz[i]));
+        p.vx[i] += field.x * strength;
+        p.vy[i] += field.y * strength;
+        p.vz[i] += field.z * strength;
+    }
+}
+
+glm::vec3 VectorFieldForce::Sample(const glm::vec3& position) const {
+    if (m_x.empty()) return glm::vec3(0.0f);
+
+    const glm::vec3 origin = m_boundsMin + m_offset;
+    const glm::vec3 cellScale = (glm::vec3(m_dimensions) - glm::vec3(1.0f)) / (m_boundsMax - m_boundsMin);
+    const glm::vec3 lastCell = glm::vec3(m_dimensions) - glm::vec3(2.0f);
+
+    float u[3], t[3];
+    size_t cell[3];
+    for (int axis = 0; axis < 3; axis++) {
+        u[axis] = std::min(std::max((position[axis] - origin[axis]) * cellScale[axis], 0.0f), lastCell[axis] + 1.0f);
+        float cellFloat = std::min((float)(int)u[axis], lastCell[axis]);
+        t[axis] = u[axis] - cellFloat;
+        cell[axis] = (size_t)(int)cellFloat;
+    }
+
+    const size_t strideY = (size_t)m_dimensions.x;
+    const size_t strideZ = strideY * m_dimensions.y;
+    const size_t base = cell[2] * strideZ + cell[1] * strideY + cell[0];
+
+    glm::vec3 result;
+    const std::vector<float>* components[3] = { &m_x, &m_y, &m_z };
+    for (int component = 0; component < 3; component++) {
+        const float* grid = components[component]->data() + base;
+        float y0 = Lerp(Lerp(grid[0], grid[1], t[0]), Lerp(grid[strideY], grid[strideY + 1], t[0]), t[1]);
+        float y1 = Lerp(Lerp(grid[strideZ], grid[strideZ + 1], t[0]),
+                        Lerp(grid[strideZ + strideY], grid[strideZ + strideY + 1], t[0]), t[1]);
+        result[component] = Lerp(y0, y1, t[2]);
+    }
+    return result;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ParticleData;
+
+// A force module adds a velocity change to a range of particles. Modules
+// are stacked on an emitter with ParticleSystem::AddForce and run in order
+// before integration. Apply() is const so one module can be shared by
+// emitters that update in parallel. Every module processes four particles
+// per iteration with SSE; the scalar tail does the same float operations,
+// so results do not depend on where a particle falls in the range.
+class ParticleForce {
+public:
+    virtual ~ParticleForce() = default;
+
+    virtual const char* GetName() const = 0;
+    // time is the emitter's simulation clock, for animated forces
+    virtual void Apply(ParticleData& particles, size_t begin, size_t end, float deltaTime, float time) const = 0;
+    // Upper bound on the velocity change per second, for emitter bounds
+    virtual float GetMaxAcceleration() const = 0;
+};
+
+// Divergence-free turbulence: the curl of three value-noise potentials
+class CurlNoiseForce : public ParticleForce {
+public:
+    CurlNoiseForce(float strength = 1.0f, float frequency = 1.0f);
+
+    void SetStrength(float strength) { m_strength = strength; }
+    void SetFrequency(float frequency) { m_frequency = frequency; }
+    // World units per second the noise field drifts by
+    void SetScrollVelocity(const glm::vec3& velocity) { m_scrollVelocity = velocity; }
+    void SetSeed(uint32_t seed) { m_seed = seed; }
+
+    const char* GetName() const override { return "CurlNoise"; }
+    float GetMaxAcceleration() const override;
+    void Apply(ParticleData& particles, size_t begin, size_t end, float deltaTime, float time) const override;
+
+    // Curl at a point (scalar reference for tests and tools)
+    glm::vec3 Sample(const glm::vec3& position, float time) const;
+
+private:
+    float m_strength;
+    float m_frequency;
+    glm::vec3 m_scrollVelocity;
+    uint32_t m_seed;
+};
+
+// Pulls particles towards a point (negative strength repels), fading
+// linearly to zero at the radius
+class AttractorForce : public ParticleForce {
+public:
+    AttractorForce(const glm::vec3& position, float strength, float radius);
+
+    void SetPosition(const glm::vec3& position) { m_position = position; }
+    void SetStrength(float strength) { m_strength = strength; }
+    void SetRadius(float radius) { m_radius = radius; }
+
+    const char* GetName() const override { return "Attractor"; }
+    float GetMaxAcceleration() const override;
+    void Apply(ParticleData& particles, size_t begin, size_t end, float deltaTime, float time) const override;
+
+private:
+    glm::vec3 m_position;
+    float m_strength;
+    float m_radius;
+};
+
+// Swirls particles around an axis through a point, with an optional pull
+// towards the axis, fading linearly to zero at the radius
+class VortexForce : public ParticleForce {
+public:
+    VortexForce(const glm::vec3& position, const glm::vec3& axis, float strength, float radius);
+
+    void SetPosition(const glm::vec3& position) { m_position = position; }
+    void SetAxis(const glm::vec3& axis);
+    void SetStrength(float strength) { m_strength = strength; }
+    void SetRadius(float radius) { m_radius = radius; }
+    void SetPull(float pull) { m_pull = pull; }
+
+    const char* GetName() const override { return "Vortex"; }
+    float GetMaxAcceleration() const override;
+    void Apply(ParticleData& particles, size_t begin, size_t end, float deltaTime, float time) const override;
+
+private:
+    glm::vec3 m_position;
+    glm::vec3 m_axis;
+    float m_strength;
+    float m_radius;
+    float m_pull;
+};
+
+// Slows particles down: dv = -v * (linear + quadratic * |v|) * dt
+class DragForce : public ParticleForce {
+public:
+    DragForce(float linear, float quadratic = 0.0f);
+
+    void SetLinear(float linear) { m_linear = linear; }
+    void SetQuadratic(float quadratic) { m_quadratic = quadratic; }
+
+    const char* GetName() const override { return "Drag"; }
+    // Drag only slows particles down
+    float GetMaxAcceleration() const override { return 0.0f; }
+    void Apply(ParticleData& particles, size_t begin, size_t end, float deltaTime, float time) const override;
+
+private:
+    float m_linear;
+    float m_quadratic;
+};
+
+// Acceleration sampled trilinearly from a 3D grid of vectors spanning a
+// world-space box. Positions outside the box use the nearest edge value.
+class VectorFieldForce : public ParticleForce {
+public:
+    VectorFieldForce();
+
+    // Load a .fga file: "nx,ny,nz, minx,miny,minz, maxx,maxy,maxz," then
+    // nx*ny*nz vectors, x fastest (the format Houdini and Unreal export)
+    bool LoadFromFile(const std::string& filePath);
+    // Every axis needs at least two samples
+    bool SetField(const glm::ivec3& dimensions, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                  const std::vector<glm::vec3>& vectors);
+
+    void SetStrength(float strength) { m_strength = strength; }
+    // Move the field's box (the file's bounds are kept relative to it)
+    void SetOffset(const glm::vec3& offset) { m_offset = offset; }
+    const glm::ivec3& GetDimensions() const { return m_dimensions; }
+    bool IsLoaded() const { return !m_x.empty(); }
+
+    const char* GetName() const override { return "VectorField"; }
+    float GetMaxAcceleration() const override;
+    void Apply(ParticleData& particles, size_t begin, size_t end, float deltaTime, float time) const override;
+
+    // Field value at a point, without strength (scalar reference)
+    glm::vec3 Sample(const glm::vec3& position) const;
+
+private:
+    glm::ivec3 m_dimensions;
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+    glm::vec3 m_offset;
+    float m_strength;
+    // Components as separate grids, so the corner gathers stay in one array
+    std::vector<float> m_x, m_y, m_z;
+    // Longest vector in the grid; trilinear samples never exceed it
+    float m_maxMagnitude;
+};
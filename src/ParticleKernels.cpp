@@ -0,0 +1,168 @@
+#include "ParticleKernels.h"
+#include "ParticleData.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_USE_SSE 1
+#endif
+
+// AVX2 is compiled per function and only called after a CPUID check, so the
+// rest of the build keeps its baseline instruction set
+#if defined(PARTICLE_USE_SSE) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define PARTICLE_USE_AVX2 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define PARTICLE_TARGET_AVX2
+#else
+#define PARTICLE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+    // Alpha ramps down quadratically over the last 30% of a particle's life
+    const float FADE_START = 0.3f;
+
+#ifdef PARTICLE_USE_SSE
+    void UpdateParticlesSSE(ParticleData& p, size_t begin, size_t end, float deltaTime) {
+        const __m128 dt = _mm_set1_ps(deltaTime);
+        const __m128 fadeStart = _mm_set1_ps(FADE_START);
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            __m128 vx = _mm_add_ps(_mm_loadu_ps(&p.vx[i]), _mm_mul_ps(_mm_loadu_ps(&p.ax[i]), dt));
+            __m128 vy = _mm_add_ps(_mm_loadu_ps(&p.vy[i]), _mm_mul_ps(_mm_loadu_ps(&p.ay[i]), dt));
+            __m128 vz = _mm_add_ps(_mm_loadu_ps(&p.vz[i]), _mm_mul_ps(_mm_loadu_ps(&p.az[i]), dt));
+            _mm_storeu_ps(&p.vx[i], vx);
+            _mm_storeu_ps(&p.vy[i], vy);
+            _mm_storeu_ps(&p.vz[i], vz);
+
+            _mm_storeu_ps(&p.px[i], _mm_add_ps(_mm_loadu_ps(&p.px[i]), _mm_mul_ps(vx, dt)));
+            _mm_storeu_ps(&p.py[i], _mm_add_ps(_mm_loadu_ps(&p.py[i]), _mm_mul_ps(vy, dt)));
+            _mm_storeu_ps(&p.pz[i], _mm_add_ps(_mm_loadu_ps(&p.pz[i]), _mm_mul_ps(vz, dt)));
+
+            __m128 rotation = _mm_add_ps(_mm_loadu_ps(&p.rotation[i]), _mm_mul_ps(_mm_loadu_ps(&p.rotationSpeed[i]), dt));
+            _mm_storeu_ps(&p.rotation[i], rotation);
+
+            __m128 life = _mm_sub_ps(_mm_loadu_ps(&p.life[i]), dt);
+            _mm_storeu_ps(&p.life[i], life);
+
+            // alpha = ratio < FADE_START ? ratio * (ratio / FADE_START) : ratio
+            __m128 ratio = _mm_div_ps(life, _mm_loadu_ps(&p.maxLife[i]));
+            __m128 faded = _mm_mul_ps(ratio, _mm_div_ps(ratio, fadeStart));
+            __m128 fading = _mm_cmplt_ps(ratio, fadeStart);
+            _mm_storeu_ps(&p.a[i], _mm_or_ps(_mm_and_ps(fading, faded), _mm_andnot_ps(fading, ratio)));
+        }
+
+        UpdateParticlesScalar(p, i, end, deltaTime);
+    }
+#endif
+
+#ifdef PARTICLE_USE_AVX2
+    PARTICLE_TARGET_AVX2
+    void UpdateParticlesAVX2(ParticleData& p, size_t begin, size_t end, float deltaTime) {
+        const __m256 dt = _mm256_set1_ps(deltaTime);
+        const __m256 fadeStart = _mm256_set1_ps(FADE_START);
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 vx = _mm256_add_ps(_mm256_loadu_ps(&p.vx[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.ax[i]), dt));
+            __m256 vy = _mm256_add_ps(_mm256_loadu_ps(&p.vy[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.ay[i]), dt));
+            __m256 vz = _mm256_add_ps(_mm256_loadu_ps(&p.vz[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.az[i]), dt));
+            _mm256_storeu_ps(&p.vx[i], vx);
+            _mm256_storeu_ps(&p.vy[i], vy);
+            _mm256_storeu_ps(&p.vz[i], vz);
+
+            _mm256_storeu_ps(&p.px[i], _mm256_add_ps(_mm256_loadu_ps(&p.px[i]), _mm256_mul_ps(vx, dt)));
+            _mm256_storeu_ps(&p.py[i], _mm256_add_ps(_mm256_loadu_ps(&p.py[i]), _mm256_mul_ps(vy, dt)));
+            _mm256_storeu_ps(&p.pz[i], _mm256_add_ps(_mm256_loadu_ps(&p.pz[i]), _mm256_mul_ps(vz, dt)));
+
+            __m256 rotation = _mm256_add_ps(_mm256_loadu_ps(&p.rotation[i]),
+                                            _mm256_mul_ps(_mm256_loadu_ps(&p.rotationSpeed[i]), dt));
+            _mm256_storeu_ps(&p.rotation[i], rotation);
+
+            __m256 life = _mm256_sub_ps(_mm256_loadu_ps(&p.life[i]), dt);
+            _mm256_storeu_ps(&p.life[i], life);
+
+            __m256 ratio = _mm256_div_ps(life, _mm256_loadu_ps(&p.maxLife[i]));
+            __m256 faded = _mm256_mul_ps(ratio, _mm256_div_ps(ratio, fadeStart));
+            __m256 fading = _mm256_cmp_ps(ratio, fadeStart, _CMP_LT_OQ);
+            _mm256_storeu_ps(&p.a[i], _mm256_blendv_ps(ratio, faded, fading));
+        }
+
+        UpdateParticlesScalar(p, i, end, deltaTime);
+    }
+
+    bool CpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+}
+
+void UpdateParticlesScalar(ParticleData& p, size_t begin, size_t end, float deltaTime) {
+    for (size_t i = begin; i < end; i++) {
+        p.vx[i] += p.ax[i] * deltaTime;
+        p.vy[i] += p.ay[i] * deltaTime;
+        p.vz[i] += p.az[i] * deltaTime;
+
+        p.px[i] += p.vx[i] * deltaTime;
+        p.py[i] += p.vy[i] * deltaTime;
+        p.pz[i] += p.vz[i] * deltaTime;
+
+        p.rotation[i] += p.rotationSpeed[i] * deltaTime;
+        p.life[i] -= deltaTime;
+
+        float ratio = p.life[i] / p.maxLife[i];
+        p.a[i] = ratio < FADE_START ? ratio * (ratio / FADE_START) : ratio;
+    }
+}
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel level = [] {
+#ifdef PARTICLE_USE_AVX2
+        if (CpuSupportsAVX2()) return SimdLevel::AVX2;
+#endif
+#ifdef PARTICLE_USE_SSE
+        return SimdLevel::SSE;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }();
+    return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "Scalar";
+        case SimdLevel::SSE: return "SSE";
+        case SimdLevel::AVX2: return "AVX2";
+    }
+    return "Unknown";
+}
+
+ParticleUpdateKernel GetParticleUpdateKernel(SimdLevel level) {
+    if ((int)level > (int)DetectSimdLevel()) {
+        level = DetectSimdLevel();
+    }
+
+    switch (level) {
+#ifdef PARTICLE_USE_AVX2
+        case SimdLevel::AVX2: return UpdateParticlesAVX2;
+#endif
+#ifdef PARTICLE_USE_SSE
+        case SimdLevel::SSE: return UpdateParticlesSSE;
+#endif
+        default: return UpdateParticlesScalar;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+struct ParticleData;
+
+// SIMD update kernels for ParticleData. Each kernel integrates velocity and
+// position, advances rotation and life, and applies the end-of-life alpha
+// fade for particles [begin, end). All variants do the same float
+// operations in the same order, so their results are bit-identical.
+enum class SimdLevel {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+using ParticleUpdateKernel = void (*)(ParticleData& particles, size_t begin, size_t end, float deltaTime);
+
+// Best level supported by this CPU and build
+SimdLevel DetectSimdLevel();
+const char* GetSimdLevelName(SimdLevel level);
+
+// Kernel for a level; unsupported levels fall back to the best available one
+ParticleUpdateKernel GetParticleUpdateKernel(SimdLevel level);
+
+void UpdateParticlesScalar(ParticleData& particles, size_t begin, size_t end, float deltaTime);
@@ -0,0 +1,291 @@
+#include "ParticleManager.h"
+#include "AllocationTracker.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "ShaderManager.h"
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+ParticleManager::ParticleManager()
+    : m_seed(0x9e3779b9u), m_view(1.0f), m_projection(1.0f), m_hasCamera(false), m_frameIndex(0), m_VAO(0), m_VBO(0), m_quadVBO(0), m_streamBuffer(nullptr),
+      m_depthTest(false), m_drawCallCount(0), m_updateTime(0.0f) {
+}
+
+ParticleManager::~ParticleManager() {
+    Cleanup();
+}
+
+void ParticleManager::Initialize() {
+    std::cout << "Initializing Particle Manager..." << std::endl;
+
+    glGenBuffers(1, &m_VBO);
+    CreateParticleInstanceVAO(m_VAO, m_quadVBO);
+}
+
+void ParticleManager::Cleanup() {
+    if (m_VAO) {
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(1, &m_VBO);
+        glDeleteBuffers(1, &m_quadVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_VBO);
+        MemoryTracker::Get().ReleaseBuffer(m_quadVBO);
+    }
+    m_VAO = m_VBO = m_quadVBO = 0;
+}
+
+ParticleManager::EmitterId ParticleManager::CreateEmitter(ParticleBlendMode blendMode) {
+    EmitterId id = m_emitters.size();
+    if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    } else {
+        m_emitters.emplace_back();
+        m_stats.emplace_back();
+        m_pendingTime.emplace_back();
+    }
+
+    m_emitters[id] = std::make_unique<ParticleSystem>();
+    m_emitters[id]->SetSeed(GetEmitterSeed(m_seed, id));
+    m_emitters[id]->SetBlendMode(blendMode);
+    m_stats[id] = ParticleEmitterStats();
+    m_stats[id].blendMode = blendMode;
+    m_pendingTime[id] = 0.0f;
+    return id;
+}
+
+void ParticleManager::RemoveEmitter(EmitterId id) {
+    if (!IsValid(id)) return;
+
+    // Nothing may keep spawning into the emitter
+    for (const std::unique_ptr<ParticleSystem>& emitter : m_emitters) {
+        if (emitter) {
+            emitter->RemoveSubEmitters(m_emitters[id].get());
+        }
+    }
+    m_emitters[id].reset();
+    m_stats[id] = ParticleEmitterStats();
+    m_freeIds.push_back(id);
+}
+
+void ParticleManager::SetCamera(const glm::mat4& view, const glm::mat4& projection) {
+    m_view = view;
+    m_projection = projection;
+    m_hasCamera = true;
+}
+
+void ParticleManager::Update(float deltaTime) {
+    PROFILE_SCOPE("ParticleManager::Update");
+    ALLOCATION_TAG("Particles");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (m_hasCamera) {
+        ApplyBudget();
+    }
+    size_t frameIndex = m_frameIndex++;
+
+    // Sub-emitter events from the last step spawn serially, in emitter order,
+    // since any emitter can target any other. Each emitter's queue is then
+    // only touched by the worker updating it.
+    for (const std::unique_ptr<ParticleSystem>& emitter : m_emitters) {
+        if (emitter) {
+            emitter->DispatchEvents();
+        }
+    }
+
+    // Emitters share nothing else, so each one is an independent task. The
+    // step is captured by reference so the lambda fits std::function's
+    // inline storage and submitting the job does not allocate. Fluid
+    // emitters are skipped here: their solver splits its own passes across
+    // the pool, which a nested ParallelFor would run serially.
+    struct Step {
+        float deltaTime;
+        size_t frameIndex;
+    } step = { deltaTime, frameIndex };
+    ThreadPool::GetShared().ParallelFor(m_emitters.size(), 1, [this, &step](size_t begin, size_t end) {
+        for (size_t id = begin; id < end; id++) {
+            const ParticleSystem* emitter = m_emitters[id].get();
+            if (emitter && !emitter->GetFluidSolver()) {
+                UpdateEmitter(id, step.deltaTime, step.frameIndex);
+            }
+        }
+    });
+
+    // Fluid emitters one at a time, each with the whole pool
+    for (EmitterId id = 0; id < m_emitters.size(); id++) {
+        const ParticleSystem* emitter = m_emitters[id].get();
+        if (emitter && emitter->GetFluidSolver()) {
+            UpdateEmitter(id, deltaTime, frameIndex);
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_updateTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0f;
+}
+
+void ParticleManager::UpdateEmitter(EmitterId id, float deltaTime, size_t frameIndex) {
+    ParticleSystem* emitter = m_emitters[id].get();
+
+    // Frozen emitters only age, so their particles still expire and leave
+    // the budget; coarse ones catch up every few frames, staggered by id so
+    // they do not all land on the same frame
+    int interval = m_stats[id].updateInterval;
+    if (interval == 0) {
+        emitter->Age(deltaTime);
+        m_stats[id].particleCount = emitter->GetParticleCount();
+        return;
+    }
+    m_pendingTime[id] += deltaTime;
+    if ((frameIndex + id) % interval != 0) return;
+    float stepTime = m_pendingTime[id];
+    m_pendingTime[id] = 0.0f;
+
+    auto emitterStart = std::chrono::high_resolution_clock::now();
+    emitter->Update(stepTime);
+    auto emitterEnd = std::chrono::high_resolution_clock::now();
+
+    ParticleEmitterStats& stats = m_stats[id];
+    stats.particleCount = emitter->GetParticleCount();
+    stats.droppedCount = emitter->GetDroppedCount();
+    stats.reclaimedCount = emitter->GetReclaimedCount();
+    stats.eventOverflowCount = emitter->GetEventOverflowCount();
+    stats.blendMode = emitter->GetBlendMode();
+    stats.updateTime = std::chrono::duration_cast<std::chrono::microseconds>(emitterEnd - emitterStart).count() / 1000.0f;
+}
+
+void ParticleManager::Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_SCOPE("ParticleManager::Render");
+    ALLOCATION_TAG("Particles");
+    m_drawCallCount = 0;
+
+    // Order emitters by blend mode so each mode is one contiguous range
+    size_t groupEnd[BLEND_MODE_COUNT] = {};
+    m_drawOrder.clear();
+    m_instanceOffsets.clear();
+    size_t instanceCount = 0;
+    for (int mode = 0; mode < BLEND_MODE_COUNT; mode++) {
+        for (EmitterId id = 0; id < m_emitters.size(); id++) {
+            const ParticleSystem* emitter = m_emitters[id].get();
+            if (!emitter || (int)emitter->GetBlendMode() != mode || emitter->GetInstances().empty()) continue;
+            m_drawOrder.push_back(id);
+            m_instanceOffsets.push_back(instanceCount);
+            instanceCount += emitter->GetInstances().size();
+        }
+        groupEnd[mode] = instanceCount;
+    }
+    if (instanceCount == 0) return;
+
+    // One upload for every emitter
+    size_t dataSize = instanceCount * sizeof(ParticleInstance);
+    uint8_t* destination = nullptr;
+    GLuint buffer = m_VBO;
+    GLintptr baseOffset = 0;
+    StreamBuffer::Allocation allocation = {};
+    if (m_streamBuffer) {
+        allocation = m_streamBuffer->Allocate(dataSize, sizeof(float));
+        if (!allocation) return; // Segment full; the stream buffer grows next frame
+        destination = static_cast<uint8_t*>(allocation.data);
+        buffer = m_streamBuffer->GetBuffer();
+        baseOffset = allocation.offset;
+    } else {
+        m_staging.resize(dataSize);
+        destination = m_staging.data();
+    }
+
+    ThreadPool::GetShared().ParallelFor(m_drawOrder.size(), 16, [this, destination](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const std::vector<ParticleInstance>& instances = m_emitters[m_drawOrder[i]]->GetInstances();
+            std::memcpy(destination + m_instanceOffsets[i] * sizeof(ParticleInstance), instances.data(),
+                        instances.size() * sizeof(ParticleInstance));
+        }
+    });
+
+    if (m_streamBuffer) {
+        m_streamBuffer->Commit(allocation);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glBufferData(GL_ARRAY_BUFFER, dataSize, m_staging.data(), GL_DYNAMIC_DRAW);
+        MemoryTracker::Get().TrackBuffer(m_VBO, dataSize, MemoryCategory::Particles);
+    }
+
+    shader.setMat4Value("view", view);
+    shader.setMat4Value("projection", projection);
+
+    glEnable(GL_BLEND);
+    if (!m_depthTest) {
+        glDisable(GL_DEPTH_TEST);
+    }
+
+    // One instanced draw per blend mode
+    size_t groupStart = 0;
+    for (int mode = 0; mode < BLEND_MODE_COUNT; mode++) {
+        size_t count = groupEnd[mode] - groupStart;
+        if (count > 0) {
+            ApplyParticleBlendMode((ParticleBlendMode)mode);
+            BindParticleInstances(m_VAO, buffer, baseOffset + groupStart * sizeof(ParticleInstance));
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+            m_drawCallCount++;
+        }
+        groupStart = groupEnd[mode];
+    }
+    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    if (!m_depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+void ParticleManager::ApplyBudget() {
+    m_budgetRequests.clear();
+    for (const std::unique_ptr<ParticleSystem>& emitter : m_emitters) {
+        ParticleBudgetRequest request;
+        if (emitter) {
+            request.position = emitter->GetPosition();
+            request.radius = emitter->GetBoundingRadius();
+            request.demand = emitter->GetExpectedParticleCount();
+            request.liveCount = emitter->GetParticleCount();
+        }
+        m_budgetRequests.push_back(request);
+    }
+
+    m_budget.Allocate(m_view, m_projection, m_budgetRequests, m_budgetGrants);
+
+    for (EmitterId id = 0; id < m_emitters.size(); id++) {
+        if (!m_emitters[id]) continue;
+        const ParticleBudgetGrant& grant = m_budgetGrants[id];
+        ParticleSystem& emitter = *m_emitters[id];
+        emitter.SetEmissionScale(grant.emissionScale);
+        emitter.SetMaxLiveParticles(grant.maxLive);
+
+        ParticleEmitterStats& stats = m_stats[id];
+        stats.importance = grant.importance;
+        stats.visible = grant.visible;
+        stats.emissionScale = grant.emissionScale;
+        stats.maxLive = grant.maxLive;
+        stats.updateInterval = grant.updateInterval;
+    }
+}
+
+size_t ParticleManager::GetEmitterCount() const {
+    return m_emitters.size() - m_freeIds.size();
+}
+
+size_t ParticleManager::GetParticleCount() const {
+    size_t count = 0;
+    for (const std::unique_ptr<ParticleSystem>& emitter : m_emitters) {
+        if (emitter) count += emitter->GetParticleCount();
+    }
+    return count;
+}
+
+uint32_t ParticleManager::GetEmitterSeed(uint32_t seed, EmitterId id) {
+    // SplitMix-style mix so neighbouring ids get unrelated streams
+    uint64_t z = ((uint64_t)seed << 32) + id + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return (uint32_t)(z ^ (z >> 31));
+}
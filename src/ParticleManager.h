@@ -0,0 +1,116 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ParticleSystem.h"
+#include "ParticleBudget.h"
+
+class ShaderManager;
+class StreamBuffer;
+
+// Per-emitter statistics from the last Update()/Render()
+struct ParticleEmitterStats {
+    size_t particleCount = 0;
+    size_t droppedCount = 0;     // lifetime total
+    size_t reclaimedCount = 0;   // lifetime total
+    size_t eventOverflowCount = 0; // sub-emitter events dropped, lifetime total
+    float updateTime = 0.0f;     // ms, measured on the worker that ran it
+    ParticleBlendMode blendMode = ParticleBlendMode::Alpha;
+
+    // Budget decisions (defaults when no budget is set)
+    float importance = 1.0f;
+    bool visible = true;
+    float emissionScale = 1.0f;
+    size_t maxLive = SIZE_MAX;   // SIZE_MAX = uncapped
+    int updateInterval = 1;      // 0 = frozen
+};
+
+// Owns every emitter in a level and draws them together. Emitters are
+// CPU ParticleSystems without GL objects of their own; Update() runs them
+// in parallel on the shared thread pool, each with its own RNG seeded from
+// the manager seed and emitter id, so results do not depend on scheduling.
+// Fluid emitters run afterwards, one at a time, so their solver can spread
+// each pass across the pool.
+// Render() writes all live instances into one stream buffer allocation,
+// grouped by blend mode, and issues one instanced draw per blend mode.
+class ParticleManager {
+public:
+    using EmitterId = size_t;
+
+    ParticleManager();
+    ~ParticleManager();
+
+    // Initialization
+    void Initialize();
+    void Cleanup();
+
+    // Emitters (ids stay valid until removed; freed ids are reused)
+    EmitterId CreateEmitter(ParticleBlendMode blendMode = ParticleBlendMode::Alpha);
+    void RemoveEmitter(EmitterId id);
+    ParticleSystem& GetEmitter(EmitterId id) { return *m_emitters[id]; }
+    bool IsValid(EmitterId id) const { return id < m_emitters.size() && m_emitters[id] != nullptr; }
+
+    // Seed for emitters created afterwards
+    void SetSeed(uint32_t seed) { m_seed = seed; }
+
+    // Global particle budget (0 = unlimited). Needs the camera for scoring;
+    // emission rates and live caps are rebalanced at every Update().
+    void SetParticleBudget(size_t maxParticles) { m_budget.SetBudget(maxParticles); }
+    size_t GetParticleBudget() const { return m_budget.GetBudget(); }
+    ParticleBudget& GetBudget() { return m_budget; }
+    void SetCamera(const glm::mat4& view, const glm::mat4& projection);
+
+    // Simulation and rendering
+    void Update(float deltaTime);
+    void Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    // Rendering properties
+    void SetStreamBuffer(StreamBuffer* streamBuffer) { m_streamBuffer = streamBuffer; }
+    void SetDepthTest(bool enabled) { m_depthTest = enabled; }
+
+    // Statistics
+    size_t GetEmitterCount() const;
+    size_t GetParticleCount() const;
+    int GetDrawCallCount() const { return m_drawCallCount; }
+    float GetUpdateTime() const { return m_updateTime; }
+    const ParticleEmitterStats& GetEmitterStats(EmitterId id) const { return m_stats[id]; }
+
+private:
+    static constexpr int BLEND_MODE_COUNT = 2;
+
+    std::vector<std::unique_ptr<ParticleSystem>> m_emitters;
+    std::vector<ParticleEmitterStats> m_stats;
+    std::vector<EmitterId> m_freeIds;
+    uint32_t m_seed;
+
+    // Budget
+    ParticleBudget m_budget;
+    glm::mat4 m_view;
+    glm::mat4 m_projection;
+    bool m_hasCamera;
+    std::vector<float> m_pendingTime;           // time owed to coarsely stepped emitters
+    std::vector<ParticleBudgetRequest> m_budgetRequests;
+    std::vector<ParticleBudgetGrant> m_budgetGrants;
+    size_t m_frameIndex;
+
+    // Per-frame scratch, kept to avoid reallocating
+    std::vector<EmitterId> m_drawOrder;     // live emitters sorted by blend mode
+    std::vector<size_t> m_instanceOffsets;  // first instance of each entry in m_drawOrder
+    std::vector<uint8_t> m_staging;         // upload copy when there is no stream buffer
+
+    // Rendering
+    GLuint m_VAO, m_VBO, m_quadVBO;
+    StreamBuffer* m_streamBuffer;
+    bool m_depthTest;
+    int m_drawCallCount;
+    float m_updateTime;
+
+    // Helper methods
+    static uint32_t GetEmitterSeed(uint32_t seed, EmitterId id);
+    void ApplyBudget();
+    void UpdateEmitter(EmitterId id, float deltaTime, size_t frameIndex);
+};
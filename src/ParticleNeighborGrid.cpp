@@ -0,0 +1,147 @@
+#include "ParticleNeighborGrid.h"
+#include "ParticleData.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    const uint32_t PRIME_X = 73856093u;
+    const uint32_t PRIME_Y = 19349663u;
+    const uint32_t PRIME_Z = 83492791u;
+    const size_t MIN_TABLE_SIZE = 64;
+}
+
+ParticleNeighborGrid::ParticleNeighborGrid()
+    : m_threadPool(&ThreadPool::GetShared()), m_cellSize(1.0f), m_inverseCellSize(1.0f), m_tableMask(0),
+      m_countsCapacity(0) {
+}
+
+void ParticleNeighborGrid::Build(const ParticleData& particles, float cellSize) {
+    const size_t count = particles.Count();
+    m_cellSize = cellSize;
+    m_inverseCellSize = 1.0f / cellSize;
+
+    // At least two buckets per particle keeps unrelated cells from sharing buckets
+    size_t tableSize = MIN_TABLE_SIZE;
+    while (tableSize < count * 2) {
+        tableSize <<= 1;
+    }
+    m_tableMask = (uint32_t)(tableSize - 1);
+    if (m_countsCapacity < tableSize) {
+        m_counts.reset(new std::atomic<uint32_t>[tableSize]);
+        m_countsCapacity = tableSize;
+    }
+    m_keys.resize(count);
+    m_cellStart.resize(tableSize + 1);
+    m_sortedIndices.resize(count);
+    m_sortedX.resize(count);
+    m_sortedY.resize(count);
+    m_sortedZ.resize(count);
+
+    Run(tableSize, GRAIN_SIZE, [this](size_t begin, size_t end) {
+        for (size_t bucket = begin; bucket < end; bucket++) {
+            m_counts[bucket].store(0, std::memory_order_relaxed);
+        }
+    });
+
+    // Count particles per bucket
+    Run(count, GRAIN_SIZE, [this, &particles](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            glm::ivec3 cell = GetCell(particles.px[i], particles.py[i], particles.pz[i]);
+            uint32_t bucket = GetBucket(cell.x, cell.y, cell.z);
+            m_keys[i] = bucket;
+            m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    PrefixSum();
+
+    // Scatter; the counts run back down to zero as cursors
+    Run(count, GRAIN_SIZE, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint32_t bucket = m_keys[i];
+            uint32_t slot = m_cellStart[bucket] + m_counts[bucket].fetch_sub(1, std::memory_order_relaxed) - 1;
+            m_sortedIndices[slot] = (uint32_t)i;
+        }
+    });
+
+    // Scatter order depends on scheduling; sorting each (small) bucket removes that
+    Run(tableSize, GRAIN_SIZE, [this](size_t begin, size_t end) {
+        for (size_t bucket = begin; bucket < end; bucket++) {
+            uint32_t first = m_cellStart[bucket], last = m_cellStart[bucket + 1];
+            if (last - first > 1) {
+                std::sort(m_sortedIndices.begin() + first, m_sortedIndices.begin() + last);
+            }
+        }
+    });
+
+    Run(count, GRAIN_SIZE, [this, &particles](size_t begin, size_t end) {
+        for (size_t slot = begin; slot < end; slot++) {
+            uint32_t i = m_sortedIndices[slot];
+            m_sortedX[slot] = particles.px[i];
+            m_sortedY[slot] = particles.py[i];
+            m_sortedZ[slot] = particles.pz[i];
+        }
+    });
+}
+
+void ParticleNeighborGrid::SetIdentityOrder() {
+    std::iota(m_sortedIndices.begin(), m_sortedIndices.end(), 0u);
+}
+
+void ParticleNeighborGrid::Run(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task) {
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(count, grainSize, task);
+    } else if (count > 0) {
+        task(0, count);
+    }
+}
+
+void ParticleNeighborGrid::PrefixSum() {
+    // Block totals in parallel, a short serial scan over the blocks, then each
+    // block writes its exclusive prefix from its starting offset
+    const size_t tableSize = m_cellStart.size() - 1;
+    const size_t blockCount = (tableSize + GRAIN_SIZE - 1) / GRAIN_SIZE;
+    m_blockSums.resize(blockCount);
+
+    Run(blockCount, 1, [this, tableSize](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block++) {
+            size_t last = std::min((block + 1) * GRAIN_SIZE, tableSize);
+            uint32_t sum = 0;
+            for (size_t bucket = block * GRAIN_SIZE; bucket < last; bucket++) {
+                sum += m_counts[bucket].load(std::memory_order_relaxed);
+            }
+            m_blockSums[block] = sum;
+        }
+    });
+
+    uint32_t total = 0;
+    for (uint32_t& sum : m_blockSums) {
+        uint32_t blockTotal = sum;
+        sum = total;
+        total += blockTotal;
+    }
+    m_cellStart[tableSize] = total;
+
+    Run(blockCount, 1, [this, tableSize](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block++) {
+            size_t last = std::min((block + 1) * GRAIN_SIZE, tableSize);
+            uint32_t offset = m_blockSums[block];
+            for (size_t bucket = block * GRAIN_SIZE; bucket < last; bucket++) {
+                m_cellStart[bucket] = offset;
+                offset += m_counts[bucket].load(std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+glm::ivec3 ParticleNeighborGrid::GetCell(float x, float y, float z) const {
+    return glm::ivec3((int)std::floor(x * m_inverseCellSize),
+                      (int)std::floor(y * m_inverseCellSize),
+                      (int)std::floor(z * m_inverseCellSize));
+}
+
+uint32_t ParticleNeighborGrid::GetBucket(int x, int y, int z) const {
+    return (((uint32_t)x * PRIME_X) ^ ((uint32_t)y * PRIME_Y) ^ ((uint32_t)z * PRIME_Z)) & m_tableMask;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct ParticleData;
+class ThreadPool;
+
+// Uniform grid for fixed-radius neighbor queries, rebuilt from scratch each
+// step. Cells are hashed into a table of at least twice the particle count
+// and filled with a parallel counting sort: count per bucket, prefix sum,
+// scatter, then a per-bucket sort so the order (and every sum a solver does
+// over neighbors) is the same regardless of scheduling. Positions are copied
+// in bucket order, so a query walks contiguous memory.
+class ParticleNeighborGrid {
+public:
+    // Particles per task in the parallel passes
+    static constexpr size_t GRAIN_SIZE = 4096;
+
+    ParticleNeighborGrid();
+
+    // Pool for the build passes (default: the shared pool; nullptr runs serially)
+    void SetThreadPool(ThreadPool* threadPool) { m_threadPool = threadPool; }
+
+    // Bin particles [0, Count()) into cells of the query radius
+    void Build(const ParticleData& particles, float cellSize);
+
+    // Call function(index, offset, distanceSquared) for every particle within
+    // the cell size of position, including a particle at position itself.
+    // offset is the neighbor's position minus position.
+    template <typename Function>
+    void ForEachNeighbor(const glm::vec3& position, Function function) const;
+
+    // Particle indices in bucket order (neighbors end up close together)
+    const std::vector<uint32_t>& GetSortedIndices() const { return m_sortedIndices; }
+    // The particles were reordered to match GetSortedIndices(); index i is now slot i
+    void SetIdentityOrder();
+
+    size_t GetParticleCount() const { return m_sortedIndices.size(); }
+    size_t GetTableSize() const { return m_cellStart.empty() ? 0 : m_cellStart.size() - 1; }
+    float GetCellSize() const { return m_cellSize; }
+
+private:
+    ThreadPool* m_threadPool;
+    float m_cellSize;
+    float m_inverseCellSize;
+    uint32_t m_tableMask;
+
+    std::vector<uint32_t> m_keys;                     // bucket of each particle
+    std::unique_ptr<std::atomic<uint32_t>[]> m_counts; // per bucket, reused as scatter cursors
+    size_t m_countsCapacity;
+    std::vector<uint32_t> m_cellStart;                // table size + 1 entries
+    std::vector<uint32_t> m_blockSums;                // prefix sum scratch
+    std::vector<uint32_t> m_sortedIndices;
+    std::vector<float> m_sortedX, m_sortedY, m_sortedZ;
+
+    // Helper methods
+    void Run(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task);
+    void PrefixSum();
+    glm::ivec3 GetCell(float x, float y, float z) const;
+    uint32_t GetBucket(int x, int y, int z) const;
+};
+
+template <typename Function>
+void ParticleNeighborGrid::ForEachNeighbor(const glm::vec3& position, Function function) const {
+    if (m_sortedIndices.empty()) return;
+
+    // The 27 surrounding cells; distinct cells can share a bucket, so visit each bucket once
+    glm::ivec3 center = GetCell(position.x, position.y, position.z);
+    uint32_t buckets[27];
+    int bucketCount = 0;
+    for (int z = -1; z <= 1; z++) {
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                uint32_t bucket = GetBucket(center.x + x, center.y + y, center.z + z);
+                bool seen = false;
+                for (int i = 0; i < bucketCount; i++) {
+                    seen |= buckets[i] == bucket;
+                }
+                if (!seen) {
+                    buckets[bucketCount++] = bucket;
+                }
+            }
+        }
+    }
+
+    const float radiusSquared = m_cellSize * m_cellSize;
+    for (int i = 0; i < bucketCount; i++) {
+        uint32_t end = m_cellStart[buckets[i] + 1];
+        for (uint32_t slot = m_cellStart[buckets[i]]; slot < end; slot++) {
+            glm::vec3 offset(m_sortedX[slot] - position.x, m_sortedY[slot] - position.y, m_sortedZ[slot] - position.z);
+            float distanceSquared = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+            if (distanceSquared < radiusSquared) {
+                function(m_sortedIndices[slot], offset, distanceSquared);
+            }
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#include "ParticleRibbons.h"
+#include "MemoryTracker.h"
+#include "ParticleData.h"
+#include "ShaderManager.h"
+#include <algorithm>
+#include <iostream>
+
+ParticleRibbons::ParticleRibbons()
+    : m_capacity(0), m_historyLength(0), m_widthScale(1.0f), m_recordInterval(0.0f), m_timeSinceRecord(0.0f),
+      m_usedSlots(0), m_VAO(0), m_pointBuffer(0), m_infoBuffer(0), m_pointTexture(0), m_infoTexture(0) {
+}
+
+ParticleRibbons::~ParticleRibbons() {
+    Cleanup();
+}
+
+void ParticleRibbons::Initialize() {
+    if (m_VAO) return;
+
+    // ribbon.vert builds vertices from gl_VertexID, but core profile draws need a VAO
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_pointBuffer);
+    glGenBuffers(1, &m_infoBuffer);
+    glGenTextures(1, &m_pointTexture);
+    glGenTextures(1, &m_infoTexture);
+    AllocateBuffers();
+
+    glBindTexture(GL_TEXTURE_BUFFER, m_pointTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_pointBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, m_infoTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_infoBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void ParticleRibbons::Cleanup() {
+    if (m_VAO) {
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(1, &m_pointBuffer);
+        glDeleteBuffers(1, &m_infoBuffer);
+        glDeleteTextures(1, &m_pointTexture);
+        glDeleteTextures(1, &m_infoTexture);
+        MemoryTracker::Get().ReleaseBuffer(m_pointBuffer);
+        MemoryTracker::Get().ReleaseBuffer(m_infoBuffer);
+    }
+    m_VAO = m_pointBuffer = m_infoBuffer = m_pointTexture = m_infoTexture = 0;
+}
+
+void ParticleRibbons::SetCapacity(size_t maxRibbons, int historyLength) {
+    m_capacity = maxRibbons;
+    m_historyLength = std::max(historyLength, 2);
+    m_points.assign(m_capacity * m_historyLength, glm::vec4(0.0f));
+    m_info.assign(m_capacity * 2, glm::vec4(0.0f));
+    m_heads.assign(m_capacity, 0);
+    m_counts.assign(m_capacity, 0);
+    Clear();
+
+    if (m_VAO) {
+        AllocateBuffers();
+    }
+}
+
+void ParticleRibbons::Track(ParticleData& particles, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (m_freeSlots.empty()) {
+            particles.trail[i] = UNTRACKED;
+            continue;
+        }
+
+        uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_usedSlots = std::max(m_usedSlots, (size_t)slot + 1);
+        m_heads[slot] = 0;
+        m_counts[slot] = 0;
+        m_info[slot * 2] = glm::vec4(0.0f);
+        particles.trail[i] = (float)slot;
+    }
+}
+
+void ParticleRibbons::Release(float trail) {
+    if (trail < 0.0f) return;
+
+    uint32_t slot = (uint32_t)trail;
+    m_counts[slot] = 0;
+    m_info[slot * 2] = glm::vec4(0.0f); // zero points: the strip collapses
+    m_freeSlots.push_back(slot);
+}
+
+void ParticleRibbons::Record(const ParticleData& particles, float deltaTime) {
+    m_timeSinceRecord += deltaTime;
+    bool advance = m_timeSinceRecord >= m_recordInterval;
+    if (advance) {
+        m_timeSinceRecord = 0.0f;
+    }
+
+    const int length = m_historyLength;
+    for (size_t i = 0; i < particles.Count(); i++) {
+        if (particles.trail[i] < 0.0f) continue;
+        uint32_t slot = (uint32_t)particles.trail[i];
+
+        // Between history points the newest one just follows the particle
+        int& head = m_heads[slot];
+        int& count = m_counts[slot];
+        if (advance || count == 0) {
+            count = std::min(count + 1, length);
+            head = (head + 1) % length;
+        }
+        int newest = (head + length - 1) % length;
+        m_points[slot * length + newest] = glm::vec4(particles.px[i], particles.py[i], particles.pz[i],
+                                                     particles.size[i] * m_widthScale * 0.5f);
+        m_info[slot * 2] = glm::vec4((float)head, (float)count, 0.0f, 0.0f);
+        m_info[slot * 2 + 1] = glm::vec4(particles.r[i], particles.g[i], particles.b[i], particles.a[i]);
+    }
+}
+
+void ParticleRibbons::Clear() {
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    std::fill(m_info.begin(), m_info.end(), glm::vec4(0.0f));
+    m_usedSlots = 0;
+    m_timeSinceRecord = 0.0f;
+
+    // Hand out low slots first, so the drawn range stays short
+    m_freeSlots.resize(m_capacity);
+    for (size_t i = 0; i < m_capacity; i++) {
+        m_freeSlots[i] = (uint32_t)(m_capacity - 1 - i);
+    }
+}
+
+void ParticleRibbons::Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection) {
+    if (!m_VAO || m_usedSlots == 0) return;
+
+    // Orphan and refill only the slots in use
+    glBindBuffer(GL_TEXTURE_BUFFER, m_pointBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, m_points.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, m_usedSlots * m_historyLength * sizeof(glm::vec4), m_points.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, m_infoBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, m_info.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, m_usedSlots * 2 * sizeof(glm::vec4), m_info.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    shader.setMat4Value("view", view);
+    shader.setMat4Value("projection", projection);
+    shader.setIntValue("historyLength", m_historyLength);
+    shader.setIntValue("ribbonPoints", 0);
+    shader.setIntValue("ribbonInfo", 1);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, m_pointTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_infoTexture);
+
+    // Two vertices per history point, one instance per ribbon
+    glBindVertexArray(m_VAO);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, m_historyLength * 2, (GLsizei)m_usedSlots);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+glm::vec3 ParticleRibbons::GetPoint(uint32_t ribbon, int age) const {
+    int index = ((m_heads[ribbon] - 1 - age) % m_historyLength + m_historyLength) % m_historyLength;
+    return glm::vec3(m_points[ribbon * m_historyLength + index]);
+}
+
+size_t ParticleRibbons::GetUploadSize() const {
+    return m_usedSlots * (m_historyLength + 2) * sizeof(glm::vec4);
+}
+
+void ParticleRibbons::AllocateBuffers() {
+    glBindBuffer(GL_TEXTURE_BUFFER, m_pointBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, m_points.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_infoBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, m_info.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    MemoryTracker::Get().TrackBuffer(m_pointBuffer, m_points.size() * sizeof(glm::vec4), MemoryCategory::Particles);
+    MemoryTracker::Get().TrackBuffer(m_infoBuffer, m_info.size() * sizeof(glm::vec4), MemoryCategory::Particles);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ShaderManager;
+struct ParticleData;
+
+// Ribbon trails for a particle system. Each tracked particle owns a slot in
+// a contiguous pool holding a ring of its last historyLength positions; the
+// slot index travels with the particle in ParticleData::trail, so swaps and
+// reordering keep the link. ribbon.vert reads the pool from a buffer texture
+// and expands every ribbon into a camera-facing strip, one instance per
+// ribbon, so an emitter's ribbons take a single draw call.
+class ParticleRibbons {
+public:
+    // ParticleData::trail value of a particle without a ribbon
+    static constexpr float UNTRACKED = -1.0f;
+
+    ParticleRibbons();
+    ~ParticleRibbons();
+
+    // Initialization
+    void Initialize();
+    void Cleanup();
+
+    // Discards every ribbon
+    void SetCapacity(size_t maxRibbons, int historyLength);
+    size_t GetCapacity() const { return m_capacity; }
+    int GetHistoryLength() const { return m_historyLength; }
+
+    // Ribbon width as a multiple of particle size (default 1)
+    void SetWidthScale(float scale) { m_widthScale = scale; }
+    // Seconds between history points; in between, the newest point follows
+    // the particle (default 0: a point per Record)
+    void SetRecordInterval(float seconds) { m_recordInterval = seconds; }
+
+    // Give particles [begin, end) ribbons while free slots last
+    void Track(ParticleData& particles, size_t begin, size_t end);
+    // Free the ribbon of a particle that is being removed
+    void Release(float trail);
+    // Append each tracked particle's position (after the update)
+    void Record(const ParticleData& particles, float deltaTime);
+    void Clear();
+
+    // Draw every ribbon (blend and depth state are set by the caller)
+    void Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    // Statistics and CPU access
+    size_t GetActiveCount() const { return m_capacity - m_freeSlots.size(); }
+    int GetPointCount(uint32_t ribbon) const { return m_counts[ribbon]; }
+    // age 0 is the newest point
+    glm::vec3 GetPoint(uint32_t ribbon, int age) const;
+    size_t GetUploadSize() const;
+
+private:
+    size_t m_capacity;
+    int m_historyLength;
+    float m_widthScale;
+    float m_recordInterval;
+    float m_timeSinceRecord;
+
+    // Ring pool: historyLength points per ribbon, xyz position and w half width
+    std::vector<glm::vec4> m_points;
+    // Two texels per ribbon: (head, count, 0, 0) and RGBA color
+    std::vector<glm::vec4> m_info;
+    std::vector<int> m_heads;   // next point to write
+    std::vector<int> m_counts;  // points recorded, up to historyLength
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_usedSlots;         // high-water mark; ribbons drawn per frame
+
+    // Rendering
+    GLuint m_VAO;
+    GLuint m_pointBuffer, m_infoBuffer;
+    GLuint m_pointTexture, m_infoTexture;
+
+    // Helper methods
+    void AllocateBuffers();
+};
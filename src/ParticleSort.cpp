@@ -0,0 +1,131 @@
+#include "ParticleSort.h"
+#include "ParticleData.h"
+#include <algorithm>
+#include <cmath>
+
+ParticleDepthSorter::ParticleDepthSorter()
+    : m_lastView(1.0f), m_hasLastView(false), m_identity(true) {
+}
+
+ParticleSortMethod ParticleDepthSorter::Sort(const ParticleData& particles, const glm::mat4& view, bool storageSorted) {
+    size_t count = particles.Count();
+    m_order.resize(count);
+    m_identity = true;
+    if (count < 2) {
+        for (size_t i = 0; i < count; i++) m_order[i] = (uint32_t)i;
+        return ParticleSortMethod::None;
+    }
+
+    ComputeKeys(particles, view);
+    for (size_t i = 0; i < count; i++) {
+        m_order[i] = (uint32_t)i;
+    }
+
+    float viewChange = 0.0f;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            viewChange = std::max(viewChange, std::abs(view[column][row] - m_lastView[column][row]));
+        }
+    }
+    bool coherent = storageSorted && m_hasLastView && viewChange <= COHERENT_VIEW_CHANGE;
+    m_lastView = view;
+    m_hasLastView = true;
+
+    ParticleSortMethod method = ParticleSortMethod::Radix;
+    if (coherent && InsertionSort(m_keys.data(), m_order.data(), count, count * MAX_SHIFTS_PER_PARTICLE)) {
+        method = ParticleSortMethod::Insertion;
+    } else {
+        m_scratchKeys.resize(count);
+        m_scratchOrder.resize(count);
+        RadixSort(m_keys.data(), m_order.data(), m_scratchKeys.data(), m_scratchOrder.data(), count);
+    }
+
+    for (size_t i = 0; i < count && m_identity; i++) {
+        m_identity = m_order[i] == i;
+    }
+    return method;
+}
+
+void ParticleDepthSorter::RadixSort(uint16_t* keys, uint32_t* order, uint16_t* scratchKeys, uint32_t* scratchOrder, size_t count) {
+    // Both byte histograms in one read of the keys
+    size_t histogram[2][256] = {};
+    for (size_t i = 0; i < count; i++) {
+        histogram[0][keys[i] & 0xff]++;
+        histogram[1][keys[i] >> 8]++;
+    }
+
+    uint16_t* sourceKeys = keys;
+    uint32_t* sourceOrder = order;
+    uint16_t* destinationKeys = scratchKeys;
+    uint32_t* destinationOrder = scratchOrder;
+    for (int pass = 0; pass < 2; pass++) {
+        // A byte that is equal for every key leaves the order unchanged
+        int shift = pass * 8;
+        if (histogram[pass][(sourceKeys[0] >> shift) & 0xff] == count) continue;
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            offsets[bucket] = sum;
+            sum += histogram[pass][bucket];
+        }
+        for (size_t i = 0; i < count; i++) {
+            size_t position = offsets[(sourceKeys[i] >> shift) & 0xff]++;
+            destinationKeys[position] = sourceKeys[i];
+            destinationOrder[position] = sourceOrder[i];
+        }
+        std::swap(sourceKeys, destinationKeys);
+        std::swap(sourceOrder, destinationOrder);
+    }
+
+    if (sourceKeys != keys) {
+        std::copy(sourceKeys, sourceKeys + count, keys);
+        std::copy(sourceOrder, sourceOrder + count, order);
+    }
+}
+
+bool ParticleDepthSorter::InsertionSort(uint16_t* keys, uint32_t* order, size_t count, size_t maxShifts) {
+    size_t shifts = 0;
+    for (size_t i = 1; i < count; i++) {
+        uint16_t key = keys[i];
+        uint32_t index = order[i];
+        size_t j = i;
+        while (j > 0 && keys[j - 1] > key) {
+            keys[j] = keys[j - 1];
+            order[j] = order[j - 1];
+            j--;
+            if (++shifts > maxShifts) {
+                // Leave valid pairs behind so a radix sort can take over
+                keys[j] = key;
+                order[j] = index;
+                return false;
+            }
+        }
+        keys[j] = key;
+        order[j] = index;
+    }
+    return true;
+}
+
+void ParticleDepthSorter::ComputeKeys(const ParticleData& particles, const glm::mat4& view) {
+    size_t count = particles.Count();
+    m_keys.resize(count);
+
+    // Distance along the view direction, computed twice rather than stored
+    const float zx = -view[0][2], zy = -view[1][2], zz = -view[2][2], zw = -view[3][2];
+    float minDepth = INFINITY;
+    float maxDepth = -INFINITY;
+    for (size_t i = 0; i < count; i++) {
+        float depth = zx * particles.px[i] + zy * particles.py[i] + zz * particles.pz[i] + zw;
+        minDepth = std::min(minDepth, depth);
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    // Farthest gets key 0 so ascending keys draw back to front
+    float range = maxDepth - minDepth;
+    float scale = range > 0.0f ? 65535.0f / range : 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float depth = zx * particles.px[i] + zy * particles.py[i] + zz * particles.pz[i] + zw;
+        m_keys[i] = (uint16_t)std::min(65535.0f, (maxDepth - depth) * scale);
+    }
+}
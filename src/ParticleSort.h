@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ParticleData;
+
+// How the last Sort() ordered the particles
+enum class ParticleSortMethod {
+    None,       // nothing to sort
+    Insertion,  // coherent fixup of last frame's order
+    Radix       // full LSD radix sort
+};
+
+// Back-to-front view-depth ordering for alpha-blended particles. Depths are
+// quantized to 16-bit keys over the frame's depth range. When the camera
+// barely moved and the caller kept particles in last frame's sorted order,
+// an insertion sort repairs the few keys that changed. Otherwise, or when
+// the fixup exceeds its shift budget, a two-pass LSD radix sort runs.
+class ParticleDepthSorter {
+public:
+    // Largest view matrix element change that still counts as coherent
+    static constexpr float COHERENT_VIEW_CHANGE = 0.05f;
+    // Insertion fixup gives up after this many element shifts per particle
+    static constexpr size_t MAX_SHIFTS_PER_PARTICLE = 4;
+
+    ParticleDepthSorter();
+
+    // Order the first Count() particles back to front; storageSorted says
+    // they are still in the order the previous Sort() produced
+    ParticleSortMethod Sort(const ParticleData& particles, const glm::mat4& view, bool storageSorted);
+
+    // order[i] = storage index of the i-th particle to draw
+    const std::vector<uint32_t>& GetOrder() const { return m_order; }
+    // True when the order is the storage order
+    bool IsIdentity() const { return m_identity; }
+
+    // Stable ascending sort of count (key, index) pairs; scratch arrays hold count entries
+    static void RadixSort(uint16_t* keys, uint32_t* order, uint16_t* scratchKeys, uint32_t* scratchOrder, size_t count);
+    // Insertion sort that stops after maxShifts element moves; false if it gave up
+    static bool InsertionSort(uint16_t* keys, uint32_t* order, size_t count, size_t maxShifts);
+
+private:
+    std::vector<uint16_t> m_keys;
+    std::vector<uint16_t> m_scratchKeys;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_scratchOrder;
+    glm::mat4 m_lastView;
+    bool m_hasLastView;
+    bool m_identity;
+
+    // Helper methods
+    void ComputeKeys(const ParticleData& particles, const glm::mat4& view);
+};
@@ -1,13 +1,33 @@
 #include "ParticleSystem.h"
+#include "AllocationTracker.h"
+#include "GpuParticleSimulation.h"
+#include "MemoryTracker.h"
+#include "ParticleFluid.h"
+#include "ParticleRibbons.h"
+#include "Profiler.h"
 #include "ShaderManager.h"
+#include "StreamBuffer.h"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <random>
+#include <utility>
 
 ParticleSystem::ParticleSystem() 
-    : m_position(0.0f), m_velocityMin(-1.0f), m_velocityMax(1.0f), m_acceleration(0.0f, -9.81f, 0.0f),
-      m_particleColor(1.0f, 1.0f, 1.0f, 1.0f), m_emissionRate(10.0f), m_lifeMin(1.0f), m_lifeMax(3.0f),
-      m_sizeMin(0.1f), m_sizeMax(0.5f), m_active(false), m_VAO(0), m_VBO(0), m_colorVBO(0),
-      m_blending(true), m_depthTest(false), m_rng(std::random_device{}()), m_distribution(0.0f, 1.0f) {
+    : m_poolPolicy(PoolPolicy::DropNew), m_droppedCount(0), m_reclaimedCount(0),
+      m_position(0.0f), m_velocityMin(-1.0f), m_velocityMax(1.0f), m_acceleration(0.0f, -9.81f, 0.0f),
+      m_particleColor(1.0f, 1.0f, 1.0f, 1.0f), m_emissionRate(10.0f), m_emissionScale(1.0f), m_maxLiveParticles(SIZE_MAX), m_lifeMin(1.0f), m_lifeMax(3.0f),
+      m_sizeMin(0.1f), m_sizeMax(0.5f), m_active(false), m_VAO(0), m_VBO(0), m_quadVBO(0), m_streamBuffer(nullptr),
+      m_blending(true), m_blendMode(ParticleBlendMode::Alpha), m_depthTest(false),
+      m_depthSort(false), m_storageSorted(false), m_sortTime(0.0f), m_lastSortMethod(ParticleSortMethod::None),
+      m_time(0.0f), m_hasDeathEvents(false), m_hasCollisionEvents(false), m_colliders(nullptr), m_simulationMode(SimulationMode::CPU),
+      m_simdLevel(DetectSimdLevel()), m_updateKernel(GetParticleUpdateKernel(m_simdLevel)), m_random(std::random_device{}()) {
+    SetCapacity(DEFAULT_CAPACITY);
 }
 
 ParticleSystem::~ParticleSystem() {
@@ -18,79 +38,198 @@ void ParticleSystem::Initialize() {
     std::cout << "Initializing Particle System..." << std::endl;
     
     SetupBuffers();
-    
-    // Reserve space for particles
-    m_particles.reserve(1000);
-    m_vertices.reserve(1000 * 4); // 4 vertices per particle (quad)
-    m_colors.reserve(1000 * 4);
+    if (m_ribbons) {
+        m_ribbons->Initialize();
+    }
 }
 
 void ParticleSystem::Cleanup() {
+    if (m_gpuSimulation) {
+        m_gpuSimulation->Cleanup();
+    }
+    if (m_ribbons) {
+        m_ribbons->Cleanup();
+    }
     if (m_VAO) {
         glDeleteVertexArrays(1, &m_VAO);
     }
     if (m_VBO) {
         glDeleteBuffers(1, &m_VBO);
+        glDeleteBuffers(1, &m_quadVBO);
+        MemoryTracker::Get().ReleaseBuffer(m_VBO);
+        MemoryTracker::Get().ReleaseBuffer(m_quadVBO);
     }
-    if (m_colorVBO) {
-        glDeleteBuffers(1, &m_colorVBO);
-    }
+    m_VAO = m_VBO = m_quadVBO = 0;
 }
 
-void ParticleSystem::Emit(const glm::vec3& position, int count) {
-    for (int i = 0; i < count; i++) {
-        CreateParticle(position);
+size_t ParticleSystem::Emit(const glm::vec3& position, int count) {
+    if (count <= 0) return 0;
+
+    // The budget's live cap is not an overflow, so it is not counted as dropped
+    if (m_particles.Count() >= m_maxLiveParticles) return 0;
+    count = (int)std::min((size_t)count, m_maxLiveParticles - m_particles.Count());
+
+    // Apply the pool policy once for the whole batch
+    size_t freeSlots = m_particles.Capacity() - m_particles.Count();
+    if ((size_t)count > freeSlots) {
+        size_t shortfall = count - freeSlots;
+        switch (m_poolPolicy) {
+            case PoolPolicy::DropNew:
+                m_droppedCount += shortfall;
+                count = (int)freeSlots;
+                break;
+            case PoolPolicy::KillOldest:
+                ReclaimOldest(std::min(shortfall, m_particles.Count()));
+                if ((size_t)count > m_particles.Capacity()) {
+                    m_droppedCount += count - m_particles.Capacity();
+                    count = (int)m_particles.Capacity();
+                }
+                break;
+            case PoolPolicy::Grow:
+                SetCapacity(std::max(m_particles.Count() + count, m_particles.Capacity() * 2));
+                break;
+        }
     }
+
+    return CreateParticles(position, count);
 }
 
 void ParticleSystem::Update(float deltaTime) {
+    PROFILE_SCOPE("ParticleSystem::Update");
+    ALLOCATION_TAG("Particles");
+
+    // Last step's sub-emitter events spawn first, even when this emitter is stopped
+    DispatchEvents();
+
     if (!m_active) return;
     
     // Emit new particles based on emission rate
-    float emissionCount = m_emissionRate * deltaTime;
-    int particlesToEmit = static_cast<int>(emissionCount);
-    
-    if (emissionCount - particlesToEmit > RandomFloat(0.0f, 1.0f)) {
-        particlesToEmit++;
+    int particlesToEmit = GetEmissionCount(deltaTime);
+
+    if (m_simulationMode == SimulationMode::GPU) {
+        // The emitter travels as a uniform block; spawning happens on the GPU
+        GpuEmitterBlock emitter = {};
+        emitter.position = glm::vec4(m_position, 1.0f);
+        emitter.velocityMin = glm::vec4(m_velocityMin, 0.0f);
+        emitter.velocityMax = glm::vec4(m_velocityMax, 0.0f);
+        emitter.acceleration = glm::vec4(m_acceleration, 0.0f);
+        emitter.color = m_particleColor;
+        emitter.lifeSize = glm::vec4(m_lifeMin, m_lifeMax, m_sizeMin, m_sizeMax);
+        emitter.timing = glm::vec4(deltaTime, 0.0f, 0.0f, 0.0f);
+        m_gpuSimulation->Update(emitter, particlesToEmit);
+        return;
     }
     
-    for (int i = 0; i < particlesToEmit; i++) {
-        Emit(m_position, 1);
+    {
+        PROFILE_SCOPE("Emit");
+        Emit(m_position, particlesToEmit);
     }
-    
-    // Update existing particles
-    for (auto& particle : m_particles) {
-        UpdateParticle(particle, deltaTime);
+
+    m_time += deltaTime;
+    ApplyForces(deltaTime);
+
+    // Broadphase: only boxes near this emitter are tested
+    if (m_colliders) {
+        m_colliders->Query(m_position, GetBoundingRadius(), m_collisionBoxes);
     }
     
-    // Remove dead particles
-    RemoveDeadParticles();
+    PROFILE_SCOPE("Simulate");
+    if (m_fluid) {
+        // The explicit pressure solve needs short steps; each substep also integrates and collides
+        int substeps = std::min(std::max((int)std::ceil(deltaTime / m_fluid->GetSettings().maxTimeStep), 1),
+                                MAX_FLUID_SUBSTEPS);
+        float substep = deltaTime / substeps;
+        for (int step = 0; step < substeps; step++) {
+            m_fluid->Step(m_particles, substep);
+            UpdateAndRemoveDead(substep);
+        }
+        m_storageSorted = false;
+    } else {
+        // Integrate, collide, age, fade and remove dead particles in one sweep
+        UpdateAndRemoveDead(deltaTime);
+    }
+
+    if (m_ribbons) {
+        PROFILE_SCOPE("Ribbons");
+        m_ribbons->Record(m_particles, deltaTime);
+    }
     
-    // Update vertex buffers
+    // Rebuild instance data (uploaded in Render)
     UpdateBuffers();
 }
 
+void ParticleSystem::Age(float deltaTime) {
+    if (m_simulationMode != SimulationMode::CPU) return;
+
+    // A swapped-in particle has not aged yet, so the same slot is checked again
+    ParticleData& p = m_particles;
+    size_t i = 0;
+    while (i < p.Count()) {
+        p.life[i] -= deltaTime;
+        if (p.life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        RemoveParticle(i);
+        m_storageSorted = false;
+    }
+
+    // Removals reorder the pool; rebuild so Render() draws only live particles
+    if (m_instances.size() != p.Count()) {
+        UpdateBuffers();
+    }
+}
+
 void ParticleSystem::Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection) {
-    if (m_particles.empty()) return;
+    PROFILE_SCOPE("ParticleSystem::Render");
+    ALLOCATION_TAG("Particles");
+    GLsizei instanceCount = 0;
+    if (m_simulationMode == SimulationMode::GPU) {
+        // Instances come straight from the simulation's latest buffer
+        m_gpuSimulation->BindForRender();
+        instanceCount = (GLsizei)m_gpuSimulation->GetCapacity();
+    } else {
+        if (m_instances.empty()) return;
+
+        m_lastSortMethod = ParticleSortMethod::None;
+        m_sortTime = 0.0f;
+        if (m_depthSort && m_blending && m_blendMode == ParticleBlendMode::Alpha) {
+            SortByDepth(view);
+        }
+
+        // Upload one instance record per particle
+        size_t dataSize = GetUploadSize();
+        if (m_streamBuffer) {
+            StreamBuffer::Allocation allocation = m_streamBuffer->Allocate(dataSize, sizeof(float));
+            if (!allocation) return; // Segment full; the stream buffer grows next frame
+            std::memcpy(allocation.data, m_instances.data(), dataSize);
+            m_streamBuffer->Commit(allocation);
+            BindParticleInstances(m_VAO, m_streamBuffer->GetBuffer(), allocation.offset);
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+            glBufferData(GL_ARRAY_BUFFER, dataSize, m_instances.data(), GL_DYNAMIC_DRAW);
+            MemoryTracker::Get().TrackBuffer(m_VBO, dataSize, MemoryCategory::Particles);
+            BindParticleInstances(m_VAO, m_VBO, 0);
+        }
+        instanceCount = (GLsizei)m_instances.size();
+    }
     
     // Set matrices
     shader.setMat4Value("view", view);
     shader.setMat4Value("projection", projection);
-    shader.setMat4Value("model", glm::mat4(1.0f));
     
     // Set rendering state
     if (m_blending) {
         glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        ApplyParticleBlendMode(m_blendMode);
     }
     
     if (!m_depthTest) {
         glDisable(GL_DEPTH_TEST);
     }
     
-    // Render particles
-    glBindVertexArray(m_VAO);
-    glDrawArrays(GL_TRIANGLES, 0, m_vertices.size());
+    // One camera-facing quad per instance (VAO bound above)
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instanceCount);
     glBindVertexArray(0);
     
     // Restore state
@@ -118,138 +257,509 @@ void ParticleSystem::SetVelocityRange(const glm::vec3& minVel, const glm::vec3&
     m_velocityMax = maxVel;
 }
 
+size_t ParticleSystem::GetExpectedParticleCount() const {
+    float expected = m_emissionRate * 0.5f * (m_lifeMin + m_lifeMax);
+    return std::min((size_t)std::ceil(expected), m_particles.Capacity());
+}
+
+float ParticleSystem::GetBoundingRadius() const {
+    glm::vec3 speed(std::max(std::abs(m_velocityMin.x), std::abs(m_velocityMax.x)),
+                    std::max(std::abs(m_velocityMin.y), std::abs(m_velocityMax.y)),
+                    std::max(std::abs(m_velocityMin.z), std::abs(m_velocityMax.z)));
+    float topSpeed = std::sqrt(speed.x * speed.x + speed.y * speed.y + speed.z * speed.z);
+
+    // Constant acceleration plus the most each force module can add
+    float acceleration = std::sqrt(m_acceleration.x * m_acceleration.x + m_acceleration.y * m_acceleration.y +
+                                   m_acceleration.z * m_acceleration.z);
+    for (const auto& force : m_forces) {
+        acceleration += force->GetMaxAcceleration();
+    }
+    return std::max(topSpeed * m_lifeMax + 0.5f * acceleration * m_lifeMax * m_lifeMax, m_sizeMax);
+}
+
+void ParticleSystem::SetCapacity(size_t capacity) {
+    // Particles that do not fit are dropped; free their ribbons first
+    if (m_ribbons) {
+        for (size_t i = capacity; i < m_particles.Count(); i++) {
+            m_ribbons->Release(m_particles.trail[i]);
+        }
+    }
+
+    // The only place the pool allocates
+    m_particles.SetCapacity(capacity);
+    if (m_hasCollisionEvents) {
+        m_contacts.resize(capacity);
+    }
+    m_reclaimIndices.resize(capacity);
+    m_instances.reserve(capacity);
+    if (m_depthSort) {
+        m_sortedParticles.SetCapacity(capacity);
+        m_sortedInstances.reserve(capacity);
+    }
+
+    if (m_simulationMode == SimulationMode::GPU && !m_gpuSimulation->Initialize(capacity)) {
+        std::cout << "GPU particle simulation lost, falling back to CPU" << std::endl;
+        m_simulationMode = SimulationMode::CPU;
+    }
+}
+
+void ParticleSystem::SetDepthSort(bool enabled) {
+    m_depthSort = enabled;
+    m_storageSorted = false;
+    if (enabled) {
+        m_sortedParticles.SetCapacity(m_particles.Capacity());
+        m_sortedInstances.reserve(m_particles.Capacity());
+    }
+}
+
+bool ParticleSystem::SetSimulationMode(SimulationMode mode) {
+    if (mode == m_simulationMode) return true;
+
+    if (mode == SimulationMode::GPU) {
+        if (!m_VAO) {
+            std::cout << "ERROR: Particle system must be initialized before GPU simulation!" << std::endl;
+            return false;
+        }
+        if (!m_gpuSimulation) {
+            m_gpuSimulation = std::make_unique<GpuParticleSimulation>();
+        }
+        if (!m_gpuSimulation->Initialize(m_particles.Capacity())) {
+            return false;
+        }
+    } else if (m_gpuSimulation) {
+        m_gpuSimulation->Cleanup();
+    }
+
+    Reset();
+    m_simulationMode = mode;
+    return true;
+}
+
+void ParticleSystem::SetSimdLevel(SimdLevel level) {
+    m_simdLevel = (int)level > (int)DetectSimdLevel() ? DetectSimdLevel() : level;
+    m_updateKernel = GetParticleUpdateKernel(m_simdLevel);
+}
+
+void ParticleSystem::AddForce(std::shared_ptr<ParticleForce> force) {
+    if (!force) return;
+    m_forces.push_back(std::move(force));
+    m_forceTimes.push_back(0.0f);
+}
+
+void ParticleSystem::RemoveForce(const ParticleForce* force) {
+    for (size_t i = 0; i < m_forces.size(); i++) {
+        if (m_forces[i].get() == force) {
+            m_forces.erase(m_forces.begin() + i);
+            m_forceTimes.erase(m_forceTimes.begin() + i);
+            return;
+        }
+    }
+}
+
+void ParticleSystem::ClearForces() {
+    m_forces.clear();
+    m_forceTimes.clear();
+}
+
+void ParticleSystem::EnableFluid(const SphFluidSettings& settings) {
+    if (!m_fluid) {
+        m_fluid = std::make_unique<SphFluidSolver>();
+    }
+    m_fluid->SetSettings(settings);
+}
+
+void ParticleSystem::DisableFluid() {
+    m_fluid.reset();
+}
+
+void ParticleSystem::EnableRibbons(size_t maxRibbons, int historyLength) {
+    if (!m_ribbons) {
+        m_ribbons = std::make_unique<ParticleRibbons>();
+        if (m_VAO) {
+            m_ribbons->Initialize();
+        }
+    }
+    m_ribbons->SetCapacity(maxRibbons, historyLength);
+
+    // Particles already alive start their ribbons now
+    m_ribbons->Track(m_particles, 0, m_particles.Count());
+}
+
+void ParticleSystem::DisableRibbons() {
+    m_ribbons.reset();
+}
+
+void ParticleSystem::RenderRibbons(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection) {
+    if (!m_ribbons || m_ribbons->GetActiveCount() == 0) return;
+
+    // Same blend state as the particles; strips are seen from both sides
+    if (m_blending) {
+        glEnable(GL_BLEND);
+        ApplyParticleBlendMode(m_blendMode);
+    }
+    if (!m_depthTest) {
+        glDisable(GL_DEPTH_TEST);
+    }
+    glDisable(GL_CULL_FACE);
+
+    m_ribbons->Render(shader, view, projection);
+
+    // Restore state
+    glEnable(GL_CULL_FACE);
+    if (m_blending) {
+        glDisable(GL_BLEND);
+    }
+    if (!m_depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+size_t ParticleSystem::AddSubEmitter(const SubEmitter& subEmitter) {
+    if (m_eventQueue.GetCapacity() == 0) {
+        m_eventQueue.SetCapacity(ParticleEventQueue::DEFAULT_CAPACITY);
+    }
+    m_subEmitters.push_back(subEmitter);
+    UpdateEventTriggers();
+    return m_subEmitters.size() - 1;
+}
+
+void ParticleSystem::RemoveSubEmitters(const ParticleSystem* target) {
+    size_t count = m_subEmitters.size();
+    m_subEmitters.erase(std::remove_if(m_subEmitters.begin(), m_subEmitters.end(),
+                                       [target](const SubEmitter& subEmitter) { return subEmitter.target == target; }),
+                        m_subEmitters.end());
+    if (m_subEmitters.size() == count) return;
+
+    // Queued events hold sub-emitter indices, which just changed
+    m_eventQueue.SetCapacity(m_eventQueue.GetCapacity());
+    UpdateEventTriggers();
+}
+
+void ParticleSystem::ClearSubEmitters() {
+    m_subEmitters.clear();
+    m_eventQueue.SetCapacity(m_eventQueue.GetCapacity());
+    UpdateEventTriggers();
+}
+
+void ParticleSystem::DispatchEvents() {
+    if (m_eventQueue.Size() == 0) return;
+    PROFILE_SCOPE("Sub-Emitter Events");
+
+    // Bulk pops through a fixed buffer, so dispatch never allocates
+    ParticleEvent events[EVENT_BATCH_SIZE];
+    size_t count;
+    while ((count = m_eventQueue.PopBulk(events, EVENT_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const SubEmitter& subEmitter = m_subEmitters[events[i].subEmitter];
+            if (subEmitter.target) {
+                subEmitter.target->SpawnFromEvent(events[i], subEmitter);
+            }
+        }
+    }
+}
+
+void ParticleSystem::SetColliders(const ParticleColliders* colliders) {
+    m_colliders = colliders;
+    m_collisionBoxes.clear();
+}
+
 void ParticleSystem::Reset() {
-    m_particles.clear();
-    m_vertices.clear();
-    m_colors.clear();
-    UpdateBuffers();
+    m_particles.Clear();
+    m_instances.clear();
+    if (m_ribbons) {
+        m_ribbons->Clear();
+    }
+    if (m_simulationMode == SimulationMode::GPU) {
+        m_gpuSimulation->Reset();
+    }
 }
 
-void ParticleSystem::CreateParticle(const glm::vec3& position) {
-    Particle particle;
-    particle.position = position;
-    particle.velocity = RandomVector(m_velocityMin, m_velocityMax);
-    particle.acceleration = m_acceleration;
-    particle.color = m_particleColor;
-    particle.maxLife = RandomFloat(m_lifeMin, m_lifeMax);
-    particle.life = particle.maxLife;
-    particle.size = RandomFloat(m_sizeMin, m_sizeMax);
-    particle.rotation = RandomFloat(0.0f, 360.0f);
-    particle.rotationSpeed = RandomFloat(-180.0f, 180.0f);
-    
-    m_particles.push_back(particle);
+int ParticleSystem::GetEmissionCount(float deltaTime) {
+    // The fractional part carries over as a probability
+    float emissionCount = m_emissionRate * m_emissionScale * deltaTime;
+    int count = static_cast<int>(emissionCount);
+    if (emissionCount - count > RandomFloat(0.0f, 1.0f)) {
+        count++;
+    }
+    return count;
 }
 
-void ParticleSystem::UpdateParticle(Particle& particle, float deltaTime) {
-    // Update physics
-    particle.velocity += particle.acceleration * deltaTime;
-    particle.position += particle.velocity * deltaTime;
-    
-    // Update rotation
-    particle.rotation += particle.rotationSpeed * deltaTime;
-    
-    // Update life
-    particle.life -= deltaTime;
-    
-    // Update color based on life
-    float lifeRatio = particle.life / particle.maxLife;
-    particle.color.a = lifeRatio;
-    
-    // Fade out near end of life
-    if (lifeRatio < 0.3f) {
-        particle.color.a *= lifeRatio / 0.3f;
+size_t ParticleSystem::CreateParticles(const glm::vec3& position, size_t count) {
+    // The caller has made room; each random stream is drawn in one batch
+    // straight into the new slots
+    count = std::min(count, m_particles.Capacity() - m_particles.Count());
+    if (count == 0) return 0;
+
+    ParticleData& p = m_particles;
+    size_t first = p.AddRange(count);
+    m_random.FillUniform(&p.vx[first], count, m_velocityMin.x, m_velocityMax.x);
+    m_random.FillUniform(&p.vy[first], count, m_velocityMin.y, m_velocityMax.y);
+    m_random.FillUniform(&p.vz[first], count, m_velocityMin.z, m_velocityMax.z);
+    m_random.FillUniform(&p.maxLife[first], count, m_lifeMin, m_lifeMax);
+    m_random.FillUniform(&p.size[first], count, m_sizeMin, m_sizeMax);
+    m_random.FillUniform(&p.rotation[first], count, 0.0f, 360.0f);
+    m_random.FillUniform(&p.rotationSpeed[first], count, -180.0f, 180.0f);
+
+    for (size_t i = first; i < first + count; i++) {
+        p.px[i] = position.x;
+        p.py[i] = position.y;
+        p.pz[i] = position.z;
+        p.ax[i] = m_acceleration.x;
+        p.ay[i] = m_acceleration.y;
+        p.az[i] = m_acceleration.z;
+        p.r[i] = m_particleColor.r;
+        p.g[i] = m_particleColor.g;
+        p.b[i] = m_particleColor.b;
+        p.a[i] = m_particleColor.a;
+        p.life[i] = p.maxLife[i];
+        p.trail[i] = ParticleRibbons::UNTRACKED;
+    }
+
+    if (m_ribbons) {
+        m_ribbons->Track(p, first, first + count);
     }
+    return count;
 }
 
-void ParticleSystem::RemoveDeadParticles() {
-    m_particles.erase(
-        std::remove_if(m_particles.begin(), m_particles.end(),
-            [](const Particle& particle) {
-                return particle.life <= 0.0f;
-            }),
-        m_particles.end()
-    );
+void ParticleSystem::ReclaimOldest(size_t count) {
+    if (count == 0) return;
+
+    // Select the particles with the least life left, without allocating
+    size_t alive = m_particles.Count();
+    for (size_t i = 0; i < alive; i++) {
+        m_reclaimIndices[i] = (uint32_t)i;
+    }
+    const AlignedFloatArray& life = m_particles.life;
+    auto byLife = [&life](uint32_t lhs, uint32_t rhs) { return life[lhs] < life[rhs]; };
+    std::nth_element(m_reclaimIndices.begin(), m_reclaimIndices.begin() + (count - 1),
+                     m_reclaimIndices.begin() + alive, byLife);
+
+    // Remove highest index first so swaps never move a selected particle
+    std::sort(m_reclaimIndices.begin(), m_reclaimIndices.begin() + count, std::greater<uint32_t>());
+    for (size_t i = 0; i < count; i++) {
+        RemoveParticle(m_reclaimIndices[i]);
+    }
+    m_reclaimedCount += count;
 }
 
-void ParticleSystem::UpdateBuffers() {
-    m_vertices.clear();
-    m_colors.clear();
-    
-    for (const auto& particle : m_particles) {
-        // Create quad vertices for particle
-        float halfSize = particle.size * 0.5f;
-        
-        // Calculate rotation matrix
-        float cosRot = cos(glm::radians(particle.rotation));
-        float sinRot = sin(glm::radians(particle.rotation));
-        
-        // Create 4 vertices for quad
-        glm::vec3 v1 = particle.position + glm::vec3(-halfSize, -halfSize, 0.0f);
-        glm::vec3 v2 = particle.position + glm::vec3(halfSize, -halfSize, 0.0f);
-        glm::vec3 v3 = particle.position + glm::vec3(halfSize, halfSize, 0.0f);
-        glm::vec3 v4 = particle.position + glm::vec3(-halfSize, halfSize, 0.0f);
-        
-        // Apply rotation
-        v1 = glm::vec3(v1.x * cosRot - v1.y * sinRot, v1.x * sinRot + v1.y * cosRot, v1.z);
-        v2 = glm::vec3(v2.x * cosRot - v2.y * sinRot, v2.x * sinRot + v2.y * cosRot, v2.z);
-        v3 = glm::vec3(v3.x * cosRot - v3.y * sinRot, v3.x * sinRot + v3.y * cosRot, v3.z);
-        v4 = glm::vec3(v4.x * cosRot - v4.y * sinRot, v4.x * sinRot + v4.y * cosRot, v4.z);
-        
-        // Add vertices (two triangles)
-        m_vertices.push_back(v1);
-        m_vertices.push_back(v2);
-        m_vertices.push_back(v3);
-        
-        m_vertices.push_back(v1);
-        m_vertices.push_back(v3);
-        m_vertices.push_back(v4);
-        
-        // Add colors
-        for (int i = 0; i < 6; i++) {
-            m_colors.push_back(particle.color);
+void ParticleSystem::RemoveParticle(size_t index) {
+    if (m_ribbons) {
+        m_ribbons->Release(m_particles.trail[index]);
+    }
+    m_particles.SwapRemove(index);
+}
+
+void ParticleSystem::ApplyForces(float deltaTime) {
+    PROFILE_SCOPE("Forces");
+
+    // One pass per module over the whole pool, timed so each effect's cost is visible
+    for (size_t i = 0; i < m_forces.size(); i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        m_forces[i]->Apply(m_particles, 0, m_particles.Count(), deltaTime, m_time);
+        auto end = std::chrono::high_resolution_clock::now();
+        m_forceTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0f;
+    }
+}
+
+void ParticleSystem::UpdateAndRemoveDead(float deltaTime) {
+    // Blocks go through the SIMD kernel, then dead particles in the block are
+    // replaced by the last live particle. A replacement from beyond the block
+    // has not been updated yet, so it is updated on the spot and re-checked.
+    const size_t BLOCK_SIZE = 256;
+    ParticleData& p = m_particles;
+
+    size_t begin = 0;
+    while (begin < p.Count()) {
+        size_t end = std::min(begin + BLOCK_SIZE, p.Count());
+        m_updateKernel(p, begin, end, deltaTime);
+        CollideParticles(begin, end);
+
+        size_t i = begin;
+        while (i < end) {
+            if (p.life[i] > 0.0f) {
+                i++;
+                continue;
+            }
+
+            size_t last = p.Count() - 1;
+            if (m_hasDeathEvents) {
+                PushEvents(SubEmitterTrigger::Death, i);
+            }
+            RemoveParticle(i);
+            if (last >= end) {
+                UpdateParticlesScalar(p, i, i + 1, deltaTime);
+                CollideParticles(i, i + 1);
+            } else {
+                end = p.Count();
+            }
         }
+        begin = end;
     }
-    
-    // Update OpenGL buffers
-    if (!m_vertices.empty()) {
-        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-        glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(glm::vec3), 
-                     m_vertices.data(), GL_DYNAMIC_DRAW);
-        
-        glBindBuffer(GL_ARRAY_BUFFER, m_colorVBO);
-        glBufferData(GL_ARRAY_BUFFER, m_colors.size() * sizeof(glm::vec4), 
-                     m_colors.data(), GL_DYNAMIC_DRAW);
+}
+
+void ParticleSystem::CollideParticles(size_t begin, size_t end) {
+    if (!m_colliders) return;
+
+    // Contact flags are only gathered when a sub-emitter listens for them
+    float* contacts = nullptr;
+    if (m_hasCollisionEvents) {
+        contacts = m_contacts.data();
+        std::fill(contacts + begin, contacts + end, 0.0f);
+    }
+
+    // Kill-on-contact zeroes life, so the caller's dead check removes the particle
+    for (const CollisionPlane& plane : m_colliders->GetPlanes()) {
+        CollideParticlesWithPlane(m_particles, begin, end, plane, m_collisionSettings, contacts);
+    }
+    for (uint32_t box : m_collisionBoxes) {
+        CollideParticlesWithBox(m_particles, begin, end, m_colliders->GetBox(box), m_collisionSettings, contacts);
+    }
+
+    if (contacts) {
+        for (size_t i = begin; i < end; i++) {
+            if (contacts[i] != 0.0f) {
+                PushEvents(SubEmitterTrigger::Collision, i);
+            }
+        }
+    }
+}
+
+void ParticleSystem::PushEvents(SubEmitterTrigger trigger, size_t index) {
+    const ParticleData& p = m_particles;
+    for (size_t i = 0; i < m_subEmitters.size(); i++) {
+        if (m_subEmitters[i].trigger != trigger) continue;
+        ParticleEvent event = {
+            { p.px[index], p.py[index], p.pz[index] },
+            { p.vx[index], p.vy[index], p.vz[index] },
+            (uint32_t)i
+        };
+        m_eventQueue.Push(event);
+    }
+}
+
+void ParticleSystem::SpawnFromEvent(const ParticleEvent& event, const SubEmitter& subEmitter) {
+    size_t count = Emit(glm::vec3(event.position[0], event.position[1], event.position[2]), subEmitter.count);
+
+    // Children are the newest particles; add the parent's share of velocity
+    ParticleData& p = m_particles;
+    for (size_t i = p.Count() - count; i < p.Count(); i++) {
+        p.vx[i] += event.velocity[0] * subEmitter.inheritVelocity;
+        p.vy[i] += event.velocity[1] * subEmitter.inheritVelocity;
+        p.vz[i] += event.velocity[2] * subEmitter.inheritVelocity;
+    }
+}
+
+void ParticleSystem::UpdateEventTriggers() {
+    m_hasDeathEvents = false;
+    m_hasCollisionEvents = false;
+    for (const SubEmitter& subEmitter : m_subEmitters) {
+        m_hasDeathEvents |= subEmitter.trigger == SubEmitterTrigger::Death;
+        m_hasCollisionEvents |= subEmitter.trigger == SubEmitterTrigger::Collision;
+    }
+    if (m_hasCollisionEvents) {
+        m_contacts.resize(m_particles.Capacity());
+    }
+}
+
+void ParticleSystem::SortByDepth(const glm::mat4& view) {
+    PROFILE_SCOPE("Depth Sort");
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    m_lastSortMethod = m_sorter.Sort(m_particles, view, m_storageSorted);
+
+    // Reorder the pool itself, so next frame starts nearly sorted
+    if (!m_sorter.IsIdentity()) {
+        const std::vector<uint32_t>& order = m_sorter.GetOrder();
+        size_t count = order.size();
+        m_sortedParticles.Gather(m_particles, order.data(), count);
+        std::swap(m_particles, m_sortedParticles);
+
+        m_sortedInstances.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            m_sortedInstances[i] = m_instances[order[i]];
+        }
+        std::swap(m_instances, m_sortedInstances);
+    }
+    m_storageSorted = true;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_sortTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0f;
+}
+
+void ParticleSystem::UpdateBuffers() {
+    PROFILE_SCOPE("Build Instances");
+
+    const ParticleData& p = m_particles;
+    m_instances.resize(p.Count());
+
+    auto toByte = [](float value) {
+        return (uint8_t)(std::max(0.0f, std::min(1.0f, value)) * 255.0f + 0.5f);
+    };
+
+    for (size_t i = 0; i < p.Count(); i++) {
+        ParticleInstance& instance = m_instances[i];
+        instance.position = glm::vec3(p.px[i], p.py[i], p.pz[i]);
+        instance.size = p.size[i];
+        instance.rotation = p.rotation[i];
+        instance.color[0] = toByte(p.r[i]);
+        instance.color[1] = toByte(p.g[i]);
+        instance.color[2] = toByte(p.b[i]);
+        instance.color[3] = toByte(p.a[i]);
     }
 }
 
 void ParticleSystem::SetupBuffers() {
-    glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_colorVBO);
-    
-    glBindVertexArray(m_VAO);
-    
-    // Position buffer
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    CreateParticleInstanceVAO(m_VAO, m_quadVBO);
+}
+
+float ParticleSystem::RandomFloat(float min, float max) {
+    return m_random.NextFloat(min, max);
+}
+
+void CreateParticleInstanceVAO(GLuint& vao, GLuint& quadVBO) {
+    // Unit quad corners shared by every instance
+    const float corners[] = {
+        -0.5f, -0.5f,
+         0.5f, -0.5f,
+        -0.5f,  0.5f,
+         0.5f,  0.5f
+    };
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVBO);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    MemoryTracker::Get().TrackBuffer(quadVBO, sizeof(corners), MemoryCategory::Particles);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    
-    // Color buffer
-    glBindBuffer(GL_ARRAY_BUFFER, m_colorVBO);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
-    glEnableVertexAttribArray(1);
-    
+
+    // Instance attributes advance once per quad
+    for (GLuint attribute = 1; attribute <= 3; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
     glBindVertexArray(0);
 }
 
-float ParticleSystem::RandomFloat(float min, float max) {
-    return min + m_distribution(m_rng) * (max - min);
+void BindParticleInstances(GLuint vao, GLuint buffer, GLintptr offset) {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+                          (void*)(offset + offsetof(ParticleInstance, position)));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+                          (void*)(offset + offsetof(ParticleInstance, rotation)));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ParticleInstance),
+                          (void*)(offset + offsetof(ParticleInstance, color)));
 }
 
-glm::vec3 ParticleSystem::RandomVector(const glm::vec3& min, const glm::vec3& max) {
-    return glm::vec3(
-        RandomFloat(min.x, max.x),
-        RandomFloat(min.y, max.y),
-        RandomFloat(min.z, max.z)
-    );
+void ApplyParticleBlendMode(ParticleBlendMode mode) {
+    if (mode == ParticleBlendMode::Additive) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    } else {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
 }
@@ -4,26 +4,58 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
-#include <random>
+#include <cstdint>
+#include "ParticleData.h"
+#include "ParticleKernels.h"
+#include "ParticleCollision.h"
+#include "ParticleEvents.h"
+#include "ParticleForces.h"
+#include "ParticleSort.h"
+#include "Random.h"
 
 class ShaderManager;
+class StreamBuffer;
+class GpuParticleSimulation;
+class SphFluidSolver;
+class ParticleRibbons;
+struct SphFluidSettings;
 
-struct Particle {
+// Per-particle instance record; particle.vert expands it into a
+// camera-facing quad. 24 bytes versus 168 for six expanded vertices.
+struct ParticleInstance {
     glm::vec3 position;
-    glm::vec3 velocity;
-    glm::vec3 acceleration;
-    glm::vec4 color;
-    float life;
-    float maxLife;
     float size;
-    float rotation;
-    float rotationSpeed;
-    
-    Particle() : life(0.0f), maxLife(1.0f), size(1.0f), rotation(0.0f), rotationSpeed(0.0f) {}
+    float rotation;    // degrees, around the view direction
+    uint8_t color[4];  // RGBA8, normalized in the shader
+};
+
+// What Emit() does when the pool is at capacity
+enum class PoolPolicy {
+    DropNew,     // discard the new particles
+    KillOldest,  // replace the particles closest to the end of their life
+    Grow         // double the capacity (allocates)
+};
+
+// How particles combine with what is behind them
+enum class ParticleBlendMode {
+    Alpha,     // SRC_ALPHA, ONE_MINUS_SRC_ALPHA (smoke, dust)
+    Additive   // SRC_ALPHA, ONE (sparks, fire)
+};
+
+// Where particles are simulated
+enum class SimulationMode {
+    CPU,  // SIMD kernels over ParticleData, instances streamed every frame
+    GPU   // transform feedback; particles never leave GPU memory
 };
 
 class ParticleSystem {
 public:
+    static constexpr size_t DEFAULT_CAPACITY = 10000;
+    // Fluid substeps per Update(); longer frames run the fluid in slow motion
+    static constexpr int MAX_FLUID_SUBSTEPS = 8;
+    // Events moved out of the queue per bulk pop in DispatchEvents()
+    static constexpr size_t EVENT_BATCH_SIZE = 64;
+
     ParticleSystem();
     ~ParticleSystem();
 
@@ -31,9 +63,14 @@ public:
     void Initialize();
     void Cleanup();
 
-    // Particle management
-    void Emit(const glm::vec3& position, int count = 1);
+    // Particle management. Emit() returns how many particles it created;
+    // they are the last ones in GetParticles().
+    size_t Emit(const glm::vec3& position, int count = 1);
     void Update(float deltaTime);
+    // Count down particle lives and remove the expired ones, without moving,
+    // emitting or firing events (frozen emitters; CPU simulation only). The
+    // instances are rebuilt when particles were removed.
+    void Age(float deltaTime);
     void Render(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection);
     
     // System properties
@@ -43,22 +80,133 @@ public:
     void SetParticleColor(const glm::vec4& color) { m_particleColor = color; }
     void SetVelocityRange(const glm::vec3& minVel, const glm::vec3& maxVel);
     void SetAcceleration(const glm::vec3& accel) { m_acceleration = accel; }
+
+    // Budget controls (set by ParticleManager's particle budget)
+    void SetEmissionScale(float scale) { m_emissionScale = scale; }
+    float GetEmissionScale() const { return m_emissionScale; }
+    // Emission stops while this many particles are alive (default: capacity)
+    void SetMaxLiveParticles(size_t count) { m_maxLiveParticles = count; }
+    size_t GetMaxLiveParticles() const { return m_maxLiveParticles; }
+    // Live particles at the full emission rate, capped by capacity
+    size_t GetExpectedParticleCount() const;
+    // Bound on how far particles travel from the emitter: top speed * max life
+    // plus the distance covered under acceleration and force modules
+    float GetBoundingRadius() const;
     
     // System state
     void Start() { m_active = true; }
     void Stop() { m_active = false; }
     void Reset();
     void SetPosition(const glm::vec3& position) { m_position = position; }
+    const glm::vec3& GetPosition() const { return m_position; }
+    // Reseed emission randomness; equal seeds give identical particles
+    void SetSeed(uint32_t seed) { m_random.Seed(seed); }
+
+    // Particle pool
+    void SetCapacity(size_t capacity);
+    size_t GetCapacity() const { return m_particles.Capacity(); }
+    void SetPoolPolicy(PoolPolicy policy) { m_poolPolicy = policy; }
+    PoolPolicy GetPoolPolicy() const { return m_poolPolicy; }
     
     // Rendering properties
     void SetBlending(bool enabled) { m_blending = enabled; }
+    void SetBlendMode(ParticleBlendMode mode) { m_blendMode = mode; }
+    ParticleBlendMode GetBlendMode() const { return m_blendMode; }
     void SetDepthTest(bool enabled) { m_depthTest = enabled; }
+    // Draw alpha-blended particles back to front (CPU mode; additive blending
+    // is order independent and never sorted). Sorting keeps the pool in draw
+    // order so the next frame's sort is usually a cheap fixup.
+    void SetDepthSort(bool enabled);
+    bool GetDepthSort() const { return m_depthSort; }
+
+    // Force modules (CPU mode), applied in order to every particle before
+    // integration. A module may be shared by several systems.
+    void AddForce(std::shared_ptr<ParticleForce> force);
+    void RemoveForce(const ParticleForce* force);
+    void ClearForces();
+    size_t GetForceCount() const { return m_forces.size(); }
+    ParticleForce& GetForce(size_t index) const { return *m_forces[index]; }
+    float GetForceTime(size_t index) const { return m_forceTimes[index]; }  // ms, last Update()
+
+    // Fluid mode (CPU): particles interact through an SPH solver, substepped
+    // to the settings' maxTimeStep. The solver reorders the pool by grid cell
+    // every step. ParticleManager updates fluid emitters after the others, one
+    // at a time, so the solver's passes use the whole thread pool.
+    void EnableFluid(const SphFluidSettings& settings);
+    void DisableFluid();
+    SphFluidSolver* GetFluidSolver() const { return m_fluid.get(); }
+
+    // Ribbon trails (CPU mode): the first maxRibbons particles alive at a time
+    // leave a strip through their last historyLength positions
+    void EnableRibbons(size_t maxRibbons, int historyLength);
+    void DisableRibbons();
+    ParticleRibbons* GetRibbons() const { return m_ribbons.get(); }
+    // Draw all ribbons in one call with ribbon.vert/ribbon.frag
+    void RenderRibbons(ShaderManager& shader, const glm::mat4& view, const glm::mat4& projection);
+
+    // Sub-emitters (CPU mode). Particles that die or collide push spawn
+    // events into this emitter's bounded lock-free queue during the update
+    // sweep; the next Update() starts by spawning them into the targets.
+    // ParticleManager dispatches all its emitters' events serially before
+    // the parallel update, so targets may be any emitter. Targets must
+    // outlive this system.
+    size_t AddSubEmitter(const SubEmitter& subEmitter);
+    void RemoveSubEmitters(const ParticleSystem* target);
+    void ClearSubEmitters();
+    size_t GetSubEmitterCount() const { return m_subEmitters.size(); }
+    const SubEmitter& GetSubEmitter(size_t index) const { return m_subEmitters[index]; }
+    void SetEventQueueCapacity(size_t capacity) { m_eventQueue.SetCapacity(capacity); }
+    size_t GetEventQueueCapacity() const { return m_eventQueue.GetCapacity(); }
+    size_t GetPendingEventCount() const { return m_eventQueue.Size(); }
+    // Events lost to a full queue (lifetime total)
+    size_t GetEventOverflowCount() const { return m_eventQueue.GetOverflowCount(); }
+    // Spawn every queued event into its target (called by Update())
+    void DispatchEvents();
+
+    // Collision (CPU mode). Particles collide with the colliders' planes and
+    // with the boxes its broadphase finds within GetBoundingRadius() of the
+    // emitter; the colliders must outlive the system. nullptr disables it.
+    void SetColliders(const ParticleColliders* colliders);
+    const ParticleColliders* GetColliders() const { return m_colliders; }
+    void SetCollisionSettings(const ParticleCollisionSettings& settings) { m_collisionSettings = settings; }
+    const ParticleCollisionSettings& GetCollisionSettings() const { return m_collisionSettings; }
+    // Boxes tested in the last Update()
+    size_t GetCollisionBoxCount() const { return m_collisionBoxes.size(); }
+
+    // Stream vertices through a shared per-frame buffer instead of a private VBO
+    void SetStreamBuffer(StreamBuffer* streamBuffer) { m_streamBuffer = streamBuffer; }
+
+    // Statistics
+    size_t GetParticleCount() const { return m_particles.Count(); }
+    const ParticleData& GetParticles() const { return m_particles; }
+    size_t GetDroppedCount() const { return m_droppedCount; }
+    size_t GetReclaimedCount() const { return m_reclaimedCount; }
+    const std::vector<ParticleInstance>& GetInstances() const { return m_instances; }
+    size_t GetUploadSize() const { return m_instances.size() * sizeof(ParticleInstance); }
+    float GetSortTime() const { return m_sortTime; }  // ms, last Render()
+    ParticleSortMethod GetLastSortMethod() const { return m_lastSortMethod; }
+
+    // Simulation mode. GPU mode needs Initialize() and the transform feedback
+    // shader; on failure the system stays on the CPU and this returns false.
+    // Switching modes discards the live particles. In GPU mode the live count
+    // is not read back, so GetParticleCount() reports CPU particles only.
+    bool SetSimulationMode(SimulationMode mode);
+    SimulationMode GetSimulationMode() const { return m_simulationMode; }
+
+    // Update kernel selection (defaults to the best level the CPU supports)
+    void SetSimdLevel(SimdLevel level);
+    SimdLevel GetSimdLevel() const { return m_simdLevel; }
 
 private:
     // Particle data
-    std::vector<Particle> m_particles;
-    std::vector<glm::vec3> m_vertices;
-    std::vector<glm::vec4> m_colors;
+    ParticleData m_particles;
+    std::vector<ParticleInstance> m_instances;
+
+    // Pool management
+    PoolPolicy m_poolPolicy;
+    std::vector<uint32_t> m_reclaimIndices; // scratch for KillOldest, sized to capacity
+    size_t m_droppedCount;
+    size_t m_reclaimedCount;
     
     // System properties
     glm::vec3 m_position;
@@ -67,6 +215,8 @@ private:
     glm::vec3 m_acceleration;
     glm::vec4 m_particleColor;
     float m_emissionRate;
+    float m_emissionScale;
+    size_t m_maxLiveParticles;
     float m_lifeMin;
     float m_lifeMax;
     float m_sizeMin;
@@ -74,20 +224,76 @@ private:
     bool m_active;
     
     // Rendering
-    GLuint m_VAO, m_VBO, m_colorVBO;
+    GLuint m_VAO, m_VBO, m_quadVBO;
+    StreamBuffer* m_streamBuffer;
     bool m_blending;
+    ParticleBlendMode m_blendMode;
     bool m_depthTest;
+
+    // Depth sorting
+    bool m_depthSort;
+    bool m_storageSorted;                         // pool still in last sort's order
+    ParticleDepthSorter m_sorter;
+    ParticleData m_sortedParticles;               // gather target, swapped with m_particles
+    std::vector<ParticleInstance> m_sortedInstances;
+    float m_sortTime;
+    ParticleSortMethod m_lastSortMethod;
+    
+    // Force modules
+    std::vector<std::shared_ptr<ParticleForce>> m_forces;
+    std::vector<float> m_forceTimes;
+    float m_time;  // simulation clock passed to animated forces
+
+    // Fluid
+    std::unique_ptr<SphFluidSolver> m_fluid;
+
+    // Ribbons
+    std::unique_ptr<ParticleRibbons> m_ribbons;
+
+    // Sub-emitters
+    std::vector<SubEmitter> m_subEmitters;
+    ParticleEventQueue m_eventQueue;
+    bool m_hasDeathEvents;
+    bool m_hasCollisionEvents;
+    AlignedFloatArray m_contacts;  // per particle contact flags for collision events
+
+    // Collision
+    const ParticleColliders* m_colliders;
+    ParticleCollisionSettings m_collisionSettings;
+    std::vector<uint32_t> m_collisionBoxes; // broadphase result for this frame
+
+    // Simulation
+    SimulationMode m_simulationMode;
+    std::unique_ptr<GpuParticleSimulation> m_gpuSimulation;
+
+    // Update kernel
+    SimdLevel m_simdLevel;
+    ParticleUpdateKernel m_updateKernel;
     
     // Random number generation
-    std::mt19937 m_rng;
-    std::uniform_real_distribution<float> m_distribution;
+    Xoshiro128Plus m_random;
     
     // Helper methods
-    void CreateParticle(const glm::vec3& position);
-    void UpdateParticle(Particle& particle, float deltaTime);
-    void RemoveDeadParticles();
+    int GetEmissionCount(float deltaTime);
+    size_t CreateParticles(const glm::vec3& position, size_t count);
+    void ReclaimOldest(size_t count);
+    void RemoveParticle(size_t index);
+    void ApplyForces(float deltaTime);
+    void UpdateAndRemoveDead(float deltaTime);
+    void CollideParticles(size_t begin, size_t end);
+    void PushEvents(SubEmitterTrigger trigger, size_t index);
+    void SpawnFromEvent(const ParticleEvent& event, const SubEmitter& subEmitter);
+    void UpdateEventTriggers();
     void UpdateBuffers();
+    void SortByDepth(const glm::mat4& view);
     void SetupBuffers();
     float RandomFloat(float min, float max);
-    glm::vec3 RandomVector(const glm::vec3& min, const glm::vec3& max);
 };
+
+// Instance VAO shared by ParticleSystem and ParticleManager: the unit quad at
+// attribute 0 and ParticleInstance attributes 1-3 advancing per instance
+void CreateParticleInstanceVAO(GLuint& vao, GLuint& quadVBO);
+// Point the instance attributes at buffer + offset (changes per frame when streaming)
+void BindParticleInstances(GLuint vao, GLuint buffer, GLintptr offset);
+// Blend function for a mode (blending must already be enabled)
+void ApplyParticleBlendMode(ParticleBlendMode mode);
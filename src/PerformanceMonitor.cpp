@@ -1,7 +1,10 @@
 #include "PerformanceMonitor.h"
+#include <cstdint>
 #include <iostream>
 #include <algorithm>
-#include <numeric>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 
 const float PerformanceMonitor::TARGET_FPS = 60.0f;
 const float PerformanceMonitor::MIN_FPS = 30.0f;
@@ -9,20 +12,35 @@ const float PerformanceMonitor::MAX_FRAME_TIME = 33.33f; // 30 FPS equivalent
 
 PerformanceMonitor::PerformanceMonitor() 
     : m_fps(0.0f), m_frameTime(0.0f), m_averageFPS(0.0f), m_averageFrameTime(0.0f),
-      m_memoryUsage(0), m_peakMemoryUsage(0) {
+      m_gpuResultFrame(UINT64_MAX), m_memoryUsage(0), m_peakMemoryUsage(0) {
     m_lastFrameTime = std::chrono::high_resolution_clock::now();
-    m_frameTimeHistory.reserve(FRAME_HISTORY_SIZE);
 }
 
 PerformanceMonitor::~PerformanceMonitor() {
-    // Clean up GPU query objects
-    for (auto& pair : m_queryObjects) {
-        glDeleteQueries(1, &pair.second);
-    }
+    // GPU query objects are released by m_gpuProfiler
 }
 
 void PerformanceMonitor::BeginFrame() {
     m_currentFrameTime = std::chrono::high_resolution_clock::now();
+
+    // Collect GPU zones from whichever earlier frame has finished
+    m_gpuProfiler.BeginFrame();
+    if (m_gpuProfiler.IsInitialized() && m_gpuProfiler.GetResultFrame() != m_gpuResultFrame &&
+        !m_gpuProfiler.GetResults().empty()) {
+        m_gpuResultFrame = m_gpuProfiler.GetResultFrame();
+        for (auto& pair : m_gpuTimes) {
+            pair.second = 0.0f;
+        }
+        for (const GpuZoneResult& result : m_gpuProfiler.GetResults()) {
+            if (result.depth == 0) continue;
+            // A timer's entry is created once; later frames only look it up
+            auto it = m_gpuTimes.find(result.name);
+            if (it == m_gpuTimes.end()) {
+                it = m_gpuTimes.emplace(result.name, 0.0f).first;
+            }
+            it->second += result.time;
+        }
+    }
 }
 
 void PerformanceMonitor::EndFrame() {
@@ -30,88 +48,75 @@ void PerformanceMonitor::EndFrame() {
     
     // Calculate frame time
     auto frameDuration = std::chrono::duration_cast<std::chrono::microseconds>(now - m_currentFrameTime);
+    uint32_t microseconds = (uint32_t)std::min<long long>(frameDuration.count(), FrameTimeHistogram::MAX_VALUE);
     m_frameTime = frameDuration.count() / 1000.0f; // Convert to milliseconds
     
     // Calculate FPS
     m_fps = 1000.0f / m_frameTime;
     
     // Update frame history
-    m_frameTimeHistory.push_back(m_frameTime);
-    if (m_frameTimeHistory.size() > FRAME_HISTORY_SIZE) {
-        m_frameTimeHistory.erase(m_frameTimeHistory.begin());
-    }
+    m_frameTimes.Add(microseconds);
+    m_sessionHistogram.Add(microseconds);
     
     // Calculate averages
-    if (!m_frameTimeHistory.empty()) {
-        m_averageFrameTime = std::accumulate(m_frameTimeHistory.begin(), m_frameTimeHistory.end(), 0.0f) / m_frameTimeHistory.size();
-        m_averageFPS = 1000.0f / m_averageFrameTime;
-    }
+    m_averageFrameTime = m_frameTimes.GetAverage();
+    m_averageFPS = 1000.0f / m_averageFrameTime;
     
     m_lastFrameTime = now;
-}
 
-void PerformanceMonitor::BeginGPUTimer(const std::string& name) {
-    if (m_timerActive[name]) {
-        std::cout << "Warning: GPU timer '" << name << "' is already active!" << std::endl;
-        return;
-    }
-    
-    // Create query object if it doesn't exist
-    if (m_queryObjects.find(name) == m_queryObjects.end()) {
-        GLuint query;
-        glGenQueries(1, &query);
-        m_queryObjects[name] = query;
+    if (!m_gpuTimerStack.empty()) {
+        std::cout << "Warning: GPU timer '" << m_gpuTimerStack.back() << "' is still active!" << std::endl;
+        m_gpuTimerStack.clear();
     }
-    
-    glBeginQuery(GL_TIME_ELAPSED, m_queryObjects[name]);
-    m_timerActive[name] = true;
+    m_gpuProfiler.EndFrame();
 }
 
-void PerformanceMonitor::EndGPUTimer(const std::string& name) {
-    if (!m_timerActive[name]) {
+void PerformanceMonitor::BeginGPUTimer(const char* name) {
+    // A timestamp pair per timer, so timers nest; nothing is read back here
+    m_gpuProfiler.BeginZone(name);
+    m_gpuTimerStack.push_back(name);
+}
+
+void PerformanceMonitor::EndGPUTimer(const char* name) {
+    if (m_gpuTimerStack.empty() || std::strcmp(m_gpuTimerStack.back(), name) != 0) {
         std::cout << "Warning: GPU timer '" << name << "' is not active!" << std::endl;
         return;
     }
-    
-    glEndQuery(GL_TIME_ELAPSED);
-    m_timerActive[name] = false;
-    
-    // Get the result
-    GLint available = 0;
-    glGetQueryObjectiv(m_queryObjects[name], GL_QUERY_RESULT_AVAILABLE, &available);
-    
-    if (available) {
-        GLint64 timeElapsed;
-        glGetQueryObjecti64v(m_queryObjects[name], GL_QUERY_RESULT, &timeElapsed);
-        m_gpuTimes[name] = timeElapsed / 1000000.0f; // Convert to milliseconds
-    }
+
+    m_gpuProfiler.EndZone();
+    m_gpuTimerStack.pop_back();
 }
 
-float PerformanceMonitor::GetGPUTime(const std::string& name) const {
+float PerformanceMonitor::GetGPUTime(const char* name) const {
     auto it = m_gpuTimes.find(name);
     return (it != m_gpuTimes.end()) ? it->second : 0.0f;
 }
 
+void PerformanceMonitor::RecordPacingJitter(float jitter) {
+    long long microseconds = std::llround(std::max(jitter, 0.0f) * 1000.0);
+    m_pacingJitter.Add((uint32_t)std::min<long long>(microseconds, FrameTimeHistogram::MAX_VALUE));
+}
+
 void PerformanceMonitor::UpdateMemoryUsage() {
-    // This is a simplified memory monitoring
-    // In a real implementation, you would use platform-specific APIs
-    // For now, we'll just track OpenGL memory usage
-    GLint totalMemory, availableMemory;
-    glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NV, &totalMemory);
-    glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NV, &availableMemory);
-    
-    m_memoryUsage = totalMemory - availableMemory;
+    // Process counters from the OS; GPU usage is tracked as the engine allocates
+    if (!MemoryTracker::ReadProcessMemory(m_processMemory)) return;
+
+    m_memoryUsage = m_processMemory.residentBytes;
     m_peakMemoryUsage = std::max(m_peakMemoryUsage, m_memoryUsage);
 }
 
 void PerformanceMonitor::ResetStatistics() {
-    m_frameTimeHistory.clear();
+    m_frameTimes.Clear();
+    m_sessionHistogram.Clear();
     m_fps = 0.0f;
     m_frameTime = 0.0f;
     m_averageFPS = 0.0f;
     m_averageFrameTime = 0.0f;
+    m_pacingJitter.Clear();
     m_memoryUsage = 0;
     m_peakMemoryUsage = 0;
+    m_processMemory = ProcessMemoryInfo();
+    MemoryTracker::Get().ResetPeaks();
     
     for (auto& pair : m_gpuTimes) {
         pair.second = 0.0f;
@@ -124,13 +129,23 @@ void PerformanceMonitor::PrintStatistics() const {
     std::cout << "Average FPS: " << m_averageFPS << std::endl;
     std::cout << "Frame Time: " << m_frameTime << " ms" << std::endl;
     std::cout << "Average Frame Time: " << m_averageFrameTime << " ms" << std::endl;
+    if (m_frameTimes.count > 0) {
+        std::cout << "Frame Time (last " << m_frameTimes.count << "): " << FormatFrameTimeStats(GetWindowFrameTimeStats()) << std::endl;
+        std::cout << "Frame Time (session): " << FormatFrameTimeStats(GetSessionFrameTimeStats()) << std::endl;
+    }
     std::cout << "Memory Usage: " << m_memoryUsage / 1024 / 1024 << " MB" << std::endl;
     std::cout << "Peak Memory: " << m_peakMemoryUsage / 1024 / 1024 << " MB" << std::endl;
+    std::cout << GetMemoryReport();
+    if (m_pacingJitter.count > 0) {
+        std::cout << "Pacing Jitter: " << GetAveragePacingJitter() << " ms avg, "
+                  << FormatFrameTimeStats(GetPacingJitterStats()) << std::endl;
+    }
     
-    if (!m_gpuTimes.empty()) {
-        std::cout << "\nGPU Times:" << std::endl;
-        for (const auto& pair : m_gpuTimes) {
-            std::cout << "  " << pair.first << ": " << pair.second << " ms" << std::endl;
+    if (!m_gpuProfiler.GetResults().empty()) {
+        std::cout << "\nGPU Times (frame " << m_gpuProfiler.GetResultFrame() << ", "
+                  << m_gpuProfiler.GetFrameNumber() - m_gpuProfiler.GetResultFrame() << " frames ago):" << std::endl;
+        for (const GpuZoneResult& result : m_gpuProfiler.GetResults()) {
+            std::cout << std::string(2 + result.depth * 2, ' ') << result.name << ": " << result.time << " ms" << std::endl;
         }
     }
     
@@ -145,7 +160,96 @@ std::string PerformanceMonitor::GetPerformanceReport() const {
     std::string report = "Performance Report:\n";
     report += "FPS: " + std::to_string(m_fps) + " (Target: " + std::to_string(TARGET_FPS) + ")\n";
     report += "Frame Time: " + std::to_string(m_frameTime) + " ms\n";
+    if (m_frameTimes.count > 0) {
+        report += "Frame Time (last " + std::to_string(m_frameTimes.count) + "): " + FormatFrameTimeStats(GetWindowFrameTimeStats()) + "\n";
+        report += "Frame Time (session): " + FormatFrameTimeStats(GetSessionFrameTimeStats()) + "\n";
+    }
     report += "Memory: " + std::to_string(m_memoryUsage / 1024 / 1024) + " MB\n";
+    report += GetMemoryReport();
+    if (m_pacingJitter.count > 0) {
+        report += "Pacing Jitter: " + std::to_string(GetAveragePacingJitter()) + " ms avg, " +
+                  FormatFrameTimeStats(GetPacingJitterStats()) + "\n";
+    }
     report += "Status: " + std::string(IsPerformanceGood() ? "Good" : "Needs Optimization");
     return report;
 }
+
+FrameTimeStats PerformanceMonitor::GetFrameTimeStats(const FrameTimeHistogram& histogram) {
+    FrameTimeStats stats;
+    stats.frames = histogram.GetCount();
+    stats.mean = (float)histogram.GetMean() / 1000.0f;
+    stats.p50 = histogram.GetQuantile(0.5) / 1000.0f;
+    stats.p90 = histogram.GetQuantile(0.9) / 1000.0f;
+    stats.p99 = histogram.GetQuantile(0.99) / 1000.0f;
+    stats.p999 = histogram.GetQuantile(0.999) / 1000.0f;
+    stats.max = histogram.GetMax() / 1000.0f;
+    return stats;
+}
+
+void PerformanceMonitor::SampleWindow::Add(uint32_t microseconds) {
+    // The oldest sample leaves the histogram, and the one FRAME_HISTORY_SIZE back leaves the average
+    if (count == FRAME_WINDOW_SIZE) {
+        histogram.Remove(ring[next]);
+    } else {
+        count++;
+    }
+    if (count > FRAME_HISTORY_SIZE) {
+        averageSum -= ring[(next + FRAME_WINDOW_SIZE - FRAME_HISTORY_SIZE) % FRAME_WINDOW_SIZE];
+    }
+    ring[next] = microseconds;
+    next = (next + 1) % FRAME_WINDOW_SIZE;
+    averageSum += microseconds;
+    histogram.Add(microseconds);
+}
+
+void PerformanceMonitor::SampleWindow::Clear() {
+    count = 0;
+    next = 0;
+    averageSum = 0;
+    histogram.Clear();
+}
+
+float PerformanceMonitor::SampleWindow::GetAverage() const {
+    return count > 0 ? averageSum / 1000.0f / std::min(count, FRAME_HISTORY_SIZE) : 0.0f;
+}
+
+std::string PerformanceMonitor::FormatFrameTimeStats(const FrameTimeStats& stats) {
+    char text[160];
+    std::snprintf(text, sizeof(text), "p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f ms",
+                  stats.p50, stats.p90, stats.p99, stats.p999, stats.max);
+    return text;
+}
+
+std::string PerformanceMonitor::FormatBytes(size_t bytes) {
+    char text[32];
+    if (bytes >= 1024 * 1024) {
+        std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+    } else {
+        std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+    }
+    return text;
+}
+
+std::string PerformanceMonitor::GetMemoryReport() const {
+    std::string report;
+    if (m_processMemory.residentBytes > 0) {
+        report += "Process Memory: " + FormatBytes(m_processMemory.residentBytes) + " resident, " +
+                  FormatBytes(m_processMemory.privateBytes) + " private, " +
+                  FormatBytes(m_processMemory.proportionalBytes) + " proportional, " +
+                  FormatBytes(m_processMemory.swapBytes) + " swapped\n";
+    }
+
+    // Only subsystems that have allocated anything
+    const MemoryTracker& tracker = MemoryTracker::Get();
+    if (tracker.GetPeakTotalGpuUsage() > 0) {
+        report += "GPU Memory: " + FormatBytes(tracker.GetTotalGpuUsage()) + " (peak " +
+                  FormatBytes(tracker.GetPeakTotalGpuUsage()) + ")\n";
+        for (int i = 0; i < (int)MemoryCategory::Count; i++) {
+            MemoryCategory category = (MemoryCategory)i;
+            if (tracker.GetPeakGpuUsage(category) == 0) continue;
+            report += std::string("  ") + MemoryTracker::GetCategoryName(category) + ": " +
+                      FormatBytes(tracker.GetGpuUsage(category)) + " (peak " + FormatBytes(tracker.GetPeakGpuUsage(category)) + ")\n";
+        }
+    }
+    return report;
+}
@@ -5,6 +5,20 @@
 #include <string>
 #include <map>
 #include <GL/glew.h>
+#include "FrameTimeHistogram.h"
+#include "GpuProfiler.h"
+#include "MemoryTracker.h"
+
+// Frame time distribution in ms
+struct FrameTimeStats {
+    uint64_t frames = 0;
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p90 = 0.0f;
+    float p99 = 0.0f;
+    float p999 = 0.0f;
+    float max = 0.0f;
+};
 
 class PerformanceMonitor {
 public:
@@ -19,15 +33,37 @@ public:
     float GetAverageFPS() const { return m_averageFPS; }
     float GetAverageFrameTime() const { return m_averageFrameTime; }
 
-    // GPU timing
-    void BeginGPUTimer(const std::string& name);
-    void EndGPUTimer(const std::string& name);
-    float GetGPUTime(const std::string& name) const;
+    // Frame time percentiles over the last FRAME_WINDOW_SIZE frames and the
+    // whole session (since the last ResetStatistics())
+    FrameTimeStats GetWindowFrameTimeStats() const { return GetFrameTimeStats(m_frameTimes.histogram); }
+    FrameTimeStats GetSessionFrameTimeStats() const { return GetFrameTimeStats(m_sessionHistogram); }
 
-    // Memory monitoring
+    // GPU timing. Timers may nest and must end in reverse order. Results
+    // arrive a few frames late without stalling; GetGPUTime() reports the
+    // frame GetGPUTimeFrame() (0 = the first BeginFrame()). Names are kept
+    // by pointer until the results arrive, so pass string literals.
+    void BeginGPUTimer(const char* name);
+    void EndGPUTimer(const char* name);
+    float GetGPUTime(const char* name) const;
+    uint64_t GetGPUTimeFrame() const { return m_gpuProfiler.GetResultFrame(); }
+    const GpuProfiler& GetGpuProfiler() const { return m_gpuProfiler; }
+
+    // Frame pacing: the average covers the newest 60 frames, the distribution
+    // and max the same window as the frame time percentiles
+    void RecordPacingJitter(float jitter);
+    float GetAveragePacingJitter() const { return m_pacingJitter.GetAverage(); }
+    float GetMaxPacingJitter() const { return m_pacingJitter.histogram.GetMax() / 1000.0f; }
+    FrameTimeStats GetPacingJitterStats() const { return GetFrameTimeStats(m_pacingJitter.histogram); }
+
+    // Memory monitoring. UpdateMemoryUsage() reads the process counters
+    // (a few /proc reads on Linux, so not every frame); GPU figures are the
+    // engine's own allocations as reported to MemoryTracker.
     void UpdateMemoryUsage();
-    size_t GetMemoryUsage() const { return m_memoryUsage; }
+    size_t GetMemoryUsage() const { return m_memoryUsage; }          // resident bytes
     size_t GetPeakMemoryUsage() const { return m_peakMemoryUsage; }
+    const ProcessMemoryInfo& GetProcessMemory() const { return m_processMemory; }
+    size_t GetGpuMemoryUsage() const { return MemoryTracker::Get().GetTotalGpuUsage(); }
+    size_t GetPeakGpuMemoryUsage() const { return MemoryTracker::Get().GetPeakTotalGpuUsage(); }
 
     // Performance statistics
     void ResetStatistics();
@@ -46,21 +82,48 @@ private:
     float m_averageFPS;
     float m_averageFrameTime;
     
-    // Frame history for averaging
-    std::vector<float> m_frameTimeHistory;
-    static const size_t FRAME_HISTORY_SIZE = 60;
+    // Per-frame samples in us, a ring over the percentile window feeding its
+    // histogram; the average uses the newest FRAME_HISTORY_SIZE
+    static constexpr size_t FRAME_HISTORY_SIZE = 60;
+    static constexpr size_t FRAME_WINDOW_SIZE = 1024;
+    struct SampleWindow {
+        uint32_t ring[FRAME_WINDOW_SIZE];
+        size_t count = 0;          // samples in the ring
+        size_t next = 0;           // slot the next sample goes to
+        uint64_t averageSum = 0;   // sum of the newest FRAME_HISTORY_SIZE samples
+        FrameTimeHistogram histogram;
+
+        void Add(uint32_t microseconds);
+        void Clear();
+        float GetAverage() const;  // ms
+    };
+
+    SampleWindow m_frameTimes;
+    FrameTimeHistogram m_sessionHistogram;
     
     // GPU timing
-    std::map<std::string, GLuint> m_queryObjects;
-    std::map<std::string, bool> m_timerActive;
-    std::map<std::string, float> m_gpuTimes;
+    GpuProfiler m_gpuProfiler;
+    std::vector<const char*> m_gpuTimerStack;  // open timers, innermost last
+    uint64_t m_gpuResultFrame;                 // frame m_gpuTimes was taken from
+    // std::less<> looks names up without building a std::string
+    std::map<std::string, float, std::less<>> m_gpuTimes;
+
+    // Frame pacing jitter, kept like the frame times
+    SampleWindow m_pacingJitter;
     
     // Memory monitoring
     size_t m_memoryUsage;
     size_t m_peakMemoryUsage;
+    ProcessMemoryInfo m_processMemory;
     
     // Performance thresholds
     static const float TARGET_FPS;
     static const float MIN_FPS;
     static const float MAX_FRAME_TIME;
+
+    // Helper methods
+    static FrameTimeStats GetFrameTimeStats(const FrameTimeHistogram& histogram);
+    static std::string FormatFrameTimeStats(const FrameTimeStats& stats);
+    static std::string FormatBytes(size_t bytes);
+    std::string GetMemoryReport() const;
 };
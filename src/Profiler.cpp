@@ -0,0 +1,203 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    // Per-thread state: the ring this thread writes and its zone nesting depth
+    thread_local void* t_buffer = nullptr;
+    thread_local uint32_t t_depth = 0;
+}
+
+Profiler::Profiler()
+    : m_enabled(true), m_frameStart(0), m_frameEnd(0), m_nodeCount(0) {
+    GetEpoch();
+}
+
+Profiler& Profiler::Get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+std::chrono::steady_clock::time_point Profiler::GetEpoch() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return epoch;
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+    ThreadBuffer* buffer = t_buffer ? static_cast<ThreadBuffer*>(t_buffer) : RegisterThread();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threadNames[buffer->thread] = name;
+}
+
+uint32_t Profiler::EnterZone() {
+    return t_depth++;
+}
+
+void Profiler::RecordZone(const char* name, uint64_t start, uint32_t depth) {
+    uint64_t end = Now();
+    t_depth = depth;
+
+    ThreadBuffer* buffer = t_buffer ? static_cast<ThreadBuffer*>(t_buffer) : RegisterThread();
+    uint64_t write = buffer->writeIndex.load(std::memory_order_relaxed);
+    if (write - buffer->readIndex.load(std::memory_order_acquire) >= BUFFER_CAPACITY) {
+        buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->zones[write % BUFFER_CAPACITY] = { name, start, end, depth, buffer->thread };
+    buffer->writeIndex.store(write + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame() {
+    uint64_t now = Now();
+    m_frameZones.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+            uint64_t read = buffer->readIndex.load(std::memory_order_relaxed);
+            uint64_t write = buffer->writeIndex.load(std::memory_order_acquire);
+            for (uint64_t i = read; i < write; i++) {
+                m_frameZones.push_back(buffer->zones[i % BUFFER_CAPACITY]);
+            }
+            buffer->readIndex.store(write, std::memory_order_release);
+        }
+        // Element-wise, so names that did not change keep their storage
+        m_frameThreadNames.resize(m_threadNames.size());
+        for (size_t i = 0; i < m_threadNames.size(); i++) {
+            m_frameThreadNames[i] = m_threadNames[i];
+        }
+    }
+
+    m_frameStart = m_frameEnd;
+    m_frameEnd = now;
+    BuildTree();
+}
+
+int Profiler::FindNode(int parent, const std::string& name) const {
+    if (parent < 0 || parent >= (int)m_nodeCount) return -1;
+    for (int child : m_tree[parent].children) {
+        if (m_tree[child].name == name) return child;
+    }
+    return -1;
+}
+
+size_t Profiler::GetDroppedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t dropped = 0;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+        dropped += buffer->droppedCount.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+std::string Profiler::GetFrameReport() const {
+    std::string report = "CPU Profile:\n";
+    if (m_nodeCount > 0) {
+        AppendReport(report, 0, 0);
+    }
+    return report;
+}
+
+Profiler::ThreadBuffer* Profiler::RegisterThread() {
+    // The ring is allocated once per thread, outside any zone's timing
+    std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+    buffer->zones.resize(BUFFER_CAPACITY);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->thread = (uint32_t)m_buffers.size();
+    m_threadNames.push_back("Thread " + std::to_string(buffer->thread));
+    m_buffers.push_back(std::move(buffer));
+    t_buffer = m_buffers.back().get();
+    return m_buffers.back().get();
+}
+
+void Profiler::BuildTree() {
+    m_nodeCount = 0;
+    AddNode(-1, "Frame");
+    m_tree[0].totalTime = m_frameEnd - m_frameStart;
+    m_tree[0].callCount = 1;
+
+    // Zones arrive grouped by thread in completion order (children first);
+    // sorted by start, each zone's parent is the last open zone one level up
+    auto byStart = [](const ProfileZone& lhs, const ProfileZone& rhs) {
+        return lhs.start != rhs.start ? lhs.start < rhs.start : lhs.depth < rhs.depth;
+    };
+    std::vector<int>& stack = m_stack;
+    size_t begin = 0;
+    while (begin < m_frameZones.size()) {
+        uint32_t thread = m_frameZones[begin].thread;
+        size_t end = begin;
+        while (end < m_frameZones.size() && m_frameZones[end].thread == thread) {
+            end++;
+        }
+        std::sort(m_frameZones.begin() + begin, m_frameZones.begin() + end, byStart);
+
+        stack.assign(1, GetChild(0, m_frameThreadNames[thread].c_str()));
+        for (size_t i = begin; i < end; i++) {
+            const ProfileZone& zone = m_frameZones[i];
+            // Zones whose parent is still open (or was dropped) attach to the deepest known ancestor
+            size_t level = std::min((size_t)zone.depth, stack.size() - 1);
+            stack.resize(level + 1);
+            int node = GetChild(stack.back(), zone.name);
+            m_tree[node].totalTime += zone.end - zone.start;
+            m_tree[node].callCount++;
+            stack.push_back(node);
+        }
+        begin = end;
+    }
+
+    // Thread totals are their top-level zones; self time is what children do not cover
+    for (int thread : m_tree[0].children) {
+        for (int child : m_tree[thread].children) {
+            m_tree[thread].totalTime += m_tree[child].totalTime;
+        }
+        m_tree[thread].callCount = 1;
+    }
+    for (size_t i = 0; i < m_nodeCount; i++) {
+        ProfileNode& node = m_tree[i];
+        uint64_t childTime = 0;
+        for (int child : node.children) {
+            childTime += m_tree[child].totalTime;
+        }
+        node.selfTime = node.totalTime > childTime ? node.totalTime - childTime : 0;
+    }
+}
+
+int Profiler::GetChild(int parent, const char* name) {
+    for (int child : m_tree[parent].children) {
+        if (std::strcmp(m_tree[child].name.c_str(), name) == 0) return child;
+    }
+
+    return AddNode(parent, name);
+}
+
+int Profiler::AddNode(int parent, const char* name) {
+    int node = (int)m_nodeCount++;
+    if (node == (int)m_tree.size()) {
+        m_tree.emplace_back();
+    }
+    ProfileNode& entry = m_tree[node];
+    entry.name = name;
+    entry.totalTime = 0;
+    entry.selfTime = 0;
+    entry.callCount = 0;
+    entry.parent = parent;
+    entry.children.clear();
+    if (parent >= 0) {
+        m_tree[parent].children.push_back(node);
+    }
+    return node;
+}
+
+void Profiler::AppendReport(std::string& report, int node, int indent) const {
+    const ProfileNode& entry = m_tree[node];
+    char line[160];
+    std::snprintf(line, sizeof(line), "%*s%-*s %8.3f ms  self %8.3f ms  x%u\n", indent * 2, "",
+                  std::max(40 - indent * 2, 1), entry.name.c_str(),
+                  entry.totalTime / 1.0e6, entry.selfTime / 1.0e6, entry.callCount);
+    report += line;
+    for (int child : entry.children) {
+        AppendReport(report, child, indent + 1);
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One completed zone, as recorded by the thread that ran it
+struct ProfileZone {
+    const char* name;   // string literal; never copied
+    uint64_t start;     // ns since the profiler started
+    uint64_t end;
+    uint32_t depth;     // zones open on the thread when this one began
+    uint32_t thread;    // registration order, 0 for the first thread seen
+};
+
+// Aggregated call tree node for one frame. Calls of the same zone under the
+// same parent are merged; self time is total time minus the children's.
+struct ProfileNode {
+    std::string name;
+    uint64_t totalTime = 0;  // ns
+    uint64_t selfTime = 0;   // ns
+    uint32_t callCount = 0;
+    int parent = -1;
+    std::vector<int> children;
+};
+
+// Hierarchical CPU profiler. PROFILE_SCOPE zones take two clock reads and
+// one write into the calling thread's ring buffer; only a thread's first
+// zone takes a lock (to register the buffer). EndFrame() drains every ring
+// and builds the frame's call tree: the root is the frame, its children
+// are the threads, and below them the zones as they nested. Compiling
+// without ENABLE_PROFILER turns PROFILE_SCOPE into nothing.
+class Profiler {
+public:
+    // Zones per thread between two EndFrame() calls; more are dropped and counted
+    static constexpr size_t BUFFER_CAPACITY = 16384;
+
+    static Profiler& Get();
+
+    // Nanoseconds since the profiler started
+    static uint64_t Now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - GetEpoch()).count();
+    }
+
+    // Runtime switch (zones compiled in still cost a branch when disabled)
+    void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // Name the calling thread in the call tree (default "Thread N")
+    void SetThreadName(const std::string& name);
+
+    // Called by ProfileScope; the depth counter belongs to the calling thread
+    static uint32_t EnterZone();
+    void RecordZone(const char* name, uint64_t start, uint32_t depth);
+
+    // Close the frame: drain all threads and rebuild the call tree
+    void EndFrame();
+    size_t GetNodeCount() const { return m_nodeCount; }
+    const ProfileNode& GetNode(int node) const { return m_tree[node]; }
+    // Raw zones of the last frame, grouped by thread
+    const std::vector<ProfileZone>& GetFrameZones() const { return m_frameZones; }
+    // Thread names as of the last EndFrame(), covering every thread in its zones
+    const std::string& GetThreadName(uint32_t thread) const { return m_frameThreadNames[thread]; }
+    size_t GetThreadCount() const { return m_frameThreadNames.size(); }
+    uint64_t GetFrameStart() const { return m_frameStart; }
+    uint64_t GetFrameEnd() const { return m_frameEnd; }
+    // Child of parent (0 = frame root) with this name, or -1
+    int FindNode(int parent, const std::string& name) const;
+    // Zones lost to full buffers (lifetime total)
+    size_t GetDroppedCount() const;
+
+    // Indented tree with total and self times in ms and call counts
+    std::string GetFrameReport() const;
+
+private:
+    struct ThreadBuffer {
+        std::vector<ProfileZone> zones;
+        std::atomic<uint64_t> writeIndex{0};  // advanced by the owning thread
+        std::atomic<uint64_t> readIndex{0};   // advanced by EndFrame()
+        std::atomic<size_t> droppedCount{0};
+        uint32_t thread = 0;
+    };
+
+    Profiler();
+
+    std::atomic<bool> m_enabled;
+
+    // Registered threads (the lock guards registration and draining only)
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::vector<std::string> m_threadNames;
+
+    // Last frame
+    uint64_t m_frameStart;
+    uint64_t m_frameEnd;
+    std::vector<ProfileZone> m_frameZones;
+    // Copied under the lock, since other threads may register meanwhile
+    std::vector<std::string> m_frameThreadNames;
+    // Nodes past m_nodeCount are kept from earlier frames so their names and
+    // child lists are rewritten in place instead of reallocated every frame
+    std::vector<ProfileNode> m_tree;
+    size_t m_nodeCount;
+    std::vector<int> m_stack;
+
+    // Helper methods
+    static std::chrono::steady_clock::time_point GetEpoch();
+    ThreadBuffer* RegisterThread();
+    void BuildTree();
+    int GetChild(int parent, const char* name);
+    int AddNode(int parent, const char* name);
+    void AppendReport(std::string& report, int node, int indent) const;
+};
+
+// Times the enclosing scope
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : m_name(nullptr), m_start(0), m_depth(0) {
+        if (Profiler::Get().IsEnabled()) {
+            m_name = name;
+            m_depth = Profiler::EnterZone();
+            m_start = Profiler::Now();
+        }
+    }
+
+    ~ProfileScope() {
+        if (m_name) {
+            Profiler::Get().RecordZone(m_name, m_start, m_depth);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_start;
+    uint32_t m_depth;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_PROFILER
+// name must be a string literal (or otherwise outlive the profiler)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,249 @@
+#include "Random.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RANDOM_USE_SSE 1
+#endif
+
+namespace {
+    uint64_t SplitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    inline uint32_t RotateLeft(uint32_t value, int bits) {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    const uint32_t PHILOX_M0 = 0xD2511F53u;
+    const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+    const uint32_t PHILOX_W0 = 0x9E3779B9u;
+    const uint32_t PHILOX_W1 = 0xBB67AE85u;
+    const int PHILOX_ROUNDS = 10;
+
+#ifdef RANDOM_USE_SSE
+    inline __m128 UIntToUnitFloat4(__m128i value) {
+        __m128i bits = _mm_or_si128(_mm_srli_epi32(value, 9), _mm_set1_epi32(0x3f800000));
+        return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+    }
+
+    // 32x32 -> 64 bit products of four lanes, split into high and low words
+    inline void MulHiLo4(__m128i a, __m128i multiplier, __m128i& hi, __m128i& lo) {
+        __m128i even = _mm_mul_epu32(a, multiplier);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), multiplier);
+        lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+    }
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Xoshiro128Plus
+
+Xoshiro128Plus::Xoshiro128Plus(uint64_t seed) {
+    Seed(seed);
+}
+
+void Xoshiro128Plus::Seed(uint64_t seed) {
+    uint64_t state = seed;
+    for (int lane = 0; lane < 4; lane++) {
+        uint64_t a = SplitMix64(state);
+        uint64_t b = SplitMix64(state);
+        m_s0[lane] = (uint32_t)a;
+        m_s1[lane] = (uint32_t)(a >> 32);
+        m_s2[lane] = (uint32_t)b;
+        m_s3[lane] = (uint32_t)(b >> 32);
+    }
+    m_outputIndex = 4;
+}
+
+uint32_t Xoshiro128Plus::NextUInt() {
+    if (m_outputIndex == 4) {
+        Step();
+    }
+    return m_output[m_outputIndex++];
+}
+
+float Xoshiro128Plus::NextFloat() {
+    return UIntToUnitFloat(NextUInt());
+}
+
+float Xoshiro128Plus::NextFloat(float min, float max) {
+    return min + NextFloat() * (max - min);
+}
+
+void Xoshiro128Plus::FillUniform(float* out, size_t count, float min, float max) {
+    const float range = max - min;
+    size_t i = 0;
+
+    // Finish the step already handed out partially
+    while (i < count && m_outputIndex < 4) {
+        out[i++] = NextFloat(min, max);
+    }
+
+    size_t blockEnd = i + (count - i) / 4 * 4;
+#ifdef RANDOM_USE_SSE
+    if (i < blockEnd) {
+        __m128i s0 = _mm_load_si128((const __m128i*)m_s0);
+        __m128i s1 = _mm_load_si128((const __m128i*)m_s1);
+        __m128i s2 = _mm_load_si128((const __m128i*)m_s2);
+        __m128i s3 = _mm_load_si128((const __m128i*)m_s3);
+        const __m128 minimum = _mm_set1_ps(min);
+        const __m128 scale = _mm_set1_ps(range);
+
+        __m128i result = _mm_setzero_si128();
+        for (; i < blockEnd; i += 4) {
+            result = _mm_add_epi32(s0, s3);
+            __m128i t = _mm_slli_epi32(s1, 9);
+            s2 = _mm_xor_si128(s2, s0);
+            s3 = _mm_xor_si128(s3, s1);
+            s1 = _mm_xor_si128(s1, s2);
+            s0 = _mm_xor_si128(s0, s3);
+            s2 = _mm_xor_si128(s2, t);
+            s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+            _mm_storeu_ps(out + i, _mm_add_ps(minimum, _mm_mul_ps(UIntToUnitFloat4(result), scale)));
+        }
+
+        _mm_store_si128((__m128i*)m_s0, s0);
+        _mm_store_si128((__m128i*)m_s1, s1);
+        _mm_store_si128((__m128i*)m_s2, s2);
+        _mm_store_si128((__m128i*)m_s3, s3);
+        _mm_store_si128((__m128i*)m_output, result);
+    }
+#else
+    for (; i < blockEnd; i += 4) {
+        Step();
+        for (int lane = 0; lane < 4; lane++) {
+            out[i + lane] = min + UIntToUnitFloat(m_output[lane]) * range;
+        }
+        m_outputIndex = 4;
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = NextFloat(min, max);
+    }
+}
+
+void Xoshiro128Plus::Step() {
+    for (int lane = 0; lane < 4; lane++) {
+        m_output[lane] = m_s0[lane] + m_s3[lane];
+        uint32_t t = m_s1[lane] << 9;
+        m_s2[lane] ^= m_s0[lane];
+        m_s3[lane] ^= m_s1[lane];
+        m_s1[lane] ^= m_s2[lane];
+        m_s0[lane] ^= m_s3[lane];
+        m_s2[lane] ^= t;
+        m_s3[lane] = RotateLeft(m_s3[lane], 11);
+    }
+    m_outputIndex = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Philox4x32
+
+Philox4x32::Philox4x32(uint64_t key) {
+    m_key[0] = (uint32_t)key;
+    m_key[1] = (uint32_t)(key >> 32);
+}
+
+void Philox4x32::Generate(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t product0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t product1 = (uint64_t)PHILOX_M1 * c2;
+        uint32_t next0 = (uint32_t)(product1 >> 32) ^ c1 ^ k0;
+        uint32_t next2 = (uint32_t)(product0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)product1;
+        c3 = (uint32_t)product0;
+        c0 = next0;
+        c2 = next2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+void Philox4x32::Generate(uint64_t counter, uint32_t out[4]) const {
+    const uint32_t words[4] = { (uint32_t)counter, (uint32_t)(counter >> 32), 0, 0 };
+    Generate(words, m_key, out);
+}
+
+uint32_t Philox4x32::UInt(uint64_t index) const {
+    uint32_t words[4];
+    Generate(index / 4, words);
+    return words[index % 4];
+}
+
+float Philox4x32::Uniform(uint64_t index) const {
+    return UIntToUnitFloat(UInt(index));
+}
+
+void Philox4x32::FillUniform(float* out, size_t count, float min, float max, uint64_t firstIndex) const {
+    const float range = max - min;
+    size_t i = 0;
+
+    // Scalar until the stream index is at a counter boundary
+    while (i < count && (firstIndex + i) % 4 != 0) {
+        out[i] = min + Uniform(firstIndex + i) * range;
+        i++;
+    }
+
+#ifdef RANDOM_USE_SSE
+    // Four counters per iteration, one per lane, transposed back to stream order
+    const __m128i m0 = _mm_set1_epi32((int)PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32((int)PHILOX_M1);
+    const __m128 minimum = _mm_set1_ps(min);
+    const __m128 scale = _mm_set1_ps(range);
+    for (; i + 16 <= count; i += 16) {
+        uint64_t counter = (firstIndex + i) / 4;
+        alignas(16) uint32_t low[4], high[4];
+        for (int lane = 0; lane < 4; lane++) {
+            low[lane] = (uint32_t)(counter + lane);
+            high[lane] = (uint32_t)((counter + lane) >> 32);
+        }
+
+        __m128i c0 = _mm_load_si128((const __m128i*)low);
+        __m128i c1 = _mm_load_si128((const __m128i*)high);
+        __m128i c2 = _mm_setzero_si128();
+        __m128i c3 = _mm_setzero_si128();
+        uint32_t k0 = m_key[0], k1 = m_key[1];
+        for (int round = 0; round < PHILOX_ROUNDS; round++) {
+            __m128i hi0, lo0, hi1, lo1;
+            MulHiLo4(c0, m0, hi0, lo0);
+            MulHiLo4(c2, m1, hi1, lo1);
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32((int)k0));
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32((int)k1));
+            c1 = lo1;
+            c3 = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        __m128 w0 = UIntToUnitFloat4(c0);
+        __m128 w1 = UIntToUnitFloat4(c1);
+        __m128 w2 = UIntToUnitFloat4(c2);
+        __m128 w3 = UIntToUnitFloat4(c3);
+        _MM_TRANSPOSE4_PS(w0, w1, w2, w3);
+        _mm_storeu_ps(out + i, _mm_add_ps(minimum, _mm_mul_ps(w0, scale)));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(minimum, _mm_mul_ps(w1, scale)));
+        _mm_storeu_ps(out + i + 8, _mm_add_ps(minimum, _mm_mul_ps(w2, scale)));
+        _mm_storeu_ps(out + i + 12, _mm_add_ps(minimum, _mm_mul_ps(w3, scale)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = min + Uniform(firstIndex + i) * range;
+    }
+}
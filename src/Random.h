@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Small, fast random number generators for particle emission. Both produce
+// floats as 23 random mantissa bits under a fixed exponent, and the batch
+// fills run the same integer and float operations as the scalar calls, so
+// a fill returns exactly what the equivalent sequence of calls would.
+
+// xoshiro128+ run as four independent lanes. The lanes step together, which
+// keeps the SSE2 batch path and the scalar path on one sequence: values are
+// handed out lane 0..3 of each step, in step order.
+class Xoshiro128Plus {
+public:
+    explicit Xoshiro128Plus(uint64_t seed = 0);
+
+    // Expands seed into the four lane states with SplitMix64
+    void Seed(uint64_t seed);
+
+    uint32_t NextUInt();
+    float NextFloat();                         // [0, 1)
+    float NextFloat(float min, float max);     // [min, max)
+
+    // Same values as count successive NextFloat(min, max) calls
+    void FillUniform(float* out, size_t count, float min, float max);
+
+private:
+    alignas(16) uint32_t m_s0[4];
+    alignas(16) uint32_t m_s1[4];
+    alignas(16) uint32_t m_s2[4];
+    alignas(16) uint32_t m_s3[4];
+    alignas(16) uint32_t m_output[4];  // current step, handed out in lane order
+    int m_outputIndex;
+
+    // Helper methods
+    void Step();
+};
+
+// Philox4x32-10 counter-based generator: the output is a pure function of
+// (key, counter), so any element of a stream can be computed independently
+// and threads can share a key without sharing state.
+class Philox4x32 {
+public:
+    explicit Philox4x32(uint64_t key = 0);
+
+    // Ten rounds over a 128-bit counter and 64-bit key
+    static void Generate(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+    // Four words for counter (counter words 2 and 3 are zero)
+    void Generate(uint64_t counter, uint32_t out[4]) const;
+
+    // Element index of the stream: word index % 4 of counter index / 4
+    uint32_t UInt(uint64_t index) const;
+    float Uniform(uint64_t index) const;                         // [0, 1)
+
+    // out[i] = min + Uniform(firstIndex + i) * (max - min)
+    void FillUniform(float* out, size_t count, float min, float max, uint64_t firstIndex = 0) const;
+
+private:
+    uint32_t m_key[2];
+};
+
+// Maps the top 23 bits to [0, 1) exactly as the SIMD paths do
+inline float UIntToUnitFloat(uint32_t value) {
+    union {
+        uint32_t bits;
+        float number;
+    } convert;
+    convert.bits = (value >> 9) | 0x3f800000u;
+    return convert.number - 1.0f;
+}
@@ -1,34 +1,14 @@
 #include "SceneManager.h"
+#include "AllocationTracker.h"
 #include "ShaderManager.h"
+#include "Object3D.h"
+#include "Light.h"
+#include "Mesh.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 
-// Forward declarations for basic classes
-class Object3D {
-public:
-    std::string name;
-    glm::vec3 position;
-    glm::vec3 rotation;
-    glm::vec3 scale;
-    glm::vec3 color;
-    
-    Object3D(const std::string& n, const glm::vec3& pos = glm::vec3(0.0f))
-        : name(n), position(pos), rotation(0.0f), scale(1.0f), color(1.0f) {}
-    
-    virtual void Update(float deltaTime) {}
-    virtual void Render(ShaderManager& shader) {}
-};
-
-class Light {
-public:
-    std::string name;
-    glm::vec3 position;
-    glm::vec3 color;
-    float intensity;
-    
-    Light(const std::string& n, const glm::vec3& pos, const glm::vec3& col, float intens = 1.0f)
-        : name(n), position(pos), color(col), intensity(intens) {}
-};
-
 SceneManager::SceneManager() : m_ambientLight(0.1f, 0.1f, 0.1f) {
 }
 
@@ -91,18 +71,54 @@ void SceneManager::RemoveLight(const std::string& name) {
 }
 
 void SceneManager::UpdateLighting(ShaderManager& shader) {
+    PROFILE_SCOPE("Lighting Uniforms");
+
     // Set ambient light
     shader.setVec3Value("ambientLight", m_ambientLight);
     
-    // Set directional light (sun)
-    if (!m_lights.empty()) {
-        auto& mainLight = m_lights[0];
-        shader.setVec3Value("lightDirection", -mainLight->position);
-        shader.setVec3Value("lightColor", mainLight->color);
+    // Set directional light (sun) and up to MAX_FORWARD_POINT_LIGHTS point lights;
+    // larger light counts go through ClusteredLighting instead
+    bool hasDirectional = false;
+    int numPointLights = 0;
+    for (const auto& light : m_lights) {
+        if (!light->enabled) continue;
+        
+        if (light->type == LightType::DIRECTIONAL && !hasDirectional) {
+            shader.setVec3Value("dirLight.direction", light->direction);
+            shader.setVec3Value("dirLight.ambient", light->ambient);
+            shader.setVec3Value("dirLight.diffuse", light->diffuse);
+            shader.setVec3Value("dirLight.specular", light->specular);
+            shader.setFloatValue("dirLight.intensity", light->intensity);
+            hasDirectional = true;
+        } else if (light->type == LightType::POINT && numPointLights < MAX_FORWARD_POINT_LIGHTS) {
+            // Uniform names built on the stack; this runs for every light every frame
+            char name[48];
+            auto field = [&name, numPointLights](const char* member) {
+                std::snprintf(name, sizeof(name), "pointLights[%d].%s", numPointLights, member);
+                return name;
+            };
+            shader.setVec3Value(field("position"), light->position);
+            shader.setVec3Value(field("ambient"), light->ambient);
+            shader.setVec3Value(field("diffuse"), light->diffuse);
+            shader.setVec3Value(field("specular"), light->specular);
+            shader.setFloatValue(field("constant"), light->constant);
+            shader.setFloatValue(field("linear"), light->linear);
+            shader.setFloatValue(field("quadratic"), light->quadratic);
+            shader.setFloatValue(field("intensity"), light->intensity);
+            numPointLights++;
+        }
+    }
+    
+    if (!hasDirectional) {
+        shader.setFloatValue("dirLight.intensity", 0.0f);
     }
+    shader.setIntValue("numPointLights", numPointLights);
 }
 
 void SceneManager::Update(float deltaTime) {
+    PROFILE_SCOPE("SceneManager::Update");
+    ALLOCATION_TAG("Scene");
+
     // Update all objects
     for (auto& object : m_objects) {
         object->Update(deltaTime);
@@ -110,11 +126,14 @@ void SceneManager::Update(float deltaTime) {
     
     // Update lights (if they need animation)
     for (auto& light : m_lights) {
-        // Light animation could go here
+        light->Update(deltaTime);
     }
 }
 
 void SceneManager::Render(ShaderManager& shader) {
+    PROFILE_SCOPE("SceneManager::Render");
+    ALLOCATION_TAG("Scene");
+
     // Update lighting uniforms
     UpdateLighting(shader);
     
@@ -124,6 +143,16 @@ void SceneManager::Render(ShaderManager& shader) {
     }
 }
 
+void SceneManager::RenderDepth(ShaderManager& shader) {
+    PROFILE_SCOPE("SceneManager::RenderDepth");
+    ALLOCATION_TAG("Scene");
+
+    // Depth-only pass: no lighting or material uniforms
+    for (auto& object : m_objects) {
+        object->RenderDepth(shader);
+    }
+}
+
 void SceneManager::SetAmbientLight(const glm::vec3& color) {
     m_ambientLight = color;
 }
@@ -131,26 +160,38 @@ void SceneManager::SetAmbientLight(const glm::vec3& color) {
 void SceneManager::CreateDefaultScene() {
     std::cout << "Creating default scene..." << std::endl;
     
+    // Shared primitive meshes (uploaded on first draw)
+    auto boxMesh = Mesh::CreateBox();
+    auto cylinderMesh = Mesh::CreateCylinder();
+    
     // Create a simple floor
-    auto floor = std::make_shared<Object3D>("floor", glm::vec3(0.0f, -1.0f, 0.0f));
-    floor->scale = glm::vec3(10.0f, 0.1f, 10.0f);
+    auto floor = std::make_shared<Object3D>("floor");
+    floor->SetPosition(glm::vec3(0.0f, -1.0f, 0.0f));
+    floor->SetScale(glm::vec3(10.0f, 0.1f, 10.0f));
+    floor->mesh = boxMesh;
     floor->color = glm::vec3(0.5f, 0.5f, 0.5f);
     AddObject(floor);
     
     // Create a cube
-    auto cube = std::make_shared<Object3D>("cube", glm::vec3(0.0f, 0.0f, 0.0f));
+    auto cube = std::make_shared<Object3D>("cube");
+    cube->SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+    cube->mesh = boxMesh;
     cube->color = glm::vec3(1.0f, 0.0f, 0.0f);
     AddObject(cube);
     
     // Create a laptop object
-    auto laptop = std::make_shared<Object3D>("laptop", glm::vec3(2.0f, 0.0f, 0.0f));
-    laptop->scale = glm::vec3(1.5f, 0.1f, 1.0f);
+    auto laptop = std::make_shared<Object3D>("laptop");
+    laptop->SetPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+    laptop->SetScale(glm::vec3(1.5f, 0.1f, 1.0f));
+    laptop->mesh = boxMesh;
     laptop->color = glm::vec3(0.2f, 0.2f, 0.2f);
     AddObject(laptop);
     
     // Create a cylinder
-    auto cylinder = std::make_shared<Object3D>("cylinder", glm::vec3(-2.0f, 0.0f, 0.0f));
-    cylinder->scale = glm::vec3(0.5f, 1.0f, 0.5f);
+    auto cylinder = std::make_shared<Object3D>("cylinder");
+    cylinder->SetPosition(glm::vec3(-2.0f, 0.0f, 0.0f));
+    cylinder->SetScale(glm::vec3(0.5f, 1.0f, 0.5f));
+    cylinder->mesh = cylinderMesh;
     cylinder->color = glm::vec3(0.0f, 1.0f, 0.0f);
     AddObject(cylinder);
 }
@@ -159,10 +200,16 @@ void SceneManager::SetupLighting() {
     std::cout << "Setting up lighting..." << std::endl;
     
     // Add directional light (sun)
-    auto sunLight = std::make_shared<Light>("sun", glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 0.9f), 1.0f);
+    auto sunLight = std::make_shared<Light>("sun", LightType::DIRECTIONAL);
+    sunLight->SetDirection(glm::vec3(-1.0f, -1.0f, -1.0f));
+    sunLight->SetColor(glm::vec3(1.0f, 1.0f, 0.9f));
+    sunLight->SetIntensity(1.0f);
     AddLight(sunLight);
     
     // Add point light
-    auto pointLight = std::make_shared<Light>("pointLight", glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 0.5f, 0.5f), 0.8f);
+    auto pointLight = std::make_shared<Light>("pointLight", LightType::POINT);
+    pointLight->SetPosition(glm::vec3(0.0f, 2.0f, 0.0f));
+    pointLight->SetColor(glm::vec3(1.0f, 0.5f, 0.5f));
+    pointLight->SetIntensity(0.8f);
     AddLight(pointLight);
 }
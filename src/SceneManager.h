@@ -23,15 +23,18 @@ public:
     void AddObject(std::shared_ptr<Object3D> object);
     void RemoveObject(const std::string& name);
     std::shared_ptr<Object3D> GetObject(const std::string& name);
+    const std::vector<std::shared_ptr<Object3D>>& GetObjects() const { return m_objects; }
     
     // Lighting
     void AddLight(std::shared_ptr<Light> light);
     void RemoveLight(const std::string& name);
     void UpdateLighting(ShaderManager& shader);
+    const std::vector<std::shared_ptr<Light>>& GetLights() const { return m_lights; }
 
     // Update and render
     void Update(float deltaTime);
     void Render(ShaderManager& shader);
+    void RenderDepth(ShaderManager& shader);
 
     // Scene properties
     void SetAmbientLight(const glm::vec3& color);
@@ -42,6 +45,9 @@ private:
     std::vector<std::shared_ptr<Light>> m_lights;
     glm::vec3 m_ambientLight;
     
+    // Point lights uploaded as plain uniforms (lighting.glsl pointLights[])
+    static const int MAX_FORWARD_POINT_LIGHTS = 4;
+    
     // Scene setup
     void CreateDefaultScene();
     void SetupLighting();
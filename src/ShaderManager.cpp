@@ -117,3 +117,81 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 }
 
 
+/***********************************************************
+ *  LoadTransformFeedbackShader()
+ *
+ *  This method is called to load a vertex shader whose
+ *  outputs are written back into buffers with transform
+ *  feedback. The varyings are captured interleaved, in the
+ *  order given, so they must match the buffer layout.
+ ***********************************************************/
+GLuint ShaderManager::LoadTransformFeedbackShader(const char * vertex_file_path, const char * const * varyings, int varyingCount){
+
+	// Read the Vertex Shader code from the file
+	std::string VertexShaderCode;
+	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
+	if(VertexShaderStream.is_open()){
+		std::stringstream sstr;
+		sstr << VertexShaderStream.rdbuf();
+		VertexShaderCode = sstr.str();
+		VertexShaderStream.close();
+	}else{
+		printf("Impossible to open %s.\n", vertex_file_path);
+		return 0;
+	}
+
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	// Compile Vertex Shader
+	printf("Compiling shader : %s...", vertex_file_path);
+	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	char const * VertexSourcePointer = VertexShaderCode.c_str();
+	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
+	glCompileShader(VertexShaderID);
+
+	// Check Vertex Shader
+	glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
+		printf("\n%s\n", &VertexShaderErrorMessage[0]);
+	}
+	if ( Result != GL_TRUE ){
+		glDeleteShader(VertexShaderID);
+		return 0;
+	}
+
+	printf("success\n");
+
+	// Captured outputs must be declared before linking
+	printf("Linking transform feedback program...");
+	GLuint ProgramID = glCreateProgram();
+	glAttachShader(ProgramID, VertexShaderID);
+	glTransformFeedbackVaryings(ProgramID, varyingCount, varyings, GL_INTERLEAVED_ATTRIBS);
+	glLinkProgram(ProgramID);
+
+	// Check the program
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
+		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		printf("\n%s\n", &ProgramErrorMessage[0]);
+	}
+
+	glDetachShader(ProgramID, VertexShaderID);
+	glDeleteShader(VertexShaderID);
+
+	if ( Result != GL_TRUE ){
+		glDeleteProgram(ProgramID);
+		return 0;
+	}
+
+	printf("success\n");
+
+	m_programID = ProgramID;
+	return ProgramID;
+}
+
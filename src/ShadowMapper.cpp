@@ -1,4 +1,5 @@
 #include "ShadowMapper.h"
+#include "MemoryTracker.h"
 #include "ShaderManager.h"
 #include <iostream>
 
@@ -34,6 +35,7 @@ void ShadowMapper::Cleanup() {
     }
     if (m_shadowMap) {
         glDeleteTextures(1, &m_shadowMap);
+        MemoryTracker::Get().ReleaseTexture(m_shadowMap);
     }
 }
 
@@ -89,6 +91,7 @@ void ShadowMapper::SetShadowMapSize(int width, int height) {
     // Recreate shadow map with new size
     if (m_shadowMap) {
         glDeleteTextures(1, &m_shadowMap);
+        MemoryTracker::Get().ReleaseTexture(m_shadowMap);
     }
     if (m_shadowFBO) {
         glDeleteFramebuffers(1, &m_shadowFBO);
@@ -117,6 +120,8 @@ void ShadowMapper::SetupShadowFramebuffer() {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 
                  m_shadowWidth, m_shadowHeight, 0, 
                  GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    MemoryTracker::Get().TrackTexture(m_shadowMap, MemoryTracker::GetTextureSize(m_shadowWidth, m_shadowHeight, GL_DEPTH_COMPONENT),
+                                      MemoryCategory::Shadows);
     
     // Set texture parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
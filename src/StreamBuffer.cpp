@@ -0,0 +1,171 @@
+#include "StreamBuffer.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // Fence waits are expected to be rare and short; give up after a second
+    const GLuint64 FENCE_TIMEOUT = 1000000000ull;
+}
+
+StreamBuffer::StreamBuffer()
+    : m_buffer(0), m_mappedData(nullptr), m_persistent(false),
+      m_segmentSize(0), m_segment(0), m_segmentStart(0), m_head(0), m_requiredSize(0),
+      m_overflowCount(0), m_reallocationCount(0), m_fenceWaitCount(0) {
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        m_fences[i] = nullptr;
+    }
+}
+
+StreamBuffer::~StreamBuffer() {
+    Cleanup();
+}
+
+bool StreamBuffer::Initialize(size_t segmentSize) {
+    std::cout << "Initializing Stream Buffer..." << std::endl;
+
+    m_segmentSize = segmentSize;
+    m_persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    CreateStorage();
+
+    if (!m_buffer) {
+        std::cout << "ERROR: Failed to create stream buffer!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void StreamBuffer::Cleanup() {
+    DeleteStorage();
+}
+
+void StreamBuffer::BeginFrame() {
+    if (!m_buffer) return;
+
+    // Grow once if last frame ran out of space; this is the only reallocation
+    if (m_requiredSize > m_segmentSize) {
+        for (int i = 0; i < SEGMENT_COUNT; i++) {
+            WaitForFence(i);
+        }
+        DeleteStorage();
+        m_segmentSize = AlignOffset(m_requiredSize + m_requiredSize / 2, 256);
+        CreateStorage();
+        m_reallocationCount++;
+    }
+    m_requiredSize = 0;
+
+    m_segment = (m_segment + 1) % SEGMENT_COUNT;
+    WaitForFence(m_segment);
+
+    m_segmentStart = m_segment * m_segmentSize;
+    m_head = m_segmentStart;
+}
+
+void StreamBuffer::EndFrame() {
+    if (!m_buffer) return;
+
+    m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamBuffer::Allocation StreamBuffer::Allocate(size_t size, size_t alignment) {
+    Allocation allocation = { nullptr, 0, size };
+    if (!m_buffer || size == 0) return allocation;
+
+    size_t offset = AlignOffset(m_head, std::max<size_t>(alignment, 1));
+    if (offset + size > m_segmentStart + m_segmentSize) {
+        // Remember the demand so the next frame fits everything
+        m_requiredSize = std::max(m_requiredSize, offset + size - m_segmentStart);
+        m_overflowCount++;
+        return allocation;
+    }
+    m_head = offset + size;
+    allocation.offset = (GLintptr)offset;
+
+    if (m_persistent) {
+        allocation.data = m_mappedData + offset;
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        allocation.data = glMapBufferRange(GL_ARRAY_BUFFER, allocation.offset, (GLsizeiptr)size,
+                                           GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    }
+    return allocation;
+}
+
+void StreamBuffer::Commit(const Allocation& allocation) {
+    // Coherent persistent mappings need no flush
+    if (m_persistent || !allocation) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+size_t StreamBuffer::AlignOffset(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void StreamBuffer::CreateStorage() {
+    GLsizeiptr totalSize = (GLsizeiptr)(m_segmentSize * SEGMENT_COUNT);
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+    if (m_persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+        m_mappedData = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags);
+        if (!m_mappedData) {
+            // Fall back to per-allocation mapping on a fresh buffer
+            std::cout << "Warning: persistent mapping failed, using unsynchronized mapping" << std::endl;
+            glDeleteBuffers(1, &m_buffer);
+            m_persistent = false;
+            CreateStorage();
+            return;
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+    MemoryTracker::Get().TrackBuffer(m_buffer, (size_t)totalSize, MemoryCategory::Streaming);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_segment = 0;
+    m_segmentStart = 0;
+    m_head = 0;
+}
+
+void StreamBuffer::DeleteStorage() {
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        if (m_fences[i]) {
+            glDeleteSync(m_fences[i]);
+            m_fences[i] = nullptr;
+        }
+    }
+    if (m_buffer) {
+        if (m_mappedData) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            m_mappedData = nullptr;
+        }
+        glDeleteBuffers(1, &m_buffer);
+        MemoryTracker::Get().ReleaseBuffer(m_buffer);
+        m_buffer = 0;
+    }
+}
+
+void StreamBuffer::WaitForFence(int segment) {
+    GLsync fence = m_fences[segment];
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        // The GPU is still reading this segment; flush and block
+        m_fenceWaitCount++;
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+            std::cout << "Warning: stream buffer fence wait failed" << std::endl;
+        }
+    }
+
+    glDeleteSync(fence);
+    m_fences[segment] = nullptr;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+
+// Shared upload buffer for per-frame vertex data (particles, debug lines,
+// per-instance attributes). One GL buffer is split into SEGMENT_COUNT frame
+// segments; each frame sub-allocates linearly from its own segment and the
+// segment is fenced when the frame ends, so the CPU never writes memory the
+// GPU may still be reading and the driver never reallocates storage.
+//
+// With GL 4.4 / ARB_buffer_storage the buffer is mapped once, persistent and
+// coherent. On plain GL 3.3 each allocation is mapped unsynchronized instead;
+// the fences make that safe.
+//
+// Usage per frame: BeginFrame(), then Allocate() / write / Commit() / draw,
+// then EndFrame() after the last draw that reads the buffer.
+class StreamBuffer {
+public:
+    static constexpr int SEGMENT_COUNT = 3;
+
+    struct Allocation {
+        void* data;        // write pointer, nullptr if the segment is full
+        GLintptr offset;   // byte offset in GetBuffer()
+        size_t size;
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    StreamBuffer();
+    ~StreamBuffer();
+
+    // Initialization
+    bool Initialize(size_t segmentSize);
+    void Cleanup();
+
+    // Frame boundaries
+    void BeginFrame();
+    void EndFrame();
+
+    // Sub-allocate from the current segment; the offset is a multiple of alignment.
+    // The buffer can be replaced when it grows, so point attributes at
+    // GetBuffer() + offset for each draw rather than caching them in a VAO.
+    Allocation Allocate(size_t size, size_t alignment);
+    void Commit(const Allocation& allocation);
+
+    // Buffer information
+    GLuint GetBuffer() const { return m_buffer; }
+    size_t GetSegmentSize() const { return m_segmentSize; }
+    bool IsPersistent() const { return m_persistent; }
+
+    // Statistics
+    size_t GetFrameBytes() const { return m_head - m_segmentStart; }
+    size_t GetOverflowCount() const { return m_overflowCount; }
+    size_t GetReallocationCount() const { return m_reallocationCount; }
+    size_t GetFenceWaitCount() const { return m_fenceWaitCount; }
+
+    // Alignment helper (alignment need not be a power of two)
+    static size_t AlignOffset(size_t offset, size_t alignment);
+
+private:
+    GLuint m_buffer;
+    char* m_mappedData;
+    bool m_persistent;
+
+    size_t m_segmentSize;
+    int m_segment;
+    size_t m_segmentStart;
+    size_t m_head;
+    GLsync m_fences[SEGMENT_COUNT];
+
+    // Demand that did not fit this frame; the buffer grows at the next BeginFrame
+    size_t m_requiredSize;
+
+    size_t m_overflowCount;
+    size_t m_reallocationCount;
+    size_t m_fenceWaitCount;
+
+    // Helper methods
+    void CreateStorage();
+    void DeleteStorage();
+    void WaitForFence(int segment);
+};
@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+#include "AllocationTracker.h"
+#include <algorithm>
+
+namespace {
+    thread_local size_t t_threadIndex = 0;
+    thread_local bool t_insideTask = false;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_task(nullptr), m_count(0), m_grainSize(1), m_nextBatch(0), m_batchesRemaining(0),
+      m_batchCount(0), m_generation(0), m_allocationTag(AllocationTracker::UNTAGGED), m_busyWorkers(0), m_shutdown(false) {
+    if (threadCount == 0) {
+        unsigned hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task) {
+    if (count == 0) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    // Small jobs, no workers or nested calls: run inline
+    if (m_workers.empty() || count <= grainSize || t_insideTask) {
+        task(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_grainSize = grainSize;
+        m_batchCount = (count + grainSize - 1) / grainSize;
+        m_nextBatch.store(0, std::memory_order_relaxed);
+        m_batchesRemaining.store(m_batchCount, std::memory_order_relaxed);
+        m_busyWorkers = m_workers.size();
+        m_generation++;
+        m_allocationTag = AllocationTracker::GetCurrentTag();
+    }
+    m_wakeCondition.notify_all();
+
+    // The submitting thread helps out instead of idling
+    RunBatches();
+
+    // Wait for every worker to leave the job so the task reference stays valid
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] {
+        return m_busyWorkers == 0 && m_batchesRemaining.load(std::memory_order_acquire) == 0;
+    });
+    m_task = nullptr;
+}
+
+size_t ThreadPool::GetCurrentThreadIndex() {
+    return t_threadIndex;
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    t_threadIndex = index;
+    unsigned lastGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [this, lastGeneration] {
+                return m_shutdown || m_generation != lastGeneration;
+            });
+            if (m_shutdown) return;
+            lastGeneration = m_generation;
+        }
+
+        {
+            AllocationScope allocationScope(m_allocationTag);
+            RunBatches();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busyWorkers--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::RunBatches() {
+    while (true) {
+        size_t batch = m_nextBatch.fetch_add(1, std::memory_order_relaxed);
+        if (batch >= m_batchCount) break;
+
+        size_t begin = batch * m_grainSize;
+        size_t end = std::min(begin + m_grainSize, m_count);
+        t_insideTask = true;
+        (*m_task)(begin, end);
+        t_insideTask = false;
+
+        m_batchesRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
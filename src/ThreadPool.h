@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool used by the CPU-heavy subsystems (light binning,
+// particle updates). The calling thread always takes part in the work, so a
+// pool created with zero workers degrades to a plain serial loop.
+class ThreadPool {
+public:
+    // threadCount == 0 picks hardware_concurrency() - 1 workers
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Split [0, count) into batches of at most grainSize items and run
+    // task(begin, end) on them. Blocks until every batch has finished.
+    // Calls made from inside a running task execute inline, so a subsystem
+    // that parallelizes internally can itself be run from a ParallelFor.
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task);
+
+    // Number of threads that can run tasks, including the caller
+    size_t GetThreadCount() const { return m_workers.size() + 1; }
+
+    // 0 for the thread that called ParallelFor, 1..N for pool workers.
+    // Lets callers index per-thread scratch storage without locking.
+    static size_t GetCurrentThreadIndex();
+
+    // Process-wide pool shared by the engine subsystems
+    static ThreadPool& GetShared();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+
+    // Current job
+    const std::function<void(size_t, size_t)>* m_task;
+    size_t m_count;
+    size_t m_grainSize;
+    std::atomic<size_t> m_nextBatch;
+    std::atomic<size_t> m_batchesRemaining;
+    size_t m_batchCount;
+    unsigned m_generation;
+    int m_allocationTag;      // submitter's allocation tag, inherited by the workers
+    size_t m_busyWorkers;
+    bool m_shutdown;
+
+    // Serializes ParallelFor calls from different threads
+    std::mutex m_submitMutex;
+
+    void WorkerLoop(size_t index);
+    void RunBatches();
+};
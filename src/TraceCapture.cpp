@@ -0,0 +1,258 @@
+#include "TraceCapture.h"
+#include "GpuProfiler.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // Trace Event timestamps are microseconds; keep the nanoseconds as decimals
+    void WriteMicroseconds(std::ostream& stream, uint64_t nanoseconds) {
+        char digits[4] = {
+            (char)('0' + nanoseconds % 1000 / 100),
+            (char)('0' + nanoseconds % 100 / 10),
+            (char)('0' + nanoseconds % 10),
+            '\0'
+        };
+        stream << nanoseconds / 1000 << '.' << digits;
+    }
+}
+
+TraceCapture::TraceCapture()
+    : m_state(State::Idle), m_framesLeft(0), m_gpuWaitFrames(0),
+      m_triggerThreshold(0.0f), m_triggerFrameCount(DEFAULT_FRAME_COUNT),
+      m_hasGpuFrames(false), m_firstGpuFrame(0), m_lastGpuFrame(0),
+      m_hasGpuResult(false), m_lastGpuResultFrame(0),
+      m_writing(false), m_writeSucceeded(false), m_captureCount(0) {
+    for (FrameStart& frameStart : m_frameStarts) {
+        frameStart = { UINT64_MAX, 0 };
+    }
+    m_frameCounters.reserve(16);
+}
+
+TraceCapture::~TraceCapture() {
+    WaitForWriter();
+}
+
+bool TraceCapture::Start(int frameCount, const std::string& filePath) {
+    if (IsCapturing()) {
+        std::cout << "Warning: A trace capture is already running!" << std::endl;
+        return false;
+    }
+    if (IsWriting()) {
+        std::cout << "Warning: The previous trace is still being written!" << std::endl;
+        return false;
+    }
+    if (frameCount <= 0) {
+        std::cout << "ERROR: Trace capture needs at least one frame!" << std::endl;
+        return false;
+    }
+    WaitForWriter();
+
+    m_filePath = filePath.empty() ? "trace_" + std::to_string(m_captureCount) + ".json" : filePath;
+    m_trace = Trace();
+    m_trace.frames.reserve(frameCount);
+    m_state = State::Recording;
+    m_framesLeft = frameCount;
+    m_gpuWaitFrames = 0;
+    m_hasGpuFrames = false;
+    std::cout << "Capturing " << frameCount << " frames to " << m_filePath << std::endl;
+    return true;
+}
+
+void TraceCapture::SetFrameTimeTrigger(float thresholdMs, int frameCount, const std::string& filePath) {
+    m_triggerThreshold = thresholdMs > 0.0f ? thresholdMs : 0.0f;
+    m_triggerFrameCount = frameCount;
+    m_triggerFilePath = filePath;
+}
+
+void TraceCapture::SetCounter(const char* name, float value) {
+    m_frameCounters.emplace_back(name, value);
+}
+
+void TraceCapture::EndFrame(const Profiler& profiler, const GpuProfiler* gpuProfiler) {
+    // Remember where the GPU frame that just ended started on the CPU timeline
+    bool gpuActive = gpuProfiler && gpuProfiler->IsInitialized() && gpuProfiler->GetFrameNumber() > 0;
+    uint64_t gpuFrame = gpuActive ? gpuProfiler->GetFrameNumber() - 1 : 0;
+    if (gpuActive) {
+        m_frameStarts[gpuFrame % FRAME_HISTORY] = { gpuFrame, profiler.GetFrameStart() };
+    }
+
+    // A slow frame starts a capture that includes it
+    float frameTime = (profiler.GetFrameEnd() - profiler.GetFrameStart()) / 1000000.0f;
+    if (m_triggerThreshold > 0.0f && frameTime > m_triggerThreshold && !IsCapturing() && !IsWriting()) {
+        std::cout << "Frame took " << frameTime << " ms (trigger " << m_triggerThreshold << " ms)" << std::endl;
+        m_triggerThreshold = 0.0f;
+        Start(m_triggerFrameCount, m_triggerFilePath);
+    }
+
+    if (m_state == State::Recording) {
+        RecordFrame(profiler);
+        if (gpuActive) {
+            if (!m_hasGpuFrames) {
+                m_firstGpuFrame = gpuFrame;
+                m_hasGpuFrames = true;
+            }
+            m_lastGpuFrame = gpuFrame;
+        }
+        if (--m_framesLeft == 0) {
+            m_state = State::WaitingForGpu;
+        }
+    }
+    m_frameCounters.clear();
+
+    if (gpuActive && IsCapturing()) {
+        RecordGpuResults(*gpuProfiler);
+    }
+
+    // GPU results trail by a few frames; skipped frames never arrive, so the wait is bounded
+    if (m_state == State::WaitingForGpu) {
+        bool gpuDone = !m_hasGpuFrames || (m_hasGpuResult && m_lastGpuResultFrame >= m_lastGpuFrame);
+        if (gpuDone || ++m_gpuWaitFrames > GpuProfiler::FRAME_LATENCY) {
+            Finish();
+        }
+    }
+}
+
+void TraceCapture::WaitForWriter() {
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+void TraceCapture::RecordFrame(const Profiler& profiler) {
+    const std::vector<ProfileZone>& zones = profiler.GetFrameZones();
+    if (m_trace.frames.empty()) {
+        // Size for the whole capture from its first frame to avoid regrowing mid-capture
+        m_trace.cpuZones.reserve((zones.size() + zones.size() / 4 + 16) * m_framesLeft);
+        m_trace.counters.reserve((m_frameCounters.size() + 1) * m_framesLeft);
+    }
+
+    m_trace.frames.push_back({ profiler.GetFrameStart(), profiler.GetFrameEnd() });
+    m_trace.cpuZones.insert(m_trace.cpuZones.end(), zones.begin(), zones.end());
+    for (size_t i = m_trace.threadNames.size(); i < profiler.GetThreadCount(); i++) {
+        m_trace.threadNames.push_back(profiler.GetThreadName((uint32_t)i));
+    }
+
+    // Counters are sampled at the frame's end
+    uint64_t time = profiler.GetFrameEnd();
+    m_trace.counters.push_back({ "Frame Time (ms)", time, (profiler.GetFrameEnd() - profiler.GetFrameStart()) / 1000000.0f });
+    for (const auto& counter : m_frameCounters) {
+        m_trace.counters.push_back({ counter.first, time, counter.second });
+    }
+}
+
+void TraceCapture::RecordGpuResults(const GpuProfiler& gpuProfiler) {
+    const std::vector<GpuZoneResult>& results = gpuProfiler.GetResults();
+    uint64_t resultFrame = gpuProfiler.GetResultFrame();
+    if (results.empty() || (m_hasGpuResult && resultFrame == m_lastGpuResultFrame)) return;
+    m_hasGpuResult = true;
+    m_lastGpuResultFrame = resultFrame;
+
+    if (!m_hasGpuFrames || resultFrame < m_firstGpuFrame || resultFrame > m_lastGpuFrame) return;
+    const FrameStart& frameStart = m_frameStarts[resultFrame % FRAME_HISTORY];
+    if (frameStart.gpuFrame != resultFrame) return;
+
+    // GPU timestamps are on the GPU clock; align the frame's first one with the CPU frame start
+    for (const GpuZoneResult& result : results) {
+        uint64_t start = frameStart.cpuStart + (uint64_t)(result.start * 1000000.0);
+        m_trace.gpuZones.push_back({ result.name, start, (uint64_t)(result.time * 1000000.0) });
+    }
+}
+
+void TraceCapture::Finish() {
+    m_state = State::Idle;
+    WaitForWriter();
+
+    m_lastFilePath = m_filePath;
+    m_captureCount++;
+    m_writing.store(true, std::memory_order_release);
+    m_writer = std::thread([this, trace = std::move(m_trace), path = m_filePath]() {
+        std::ofstream file(path);
+        bool succeeded = false;
+        if (!file.is_open()) {
+            std::cout << "ERROR: Failed to open trace file " << path << "!" << std::endl;
+        } else {
+            WriteJson(file, trace);
+            file.close();
+            succeeded = !file.fail();
+            if (succeeded) {
+                std::cout << "Trace written to " << path << " (" << trace.frames.size() << " frames, "
+                          << trace.cpuZones.size() << " CPU zones, " << trace.gpuZones.size() << " GPU zones)" << std::endl;
+            } else {
+                std::cout << "ERROR: Failed to write trace file " << path << "!" << std::endl;
+            }
+        }
+        m_writeSucceeded.store(succeeded, std::memory_order_release);
+        m_writing.store(false, std::memory_order_release);
+    });
+    m_trace = Trace();
+}
+
+void TraceCapture::WriteJson(std::ostream& stream, const Trace& trace) {
+    // Track ids: 0 = frames, 1..N = profiled threads, N + 1 = GPU
+    const size_t gpuTrack = trace.threadNames.size() + 1;
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Computational Graphics Project\"}}";
+    stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+    for (size_t i = 0; i < trace.threadNames.size(); i++) {
+        stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i + 1 << ",\"args\":{\"name\":\"";
+        WriteEscaped(stream, trace.threadNames[i].c_str());
+        stream << "\"}}";
+    }
+    if (!trace.gpuZones.empty()) {
+        stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << gpuTrack << ",\"args\":{\"name\":\"GPU\"}}";
+    }
+
+    for (size_t i = 0; i < trace.frames.size(); i++) {
+        stream << ",\n{\"name\":\"Frame " << i << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":";
+        WriteMicroseconds(stream, trace.frames[i].start);
+        stream << ",\"dur\":";
+        WriteMicroseconds(stream, trace.frames[i].end - trace.frames[i].start);
+        stream << "}";
+    }
+
+    for (const ProfileZone& zone : trace.cpuZones) {
+        stream << ",\n{\"name\":\"";
+        WriteEscaped(stream, zone.name);
+        stream << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread + 1 << ",\"ts\":";
+        WriteMicroseconds(stream, zone.start);
+        stream << ",\"dur\":";
+        WriteMicroseconds(stream, zone.end - zone.start);
+        stream << "}";
+    }
+
+    for (const GpuEvent& zone : trace.gpuZones) {
+        stream << ",\n{\"name\":\"";
+        WriteEscaped(stream, zone.name);
+        stream << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << gpuTrack << ",\"ts\":";
+        WriteMicroseconds(stream, zone.start);
+        stream << ",\"dur\":";
+        WriteMicroseconds(stream, zone.duration);
+        stream << "}";
+    }
+
+    for (const CounterSample& counter : trace.counters) {
+        stream << ",\n{\"name\":\"";
+        WriteEscaped(stream, counter.name);
+        stream << "\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+        WriteMicroseconds(stream, counter.time);
+        stream << ",\"args\":{\"value\":" << (std::isfinite(counter.value) ? counter.value : 0.0f) << "}}";
+    }
+
+    stream << "\n]}\n";
+}
+
+void TraceCapture::WriteEscaped(std::ostream& stream, const char* text) {
+    static const char hex[] = "0123456789abcdef";
+    for (const char* c = text; *c; c++) {
+        unsigned char character = (unsigned char)*c;
+        if (character == '"' || character == '\\') {
+            stream << '\\' << *c;
+        } else if (character < 0x20) {
+            stream << "\\u00" << hex[character >> 4] << hex[character & 15];
+        } else {
+            stream << *c;
+        }
+    }
+}
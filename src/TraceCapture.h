@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Profiler.h"
+
+class GpuProfiler;
+
+// Captures a run of frames from the CPU and GPU profilers and writes them as
+// Chrome Trace Event JSON, which chrome://tracing and ui.perfetto.dev open
+// directly. Every profiled thread gets its own track, GPU zones go on a
+// "GPU" track and per-frame counters become counter tracks. A capture starts
+// on request or when a frame exceeds a time threshold (the slow frame is
+// the first one captured). Frames are only copied while capturing; the JSON
+// is written on a background thread once the last frame's GPU results are
+// in, so writing does not land in the frames being recorded.
+class TraceCapture {
+public:
+    static constexpr int DEFAULT_FRAME_COUNT = 120;
+
+    // A capture's events, in profiler time (ns since the profiler started)
+    struct GpuEvent {
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+    };
+    struct CounterSample {
+        const char* name;
+        uint64_t time;
+        float value;
+    };
+    struct FrameRange {
+        uint64_t start;
+        uint64_t end;
+    };
+    struct Trace {
+        std::vector<std::string> threadNames;
+        std::vector<FrameRange> frames;
+        std::vector<ProfileZone> cpuZones;
+        std::vector<GpuEvent> gpuZones;
+        std::vector<CounterSample> counters;
+    };
+
+    TraceCapture();
+    ~TraceCapture();
+
+    // Capture the next frameCount frames (the frame ending at the next
+    // EndFrame() is the first). An empty path writes trace_<n>.json.
+    bool Start(int frameCount = DEFAULT_FRAME_COUNT, const std::string& filePath = "");
+    // Start a capture the next time a frame takes longer than thresholdMs.
+    // Fires once; set it again to re-arm. 0 disarms.
+    void SetFrameTimeTrigger(float thresholdMs, int frameCount = DEFAULT_FRAME_COUNT, const std::string& filePath = "");
+    float GetFrameTimeTrigger() const { return m_triggerThreshold; }
+
+    // Counter value for the frame being finished; name must be a string literal
+    void SetCounter(const char* name, float value);
+
+    // Call once per frame after Profiler::EndFrame(); gpuProfiler may be null.
+    // The trigger compares the profiler's frame (EndFrame to EndFrame).
+    void EndFrame(const Profiler& profiler, const GpuProfiler* gpuProfiler);
+
+    bool IsCapturing() const { return m_state != State::Idle; }
+    bool IsWriting() const { return m_writing.load(std::memory_order_acquire); }
+    // Block until the last capture is on disk
+    void WaitForWriter();
+
+    const std::string& GetLastFilePath() const { return m_lastFilePath; }
+    size_t GetCaptureCount() const { return m_captureCount; }
+    bool GetLastWriteSucceeded() const { return m_writeSucceeded.load(std::memory_order_acquire); }
+
+    // Trace Event JSON for a capture (used by the writer thread)
+    static void WriteJson(std::ostream& stream, const Trace& trace);
+
+private:
+    enum class State {
+        Idle,
+        Recording,      // copying CPU zones
+        WaitingForGpu   // CPU frames done, GPU results still in flight
+    };
+
+    // GPU frames are placed on the timeline at the CPU start of the frame that issued them
+    static constexpr int FRAME_HISTORY = 16;
+    struct FrameStart {
+        uint64_t gpuFrame;
+        uint64_t cpuStart;
+    };
+
+    State m_state;
+    int m_framesLeft;
+    int m_gpuWaitFrames;
+    std::string m_filePath;
+    Trace m_trace;
+
+    float m_triggerThreshold;
+    int m_triggerFrameCount;
+    std::string m_triggerFilePath;
+
+    std::vector<std::pair<const char*, float>> m_frameCounters;
+
+    FrameStart m_frameStarts[FRAME_HISTORY];
+    bool m_hasGpuFrames;            // GPU frames issued while recording
+    uint64_t m_firstGpuFrame;
+    uint64_t m_lastGpuFrame;
+    bool m_hasGpuResult;            // last result frame consumed
+    uint64_t m_lastGpuResultFrame;
+
+    std::thread m_writer;
+    std::atomic<bool> m_writing;
+    std::atomic<bool> m_writeSucceeded;
+    std::string m_lastFilePath;
+    size_t m_captureCount;
+
+    // Helper methods
+    void RecordFrame(const Profiler& profiler);
+    void RecordGpuResults(const GpuProfiler& gpuProfiler);
+    void Finish();
+    static void WriteEscaped(std::ostream& stream, const char* text);
+};
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "../src/Light.h"
+#include "../src/ClusteredLighting.h"
+
+class LightingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        clustering = std::make_unique<ClusteredLighting>();
+        clustering->SetProjection(45.0f, 1600, 900, 0.1f, 100.0f);
+    }
+
+    std::shared_ptr<Light> MakePointLight(const glm::vec3& position) {
+        auto light = std::make_shared<Light>("point", LightType::POINT);
+        light->SetPosition(position);
+        return light;
+    }
+
+    std::unique_ptr<ClusteredLighting> clustering;
+};
+
+TEST_F(LightingTest, DirectionalLightHasNoRange) {
+    Light light("sun", LightType::DIRECTIONAL);
+    EXPECT_FLOAT_EQ(light.GetRange(), 0.0f);
+}
+
+TEST_F(LightingTest, RangeMatchesAttenuationThreshold) {
+    Light light("point", LightType::POINT);
+    float threshold = 1.0f / 256.0f;
+    float range = light.GetRange(threshold);
+
+    EXPECT_GT(range, 0.0f);
+
+    // Attenuation at the range should equal the threshold
+    glm::vec3 atRange = light.position + glm::vec3(range, 0.0f, 0.0f);
+    EXPECT_NEAR(light.GetContribution(atRange).r, threshold, 1e-4f);
+}
+
+TEST_F(LightingTest, RangeShrinksWithStrongerAttenuation) {
+    Light weak("weak", LightType::POINT);
+    Light strong("strong", LightType::POINT);
+    strong.SetAttenuation(1.0f, 0.7f, 1.8f);
+
+    EXPECT_LT(strong.GetRange(), weak.GetRange());
+}
+
+TEST_F(LightingTest, LightBinnedIntoItsCluster) {
+    auto light = MakePointLight(glm::vec3(0.0f, 0.0f, -10.0f));
+    light->SetAttenuation(1.0f, 0.7f, 1.8f); // short range, ~12 units
+    std::vector<std::shared_ptr<Light>> lights = { light };
+
+    clustering->BuildClusters(lights, glm::mat4(1.0f));
+    EXPECT_EQ(clustering->GetLightCount(), 1u);
+
+    // Center of the screen at depth 10
+    int slice = clustering->GetDepthSlice(10.0f);
+    int center = clustering->GetClusterIndex(ClusteredLighting::CLUSTER_X / 2, ClusteredLighting::CLUSTER_Y / 2, slice);
+    ASSERT_EQ(clustering->GetClusterLightCount(center), 1u);
+    EXPECT_EQ(clustering->GetClusterLights(center)[0], 0u);
+
+    // Far corner of the frustum should not see it
+    int corner = clustering->GetClusterIndex(0, 0, ClusteredLighting::CLUSTER_Z - 1);
+    EXPECT_EQ(clustering->GetClusterLightCount(corner), 0u);
+}
+
+TEST_F(LightingTest, LightsBehindCameraAreCulled) {
+    auto light = MakePointLight(glm::vec3(0.0f, 0.0f, 50.0f));
+    light->SetAttenuation(1.0f, 0.7f, 1.8f);
+    std::vector<std::shared_ptr<Light>> lights = { light };
+
+    clustering->BuildClusters(lights, glm::mat4(1.0f));
+    EXPECT_EQ(clustering->GetLightCount(), 0u);
+    EXPECT_EQ(clustering->GetIndexCount(), 0u);
+}
+
+TEST_F(LightingTest, ManyLightsBinned) {
+    std::vector<std::shared_ptr<Light>> lights;
+    for (int i = 0; i < 1000; i++) {
+        auto light = MakePointLight(glm::vec3((i % 40) - 20.0f, ((i / 40) % 5) - 2.0f, -5.0f - (i / 200) * 10.0f));
+        light->SetAttenuation(1.0f, 0.7f, 1.8f);
+        lights.push_back(light);
+    }
+
+    clustering->BuildClusters(lights, glm::mat4(1.0f));
+
+    EXPECT_GT(clustering->GetLightCount(), 0u);
+    EXPECT_GT(clustering->GetIndexCount(), clustering->GetLightCount());
+    EXPECT_LE(clustering->GetMaxLightsInCluster(), ClusteredLighting::MAX_LIGHTS_PER_CLUSTER);
+}
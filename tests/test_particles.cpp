@@ -0,0 +1,912 @@
+#include <gtest/gtest.h>
+#include <glm/glm.hpp>
+#include "../src/ParticleSystem.h"
+#include "../src/StreamBuffer.h"
+#include "../src/ParticleData.h"
+#include "../src/ParticleKernels.h"
+#include "../src/GpuParticleSimulation.h"
+#include "../src/ParticleManager.h"
+#include "../src/Random.h"
+#include "../src/ParticleSort.h"
+#include "../src/ParticleBudget.h"
+#include "../src/ParticleCollision.h"
+#include "../src/ParticleForces.h"
+#include "../src/ParticleNeighborGrid.h"
+#include "../src/ParticleFluid.h"
+#include "../src/ParticleRibbons.h"
+#include "../src/ParticleEvents.h"
+#include "../src/ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+class ParticleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        particleSystem = std::make_unique<ParticleSystem>();
+    }
+
+    std::unique_ptr<ParticleSystem> particleSystem;
+};
+
+TEST_F(ParticleTest, EmitAndExpire) {
+    particleSystem->SetParticleLife(0.5f, 0.5f);
+    particleSystem->Start();
+    particleSystem->Emit(glm::vec3(0.0f), 10);
+    EXPECT_EQ(particleSystem->GetParticleCount(), 10u);
+
+    particleSystem->SetEmissionRate(0.0f);
+    particleSystem->Update(0.25f);
+    EXPECT_EQ(particleSystem->GetParticleCount(), 10u);
+
+    particleSystem->Update(0.3f);
+    EXPECT_EQ(particleSystem->GetParticleCount(), 0u);
+}
+
+TEST_F(ParticleTest, Reset) {
+    particleSystem->Emit(glm::vec3(0.0f), 5);
+    particleSystem->Reset();
+    EXPECT_EQ(particleSystem->GetParticleCount(), 0u);
+}
+
+TEST_F(ParticleTest, SimdLevelSelection) {
+    particleSystem->SetSimdLevel(SimdLevel::Scalar);
+    EXPECT_EQ(particleSystem->GetSimdLevel(), SimdLevel::Scalar);
+
+    // Requests above what the CPU supports fall back to the best available level
+    particleSystem->SetSimdLevel(SimdLevel::AVX2);
+    EXPECT_EQ(particleSystem->GetSimdLevel(), DetectSimdLevel());
+}
+
+TEST_F(ParticleTest, SweepUpdatesEachParticleOnce) {
+    particleSystem->SetEmissionRate(0.0f);
+    particleSystem->Start();
+
+    // Interleave short-lived and long-lived particles so removals pull
+    // replacements from both inside and beyond each update block
+    for (int batch = 0; batch < 100; batch++) {
+        particleSystem->SetParticleLife(0.05f, 0.05f);
+        particleSystem->Emit(glm::vec3(0.0f), 3);
+        particleSystem->SetParticleLife(1.0f, 1.0f);
+        particleSystem->Emit(glm::vec3(0.0f), 4);
+    }
+
+    particleSystem->Update(0.1f);
+
+    const ParticleData& particles = particleSystem->GetParticles();
+    ASSERT_EQ(particles.Count(), 400u);
+    for (size_t i = 0; i < particles.Count(); i++) {
+        EXPECT_EQ(particles.life[i], 1.0f - 0.1f);
+    }
+}
+
+TEST_F(ParticleTest, PoolDropNew) {
+    particleSystem->SetCapacity(10);
+    particleSystem->SetPoolPolicy(PoolPolicy::DropNew);
+
+    particleSystem->Emit(glm::vec3(0.0f), 15);
+    EXPECT_EQ(particleSystem->GetParticleCount(), 10u);
+    EXPECT_EQ(particleSystem->GetDroppedCount(), 5u);
+    EXPECT_EQ(particleSystem->GetCapacity(), 10u);
+}
+
+TEST_F(ParticleTest, PoolKillOldest) {
+    particleSystem->SetCapacity(10);
+    particleSystem->SetPoolPolicy(PoolPolicy::KillOldest);
+
+    particleSystem->SetParticleLife(0.5f, 0.5f);
+    particleSystem->Emit(glm::vec3(0.0f), 5);
+    particleSystem->SetParticleLife(2.0f, 2.0f);
+    particleSystem->Emit(glm::vec3(0.0f), 5);
+
+    // The five short-lived particles make room for the new ones
+    particleSystem->SetParticleLife(3.0f, 3.0f);
+    particleSystem->Emit(glm::vec3(0.0f), 5);
+    EXPECT_EQ(particleSystem->GetParticleCount(), 10u);
+    EXPECT_EQ(particleSystem->GetReclaimedCount(), 5u);
+
+    const ParticleData& particles = particleSystem->GetParticles();
+    for (size_t i = 0; i < particles.Count(); i++) {
+        EXPECT_GE(particles.life[i], 2.0f);
+    }
+}
+
+TEST_F(ParticleTest, PoolGrow) {
+    particleSystem->SetCapacity(10);
+    particleSystem->SetPoolPolicy(PoolPolicy::Grow);
+
+    particleSystem->Emit(glm::vec3(0.0f), 15);
+    EXPECT_EQ(particleSystem->GetParticleCount(), 15u);
+    EXPECT_GE(particleSystem->GetCapacity(), 15u);
+    EXPECT_EQ(particleSystem->GetDroppedCount(), 0u);
+}
+
+TEST_F(ParticleTest, CompactInstances) {
+    EXPECT_EQ(sizeof(ParticleInstance), 24u);
+
+    particleSystem->SetParticleColor(glm::vec4(1.0f, 0.5f, 0.0f, 1.0f));
+    particleSystem->SetParticleLife(10.0f, 10.0f);
+    particleSystem->SetEmissionRate(0.0f);
+    particleSystem->Start();
+    particleSystem->Emit(glm::vec3(1.0f, 2.0f, 3.0f), 8);
+    particleSystem->Update(0.0f);
+
+    const auto& instances = particleSystem->GetInstances();
+    ASSERT_EQ(instances.size(), 8u);
+    EXPECT_EQ(particleSystem->GetUploadSize(), 8u * sizeof(ParticleInstance));
+    EXPECT_EQ(instances[0].position, glm::vec3(1.0f, 2.0f, 3.0f));
+    EXPECT_EQ(instances[0].color[0], 255);
+    EXPECT_EQ(instances[0].color[1], 128);
+    EXPECT_EQ(instances[0].color[2], 0);
+    EXPECT_EQ(instances[0].color[3], 255);
+}
+
+TEST(ParticleKernelTest, SimdMatchesScalar) {
+    // Odd count so the SIMD kernels also exercise their scalar tail
+    const size_t count = 37;
+    ParticleData reference;
+    reference.Resize(count);
+    for (size_t i = 0; i < count; i++) {
+        reference.px[i] = reference.py[i] = reference.pz[i] = (float)i;
+        reference.vx[i] = 1.0f; reference.vy[i] = -0.5f * i; reference.vz[i] = 0.25f;
+        reference.ax[i] = 0.0f; reference.ay[i] = -9.81f; reference.az[i] = 0.1f * i;
+        reference.r[i] = reference.g[i] = reference.b[i] = reference.a[i] = 1.0f;
+        reference.maxLife[i] = 2.0f;
+        reference.life[i] = 0.05f * i; // spans the fade threshold
+        reference.size[i] = 0.1f;
+        reference.rotation[i] = 0.0f;
+        reference.rotationSpeed[i] = 90.0f;
+    }
+
+    ParticleData simd = reference;
+    UpdateParticlesScalar(reference, 0, count, 0.016f);
+    GetParticleUpdateKernel(DetectSimdLevel())(simd, 0, count, 0.016f);
+
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(simd.px[i], reference.px[i]);
+        EXPECT_EQ(simd.vy[i], reference.vy[i]);
+        EXPECT_EQ(simd.pz[i], reference.pz[i]);
+        EXPECT_EQ(simd.rotation[i], reference.rotation[i]);
+        EXPECT_EQ(simd.life[i], reference.life[i]);
+        EXPECT_EQ(simd.a[i], reference.a[i]);
+    }
+}
+
+TEST(ParticleKernelTest, FadeNearEndOfLife) {
+    ParticleData particles;
+    particles.Resize(2);
+    particles.maxLife[0] = particles.maxLife[1] = 1.0f;
+    particles.life[0] = 0.6f;
+    particles.life[1] = 0.15f + 0.1f;
+
+    UpdateParticlesScalar(particles, 0, 2, 0.1f);
+    EXPECT_NEAR(particles.a[0], 0.5f, 1e-5f);
+    EXPECT_NEAR(particles.a[1], 0.15f * 0.5f, 1e-5f);
+}
+
+TEST(StreamBufferTest, AlignOffset) {
+    EXPECT_EQ(StreamBuffer::AlignOffset(0, 16), 0u);
+    EXPECT_EQ(StreamBuffer::AlignOffset(1, 16), 16u);
+    EXPECT_EQ(StreamBuffer::AlignOffset(32, 16), 32u);
+
+    // Vertex strides need not be powers of two
+    EXPECT_EQ(StreamBuffer::AlignOffset(30, 28), 56u);
+    EXPECT_EQ(StreamBuffer::AlignOffset(56, 28), 56u);
+}
+
+TEST(StreamBufferTest, UninitializedAllocationFails) {
+    StreamBuffer buffer;
+    StreamBuffer::Allocation allocation = buffer.Allocate(64, 16);
+    EXPECT_FALSE(allocation);
+    EXPECT_EQ(buffer.GetFrameBytes(), 0u);
+}
+
+TEST(GpuParticleSimulationTest, SpawnWindowWrapsAroundPool) {
+    // Consecutive windows tile the slots and wrap at capacity
+    EXPECT_EQ(GpuParticleSimulation::AdvanceSpawnCursor(0, 3, 10), 3u);
+    EXPECT_EQ(GpuParticleSimulation::AdvanceSpawnCursor(8, 3, 10), 1u);
+    EXPECT_EQ(GpuParticleSimulation::AdvanceSpawnCursor(4, 25, 10), 9u);
+    EXPECT_EQ(GpuParticleSimulation::AdvanceSpawnCursor(4, 0, 10), 4u);
+
+    // Without a GL context the system stays on the CPU
+    ParticleSystem particleSystem;
+    EXPECT_FALSE(particleSystem.SetSimulationMode(SimulationMode::GPU));
+    EXPECT_EQ(particleSystem.GetSimulationMode(), SimulationMode::CPU);
+}
+
+TEST(ParticleManagerTest, ParallelUpdateIsDeterministic) {
+    // Two managers with the same seed must produce identical particles
+    // however the thread pool schedules the emitters
+    auto makeManager = [](ParticleManager& manager) {
+        manager.SetSeed(1234);
+        for (int i = 0; i < 16; i++) {
+            ParticleBlendMode mode = i % 2 ? ParticleBlendMode::Additive : ParticleBlendMode::Alpha;
+            ParticleSystem& emitter = manager.GetEmitter(manager.CreateEmitter(mode));
+            emitter.SetEmissionRate(500.0f + i * 100.0f);
+            emitter.Start();
+        }
+    };
+
+    ParticleManager first, second;
+    makeManager(first);
+    makeManager(second);
+    for (int frame = 0; frame < 20; frame++) {
+        first.Update(1.0f / 60.0f);
+        second.Update(1.0f / 60.0f);
+    }
+
+    EXPECT_EQ(first.GetEmitterCount(), 16u);
+    EXPECT_GT(first.GetParticleCount(), 0u);
+    EXPECT_EQ(first.GetParticleCount(), second.GetParticleCount());
+    for (ParticleManager::EmitterId id = 0; id < 16; id++) {
+        const ParticleData& a = first.GetEmitter(id).GetParticles();
+        const ParticleData& b = second.GetEmitter(id).GetParticles();
+        ASSERT_EQ(a.Count(), b.Count());
+        EXPECT_EQ(first.GetEmitterStats(id).particleCount, a.Count());
+        for (size_t i = 0; i < a.Count(); i++) {
+            EXPECT_EQ(a.px[i], b.px[i]);
+            EXPECT_EQ(a.vy[i], b.vy[i]);
+        }
+    }
+
+    // Emitters get different streams
+    EXPECT_NE(first.GetEmitter(0).GetParticles().vx[0], first.GetEmitter(1).GetParticles().vx[0]);
+}
+
+TEST(ParticleManagerTest, RemovedIdsAreReused) {
+    ParticleManager manager;
+    ParticleManager::EmitterId a = manager.CreateEmitter();
+    ParticleManager::EmitterId b = manager.CreateEmitter(ParticleBlendMode::Additive);
+    manager.RemoveEmitter(a);
+    EXPECT_FALSE(manager.IsValid(a));
+    EXPECT_EQ(manager.GetEmitterCount(), 1u);
+
+    EXPECT_EQ(manager.CreateEmitter(), a);
+    EXPECT_TRUE(manager.IsValid(b));
+    EXPECT_EQ(manager.GetEmitterStats(b).blendMode, ParticleBlendMode::Additive);
+}
+
+TEST(ParticleManagerTest, FrozenEmittersKeepExpiring) {
+    // An emitter behind the camera and beyond the freeze distance stops
+    // simulating, but its particles still age out of the budget
+    ParticleManager manager;
+    manager.SetParticleBudget(1000);
+    manager.SetCamera(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                      glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 200.0f));
+    ParticleSystem& emitter = manager.GetEmitter(manager.CreateEmitter());
+    emitter.SetPosition(glm::vec3(0.0f, 0.0f, 100.0f));
+    emitter.SetParticleLife(0.25f, 0.25f);
+    emitter.SetEmissionRate(0.0f);
+    emitter.Emit(emitter.GetPosition(), 50);
+    glm::vec3 start(emitter.GetParticles().px[0], emitter.GetParticles().py[0], emitter.GetParticles().pz[0]);
+
+    manager.Update(0.1f);
+    EXPECT_EQ(manager.GetEmitterStats(0).updateInterval, 0);
+    EXPECT_EQ(emitter.GetParticleCount(), 50u);
+    EXPECT_EQ(emitter.GetParticles().px[0], start.x);  // not simulated
+    EXPECT_EQ(emitter.GetInstances().size(), emitter.GetParticleCount());
+
+    manager.Update(0.1f);
+    manager.Update(0.1f);
+    EXPECT_EQ(emitter.GetParticleCount(), 0u);
+    EXPECT_EQ(manager.GetEmitterStats(0).particleCount, 0u);
+    // Render() draws nothing for it once its particles are gone
+    EXPECT_EQ(emitter.GetInstances().size(), 0u);
+}
+
+TEST(RandomTest, PhiloxKnownAnswers) {
+    // Reference vectors for Philox4x32-10
+    const uint32_t zeroCounter[4] = { 0, 0, 0, 0 };
+    const uint32_t zeroKey[2] = { 0, 0 };
+    uint32_t out[4];
+    Philox4x32::Generate(zeroCounter, zeroKey, out);
+    EXPECT_EQ(out[0], 0x6627e8d5u);
+    EXPECT_EQ(out[1], 0xe169c58du);
+    EXPECT_EQ(out[2], 0xbc57ac4cu);
+    EXPECT_EQ(out[3], 0x9b00dbd8u);
+
+    const uint32_t onesCounter[4] = { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu };
+    const uint32_t onesKey[2] = { 0xffffffffu, 0xffffffffu };
+    Philox4x32::Generate(onesCounter, onesKey, out);
+    EXPECT_EQ(out[0], 0x408f276du);
+    EXPECT_EQ(out[1], 0x41c83b0eu);
+    EXPECT_EQ(out[2], 0xa20bc7c6u);
+    EXPECT_EQ(out[3], 0x6d5451fdu);
+}
+
+TEST(RandomTest, BatchFillsMatchScalarCalls) {
+    // Fills of awkward sizes must continue the scalar sequence exactly
+    Xoshiro128Plus batch(42), scalar(42);
+    std::vector<float> values(203);
+    size_t offset = 0;
+    for (size_t size : { 3u, 1u, 64u, 7u, 128u }) {
+        batch.FillUniform(values.data() + offset, size, -2.0f, 5.0f);
+        for (size_t i = 0; i < size; i++) {
+            float expected = scalar.NextFloat(-2.0f, 5.0f);
+            ASSERT_EQ(values[offset + i], expected);
+            EXPECT_GE(expected, -2.0f);
+            EXPECT_LT(expected, 5.0f);
+        }
+        offset += size;
+    }
+
+    Philox4x32 philox(7);
+    std::vector<float> stream(101);
+    philox.FillUniform(stream.data(), stream.size(), 0.0f, 1.0f, 13);
+    for (size_t i = 0; i < stream.size(); i++) {
+        ASSERT_EQ(stream[i], philox.Uniform(13 + i));
+    }
+}
+
+TEST(ParticleSortTest, RadixSortIsStable) {
+    std::vector<uint16_t> keys, scratchKeys(1000);
+    std::vector<uint32_t> order, scratchOrder(1000);
+    std::vector<std::pair<uint16_t, uint32_t>> expected;
+    Xoshiro128Plus random(3);
+    for (uint32_t i = 0; i < 1000; i++) {
+        keys.push_back((uint16_t)(random.NextUInt() % 300 * 217));
+        order.push_back(i);
+        expected.emplace_back(keys.back(), i);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    ParticleDepthSorter::RadixSort(keys.data(), order.data(), scratchKeys.data(), scratchOrder.data(), keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(keys[i], expected[i].first);
+        ASSERT_EQ(order[i], expected[i].second);
+    }
+}
+
+TEST(ParticleSortTest, CoherentFramesUseInsertionFixup) {
+    // Particles along the view axis, stored nearest first
+    ParticleData particles;
+    particles.SetCapacity(64);
+    for (int i = 0; i < 64; i++) {
+        size_t index = particles.Add();
+        particles.px[index] = 0.0f;
+        particles.py[index] = 0.0f;
+        particles.pz[index] = -1.0f - i;
+    }
+    glm::mat4 view(1.0f);
+    ParticleDepthSorter sorter;
+
+    // First frame: full sort, farthest first
+    EXPECT_EQ(sorter.Sort(particles, view, false), ParticleSortMethod::Radix);
+    EXPECT_EQ(sorter.GetOrder().front(), 63u);
+    EXPECT_EQ(sorter.GetOrder().back(), 0u);
+
+    // Storage now in draw order; a small change is repaired in place
+    ParticleData sorted;
+    sorted.Gather(particles, sorter.GetOrder().data(), particles.Count());
+    std::swap(sorted.pz[10], sorted.pz[11]);
+    EXPECT_EQ(sorter.Sort(sorted, view, true), ParticleSortMethod::Insertion);
+    EXPECT_EQ(sorter.GetOrder()[10], 11u);
+    EXPECT_EQ(sorter.GetOrder()[11], 10u);
+
+    // A large camera move falls back to the radix sort
+    view[3][0] = 5.0f;
+    EXPECT_EQ(sorter.Sort(sorted, view, true), ParticleSortMethod::Radix);
+}
+
+TEST(ParticleBudgetTest, ImportanceDrivesAllocation) {
+    // Camera at the origin looking down -Z
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 200.0f);
+
+    std::vector<ParticleBudgetRequest> requests(4);
+    requests[0].position = glm::vec3(0.0f, 0.0f, -5.0f);     // near, on screen
+    requests[1].position = glm::vec3(0.0f, 0.0f, -40.0f);    // far, on screen
+    requests[2].position = glm::vec3(0.0f, 0.0f, 10.0f);     // behind, near
+    requests[3].position = glm::vec3(0.0f, 0.0f, 100.0f);    // behind, beyond freeze distance
+    for (ParticleBudgetRequest& request : requests) {
+        request.demand = 1000;
+        request.liveCount = 100;
+    }
+
+    ParticleBudget budget;
+    std::vector<ParticleBudgetGrant> grants;
+
+    // Under budget every visible emitter runs at full rate
+    budget.SetBudget(10000);
+    budget.Allocate(view, projection, requests, grants);
+    EXPECT_FLOAT_EQ(grants[0].emissionScale, 1.0f);
+    EXPECT_FLOAT_EQ(grants[1].emissionScale, 1.0f);
+    // Demand is a mean, so fitting emitters are not capped at it
+    EXPECT_EQ(grants[0].maxLive, SIZE_MAX);
+    EXPECT_EQ(grants[2].maxLive, SIZE_MAX);
+    EXPECT_EQ(grants[3].maxLive, 100u);
+    EXPECT_EQ(grants[2].updateInterval, ParticleBudget::COARSE_UPDATE_INTERVAL);
+    EXPECT_EQ(grants[3].updateInterval, 0);
+    EXPECT_FALSE(grants[2].visible);
+
+    // Over budget the total stays under it and importance decides the split
+    budget.SetBudget(1500);
+    budget.Allocate(view, projection, requests, grants);
+    size_t total = 0;
+    for (const ParticleBudgetGrant& grant : grants) total += grant.maxLive;
+    EXPECT_LE(total, 1500u);
+    EXPECT_EQ(grants[0].maxLive, 1000u);
+    EXPECT_GT(grants[1].maxLive, grants[2].maxLive);
+    EXPECT_LT(grants[1].emissionScale, 1.0f);
+    EXPECT_EQ(grants[3].maxLive, 100u);
+    EXPECT_FLOAT_EQ(grants[3].emissionScale, 0.0f);
+}
+
+TEST(ParticleCollisionTest, ParticlesBounceOffFloorBox) {
+    // Seven particles: one SSE group plus a scalar tail, all falling into the box
+    ParticleData particles;
+    particles.SetCapacity(8);
+    particles.Resize(7);
+    for (size_t i = 0; i < particles.Count(); i++) {
+        particles.px[i] = -3.0f + (float)i;
+        particles.py[i] = -0.97f;
+        particles.pz[i] = 0.0f;
+        particles.vx[i] = 1.0f;
+        particles.vy[i] = -4.0f;
+        particles.vz[i] = 0.0f;
+        particles.life[i] = 1.0f;
+    }
+    particles.px[6] = 20.0f; // outside the box
+
+    CollisionBox floor = { glm::vec3(-5.0f, -1.05f, -5.0f), glm::vec3(5.0f, -0.95f, 5.0f) };
+    ParticleCollisionSettings settings;
+    settings.restitution = 0.5f;
+    settings.friction = 0.25f;
+    CollideParticlesWithBox(particles, 0, particles.Count(), floor, settings);
+
+    // Entering from above, so pushed out of the top face even though the bottom is as close
+    for (size_t i = 0; i < 6; i++) {
+        EXPECT_FLOAT_EQ(particles.py[i], -0.95f);
+        EXPECT_FLOAT_EQ(particles.vy[i], 2.0f);
+        EXPECT_FLOAT_EQ(particles.vx[i], 0.75f);
+    }
+    EXPECT_FLOAT_EQ(particles.py[6], -0.97f);
+    EXPECT_FLOAT_EQ(particles.vy[6], -4.0f);
+
+    // Kill-on-contact zeroes life instead of bouncing
+    settings.killOnContact = true;
+    CollisionPlane ground = { glm::vec3(0.0f, 1.0f, 0.0f), 0.0f };
+    CollideParticlesWithPlane(particles, 0, particles.Count(), ground, settings);
+    for (size_t i = 0; i < particles.Count(); i++) {
+        EXPECT_EQ(particles.life[i], 0.0f);
+    }
+}
+
+TEST(ParticleCollisionTest, BroadphaseReturnsNearbyBoxes) {
+    ParticleColliders colliders;
+    colliders.SetBoxes({
+        { glm::vec3(-1.0f), glm::vec3(1.0f) },
+        { glm::vec3(20.0f), glm::vec3(21.0f) },
+        { glm::vec3(-500.0f, -1.0f, -500.0f), glm::vec3(500.0f, 0.0f, 500.0f) } // spans too many cells
+    });
+
+    std::vector<uint32_t> boxes;
+    colliders.Query(glm::vec3(0.0f), 2.0f, boxes);
+    EXPECT_EQ(boxes, (std::vector<uint32_t>{ 0, 2 }));
+
+    colliders.Query(glm::vec3(20.5f), 1.0f, boxes);
+    EXPECT_EQ(boxes, (std::vector<uint32_t>{ 1, 2 }));
+}
+
+TEST(ParticleCollisionTest, LargeQueriesScanFewBoxes) {
+    // Probing every 4-unit cell of these radii would take billions of lookups
+    ParticleColliders colliders;
+    colliders.SetBoxes({
+        { glm::vec3(-1.0f), glm::vec3(1.0f) },
+        { glm::vec3(300.0f, 0.0f, 0.0f), glm::vec3(302.0f, 2.0f, 2.0f) },
+        { glm::vec3(0.0f, -900.0f, 50.0f), glm::vec3(3.0f, -897.0f, 53.0f) }
+    });
+
+    std::vector<uint32_t> boxes;
+    colliders.Query(glm::vec3(0.0f), 1.0e4f, boxes);
+    EXPECT_EQ(boxes, (std::vector<uint32_t>{ 0, 1, 2 }));
+    colliders.Query(glm::vec3(0.0f), 1.0e30f, boxes);
+    EXPECT_EQ(boxes, (std::vector<uint32_t>{ 0, 1, 2 }));
+
+    // Still culled by the sphere's cell range, and empty outside the occupied bounds
+    colliders.Query(glm::vec3(0.0f), 400.0f, boxes);
+    EXPECT_EQ(boxes, (std::vector<uint32_t>{ 0, 1 }));
+    colliders.Query(glm::vec3(5000.0f), 100.0f, boxes);
+    EXPECT_TRUE(boxes.empty());
+
+    // Small queries near a box go through the grid, large ones through the
+    // scan; both match a brute-force check
+    Xoshiro128Plus random(5);
+    for (int i = 0; i < 400; i++) {
+        glm::vec3 center(random.NextFloat(-1000.0f, 1000.0f), random.NextFloat(-1000.0f, 1000.0f), random.NextFloat(-1000.0f, 1000.0f));
+        float radius = random.NextFloat(0.0f, 1500.0f);
+        if (i % 2 == 0) {
+            center = colliders.GetBox(i / 2 % 3).min + glm::vec3(random.NextFloat(-6.0f, 6.0f), random.NextFloat(-6.0f, 6.0f), random.NextFloat(-6.0f, 6.0f));
+            radius = random.NextFloat(0.0f, 3.0f);
+        }
+        colliders.Query(center, radius, boxes);
+        std::vector<uint32_t> expected;
+        for (uint32_t index = 0; index < colliders.GetBoxCount(); index++) {
+            const CollisionBox& box = colliders.GetBox(index);
+            // Cell-aligned overlap, as the grid reports it
+            float cell = colliders.GetCellSize();
+            glm::vec3 low = glm::floor((center - glm::vec3(radius)) / cell);
+            glm::vec3 high = glm::floor((center + glm::vec3(radius)) / cell);
+            glm::vec3 boxLow = glm::floor(box.min / cell);
+            glm::vec3 boxHigh = glm::floor(box.max / cell);
+            if (boxLow.x <= high.x && boxLow.y <= high.y && boxLow.z <= high.z &&
+                low.x <= boxHigh.x && low.y <= boxHigh.y && low.z <= boxHigh.z) {
+                expected.push_back(index);
+            }
+        }
+        EXPECT_EQ(boxes, expected) << "radius " << radius;
+    }
+}
+
+TEST(ParticleCollisionTest, BoundingRadiusCoversAcceleratedParticles) {
+    ParticleSystem emitter;
+    emitter.SetParticleLife(2.0f, 2.0f);
+    emitter.SetVelocityRange(glm::vec3(-1.0f), glm::vec3(1.0f));
+    emitter.SetAcceleration(glm::vec3(0.0f, -10.0f, 0.0f));
+    // Top speed over the life plus the fall: sqrt(3) * 2 + 0.5 * 10 * 2^2
+    EXPECT_NEAR(emitter.GetBoundingRadius(), 2.0f * std::sqrt(3.0f) + 20.0f, 1.0e-4f);
+
+    // Force modules add their own bound; drag adds nothing
+    emitter.AddForce(std::make_shared<AttractorForce>(glm::vec3(0.0f), -4.0f, 10.0f));
+    emitter.AddForce(std::make_shared<DragForce>(0.5f));
+    EXPECT_NEAR(emitter.GetBoundingRadius(), 2.0f * std::sqrt(3.0f) + 28.0f, 1.0e-4f);
+}
+
+TEST(ParticleForceTest, MaxAccelerationBoundsEachModule) {
+    // One second steps from rest, so each velocity is the module's acceleration
+    ParticleData particles;
+    particles.Resize(4096);
+    Xoshiro128Plus random(7);
+    auto scatter = [&]() {
+        for (size_t i = 0; i < particles.Count(); i++) {
+            particles.px[i] = random.NextFloat(-6.0f, 6.0f);
+            particles.py[i] = random.NextFloat(-6.0f, 6.0f);
+            particles.pz[i] = random.NextFloat(-6.0f, 6.0f);
+            particles.vx[i] = particles.vy[i] = particles.vz[i] = 0.0f;
+        }
+    };
+
+    VectorFieldForce field;
+    std::vector<glm::vec3> vectors(2 * 3 * 2, glm::vec3(0.5f, 0.0f, 0.0f));
+    vectors[5] = glm::vec3(0.0f, -3.0f, 4.0f);
+    ASSERT_TRUE(field.SetField(glm::ivec3(2, 3, 2), glm::vec3(-4.0f), glm::vec3(4.0f), vectors));
+    field.SetStrength(-2.0f);
+    EXPECT_FLOAT_EQ(field.GetMaxAcceleration(), 10.0f);
+
+    CurlNoiseForce curl(1.5f, 2.0f);
+    AttractorForce attractor(glm::vec3(1.0f), -5.0f, 4.0f);
+    VortexForce vortex(glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 1.0f), 3.0f, 8.0f);
+    vortex.SetPull(4.0f);
+    EXPECT_FLOAT_EQ(vortex.GetMaxAcceleration(), 5.0f);
+    const ParticleForce* forces[] = { &curl, &attractor, &vortex, &field };
+
+    for (const ParticleForce* force : forces) {
+        scatter();
+        force->Apply(particles, 0, particles.Count(), 1.0f, 0.0f);
+        float bound = force->GetMaxAcceleration();
+        float largest = 0.0f;
+        for (size_t i = 0; i < particles.Count(); i++) {
+            largest = std::max(largest, glm::length(glm::vec3(particles.vx[i], particles.vy[i], particles.vz[i])));
+        }
+        EXPECT_LE(largest, bound * 1.0001f) << force->GetName();
+        EXPECT_GT(largest, 0.0f) << force->GetName();
+    }
+}
+
+TEST(ParticleForceTest, SimdMatchesScalar) {
+    // A range call runs the SSE loop; one-particle calls run the scalar tail only
+    ParticleData batch;
+    batch.Resize(11);
+    Xoshiro128Plus random(99);
+    for (size_t i = 0; i < batch.Count(); i++) {
+        batch.px[i] = random.NextFloat(-3.0f, 3.0f);
+        batch.py[i] = random.NextFloat(-3.0f, 3.0f);
+        batch.pz[i] = random.NextFloat(-3.0f, 3.0f);
+        batch.vx[i] = random.NextFloat(-2.0f, 2.0f);
+        batch.vy[i] = random.NextFloat(-2.0f, 2.0f);
+        batch.vz[i] = random.NextFloat(-2.0f, 2.0f);
+    }
+    ParticleData single = batch;
+
+    VectorFieldForce field;
+    std::vector<glm::vec3> vectors(3 * 4 * 5);
+    for (glm::vec3& vector : vectors) {
+        vector = glm::vec3(random.NextFloat(-1.0f, 1.0f), random.NextFloat(-1.0f, 1.0f), random.NextFloat(-1.0f, 1.0f));
+    }
+    ASSERT_TRUE(field.SetField(glm::ivec3(3, 4, 5), glm::vec3(-2.0f), glm::vec3(2.0f), vectors));
+
+    CurlNoiseForce curl(2.0f, 1.3f);
+    curl.SetScrollVelocity(glm::vec3(0.2f, 0.5f, 0.0f));
+    AttractorForce attractor(glm::vec3(1.0f), 5.0f, 4.0f);
+    VortexForce vortex(glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 1.0f), 3.0f, 4.0f);
+    vortex.SetPull(1.0f);
+    DragForce drag(0.5f, 0.1f);
+    const ParticleForce* forces[] = { &curl, &attractor, &vortex, &drag, &field };
+
+    for (const ParticleForce* force : forces) {
+        force->Apply(batch, 0, batch.Count(), 1.0f / 60.0f, 2.5f);
+        for (size_t i = 0; i < single.Count(); i++) {
+            force->Apply(single, i, i + 1, 1.0f / 60.0f, 2.5f);
+        }
+        for (size_t i = 0; i < batch.Count(); i++) {
+            EXPECT_EQ(batch.vx[i], single.vx[i]) << force->GetName();
+            EXPECT_EQ(batch.vy[i], single.vy[i]) << force->GetName();
+            EXPECT_EQ(batch.vz[i], single.vz[i]) << force->GetName();
+        }
+    }
+}
+
+TEST(ParticleForceTest, CurlNoiseIsDivergenceFree) {
+    CurlNoiseForce noise(1.0f, 1.0f);
+    const float h = 1.0e-3f;
+    const glm::vec3 points[] = { glm::vec3(0.3f, 0.7f, 0.1f), glm::vec3(-2.4f, 1.6f, 3.9f), glm::vec3(5.2f, -0.8f, -1.3f) };
+    for (const glm::vec3& point : points) {
+        float divergence = (noise.Sample(point + glm::vec3(h, 0.0f, 0.0f), 0.0f).x - noise.Sample(point - glm::vec3(h, 0.0f, 0.0f), 0.0f).x
+                          + noise.Sample(point + glm::vec3(0.0f, h, 0.0f), 0.0f).y - noise.Sample(point - glm::vec3(0.0f, h, 0.0f), 0.0f).y
+                          + noise.Sample(point + glm::vec3(0.0f, 0.0f, h), 0.0f).z - noise.Sample(point - glm::vec3(0.0f, 0.0f, h), 0.0f).z) / (2.0f * h);
+        glm::vec3 curl = noise.Sample(point, 0.0f);
+        EXPECT_GT(std::abs(curl.x) + std::abs(curl.y) + std::abs(curl.z), 0.01f);
+        EXPECT_NEAR(divergence, 0.0f, 0.05f);
+    }
+}
+
+TEST(ParticleForceTest, VectorFieldLoadsAndInterpolates) {
+    // 2x2x2 field where x varies along x, from 0 to 2
+    const char* path = "test_vector_field.fga";
+    {
+        std::ofstream file(path);
+        file << "2,2,2,\n-1,-1,-1,\n1,1,1,\n";
+        for (int i = 0; i < 8; i++) {
+            file << ((i & 1) ? 2.0f : 0.0f) << ",0,1,\n";
+        }
+    }
+
+    VectorFieldForce field;
+    ASSERT_TRUE(field.LoadFromFile(path));
+    std::remove(path);
+    EXPECT_EQ(field.GetDimensions(), glm::ivec3(2, 2, 2));
+    EXPECT_FLOAT_EQ(field.Sample(glm::vec3(0.0f)).x, 1.0f);
+    EXPECT_FLOAT_EQ(field.Sample(glm::vec3(0.5f, 0.2f, -0.3f)).x, 1.5f);
+    EXPECT_FLOAT_EQ(field.Sample(glm::vec3(0.0f)).z, 1.0f);
+    // Clamped outside the box
+    EXPECT_FLOAT_EQ(field.Sample(glm::vec3(10.0f, 0.0f, 0.0f)).x, 2.0f);
+
+    EXPECT_FALSE(field.LoadFromFile("missing_field.fga"));
+}
+
+TEST(ParticleNeighborGridTest, MatchesBruteForce) {
+    ParticleData particles;
+    particles.Resize(10000);
+    Xoshiro128Plus random(5);
+    random.FillUniform(particles.px.data(), particles.Count(), -2.0f, 2.0f);
+    random.FillUniform(particles.py.data(), particles.Count(), -2.0f, 2.0f);
+    random.FillUniform(particles.pz.data(), particles.Count(), -2.0f, 2.0f);
+
+    const float radius = 0.3f;
+    // Scatter order varies between threads; the result must not
+    ThreadPool pool(3);
+    ParticleNeighborGrid grid;
+    grid.SetThreadPool(&pool);
+    grid.Build(particles, radius);
+    ParticleNeighborGrid serialGrid;
+    serialGrid.SetThreadPool(nullptr);
+    serialGrid.Build(particles, radius);
+    EXPECT_EQ(grid.GetSortedIndices(), serialGrid.GetSortedIndices());
+
+    for (size_t query = 0; query < particles.Count(); query += 331) {
+        glm::vec3 position(particles.px[query], particles.py[query], particles.pz[query]);
+        std::vector<uint32_t> found;
+        grid.ForEachNeighbor(position, [&found](uint32_t index, const glm::vec3&, float) { found.push_back(index); });
+
+        std::vector<uint32_t> expected;
+        for (size_t i = 0; i < particles.Count(); i++) {
+            float dx = particles.px[i] - position.x, dy = particles.py[i] - position.y, dz = particles.pz[i] - position.z;
+            if (dx * dx + dy * dy + dz * dz < radius * radius) expected.push_back((uint32_t)i);
+        }
+
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+}
+
+TEST(SphFluidTest, CompressedParticlesPushApart) {
+    ParticleData particles;
+    particles.Resize(2);
+    particles.px[0] = 0.0f;
+    particles.px[1] = 0.05f;
+
+    SphFluidSettings settings;
+    settings.restDensity = 0.0f; // any density is compressed
+    SphFluidSolver solver;
+    solver.SetSettings(settings);
+    solver.Step(particles, 0.01f);
+
+    EXPECT_LT(particles.vx[0], 0.0f);
+    EXPECT_GT(particles.vx[1], 0.0f);
+    EXPECT_FLOAT_EQ(particles.vx[0], -particles.vx[1]);
+    EXPECT_FLOAT_EQ(particles.vy[0], 0.0f);
+
+    // A lone particle's density is its own poly6 contribution
+    particles.Resize(1);
+    solver.Step(particles, 0.01f);
+    float h = settings.smoothingRadius;
+    EXPECT_NEAR(solver.GetDensities()[0], settings.particleMass * 315.0f / (64.0f * 3.14159265f * h * h * h), 0.01f);
+}
+
+TEST(SphFluidTest, ReorderKeepsParticlesAndCapacity) {
+    // Enough particles for the gather to split across workers; trail holds each particle's id
+    ParticleData particles;
+    particles.SetCapacity(6000);
+    particles.Resize(5000);
+    Xoshiro128Plus random(21);
+    for (size_t i = 0; i < particles.Count(); i++) {
+        particles.px[i] = random.NextFloat(-1.0f, 1.0f);
+        particles.py[i] = random.NextFloat(-1.0f, 1.0f);
+        particles.pz[i] = random.NextFloat(-1.0f, 1.0f);
+        particles.trail[i] = (float)i;
+    }
+    ParticleData original = particles;
+
+    SphFluidSolver solver;
+    solver.Step(particles, 0.001f);
+    ASSERT_EQ(particles.Count(), original.Count());
+    std::vector<char> seen(particles.Count(), 0);
+    for (size_t i = 0; i < particles.Count(); i++) {
+        size_t id = (size_t)particles.trail[i];
+        ASSERT_LT(id, seen.size());
+        EXPECT_FALSE(seen[id]);
+        seen[id] = 1;
+        EXPECT_EQ(particles.px[i], original.px[id]);
+        EXPECT_EQ(particles.pz[i], original.pz[id]);
+    }
+
+    // Steps alternate between the pool and the solver's copy; both follow a shrink
+    particles.SetCapacity(3000);
+    for (int step = 0; step < 2; step++) {
+        solver.Step(particles, 0.001f);
+        EXPECT_EQ(particles.Capacity(), 3000u);
+        EXPECT_EQ(particles.Count(), 3000u);
+    }
+}
+
+TEST(ParticleRibbonsTest, HistoryWrapsNewestFirst) {
+    ParticleData particles;
+    particles.Resize(3);
+    ParticleRibbons ribbons;
+    ribbons.SetCapacity(2, 4);
+    ribbons.Track(particles, 0, 3);
+    EXPECT_EQ(particles.trail[0], 0.0f);
+    EXPECT_EQ(particles.trail[1], 1.0f);
+    EXPECT_EQ(particles.trail[2], ParticleRibbons::UNTRACKED);
+
+    for (int step = 0; step < 6; step++) {
+        particles.px[0] = (float)step;
+        ribbons.Record(particles, 0.01f);
+    }
+    ASSERT_EQ(ribbons.GetPointCount(0), 4);
+    for (int age = 0; age < 4; age++) {
+        EXPECT_EQ(ribbons.GetPoint(0, age).x, (float)(5 - age));
+    }
+
+    // A released slot is handed out again, empty
+    ribbons.Release(particles.trail[1]);
+    EXPECT_EQ(ribbons.GetActiveCount(), 1u);
+    ribbons.Track(particles, 2, 3);
+    EXPECT_EQ(particles.trail[2], 1.0f);
+    EXPECT_EQ(ribbons.GetPointCount(1), 0);
+}
+
+TEST(ParticleRibbonsTest, DeadParticlesFreeTheirRibbons) {
+    ParticleSystem system;
+    system.SetSeed(7);
+    system.SetParticleLife(0.05f, 0.05f);
+    system.SetEmissionRate(0.0f);
+    system.EnableRibbons(8, 4);
+    system.Start();
+
+    system.Emit(glm::vec3(0.0f), 20);
+    EXPECT_EQ(system.GetRibbons()->GetActiveCount(), 8u);
+    system.Update(0.02f);
+    EXPECT_EQ(system.GetRibbons()->GetPointCount(0), 1);
+
+    // Every particle dies; each ribbon goes back to the pool exactly once
+    system.Update(0.1f);
+    EXPECT_EQ(system.GetParticleCount(), 0u);
+    EXPECT_EQ(system.GetRibbons()->GetActiveCount(), 0u);
+    system.Emit(glm::vec3(0.0f), 3);
+    EXPECT_EQ(system.GetRibbons()->GetActiveCount(), 3u);
+}
+
+TEST(ParticleEventQueueTest, BoundedWithOverflowCount) {
+    ParticleEventQueue queue;
+    queue.SetCapacity(5);
+    EXPECT_EQ(queue.GetCapacity(), 8u);
+
+    ParticleEvent event = {};
+    for (uint32_t i = 0; i < 10; i++) {
+        event.subEmitter = i;
+        EXPECT_EQ(queue.Push(event), i < 8);
+    }
+    EXPECT_EQ(queue.GetOverflowCount(), 2u);
+
+    // Bulk pops wrap around the ring in push order
+    ParticleEvent popped[8];
+    ASSERT_EQ(queue.PopBulk(popped, 6), 6u);
+    for (uint32_t i = 0; i < 4; i++) {
+        event.subEmitter = 8 + i;
+        EXPECT_TRUE(queue.Push(event));
+    }
+    ASSERT_EQ(queue.PopBulk(popped, 8), 6u);
+    for (uint32_t i = 0; i < 6; i++) {
+        EXPECT_EQ(popped[i].subEmitter, 6 + i);
+    }
+    EXPECT_EQ(queue.Size(), 0u);
+}
+
+TEST(ParticleEventQueueTest, ProducerAndConsumerThreads) {
+    ParticleEventQueue queue;
+    queue.SetCapacity(64);
+    const uint32_t EVENT_COUNT = 100000;
+
+    std::thread producer([&queue, EVENT_COUNT]() {
+        ParticleEvent event = {};
+        for (uint32_t i = 0; i < EVENT_COUNT; i++) {
+            event.subEmitter = i;
+            while (!queue.Push(event)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    ParticleEvent popped[16];
+    while (expected < EVENT_COUNT) {
+        size_t count = queue.PopBulk(popped, 16);
+        if (count == 0) {
+            // Let the producer run on single-core machines
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < count; i++) {
+            ordered &= popped[i].subEmitter == expected++;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+}
+
+TEST(SubEmitterTest, DeathsSpawnIntoTargetNextStep) {
+    ParticleSystem sparks, smoke;
+    sparks.SetSeed(1);
+    sparks.SetEmissionRate(0.0f);
+    sparks.SetParticleLife(0.05f, 0.05f);
+    sparks.SetVelocityRange(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    sparks.SetAcceleration(glm::vec3(0.0f));
+    sparks.Start();
+    smoke.SetEmissionRate(0.0f);
+    smoke.SetVelocityRange(glm::vec3(0.0f), glm::vec3(0.0f));
+    sparks.AddSubEmitter({ SubEmitterTrigger::Death, &smoke, 2, 0.5f });
+    sparks.SetEventQueueCapacity(8);
+
+    sparks.Emit(glm::vec3(0.0f), 6);
+    sparks.Update(0.1f);
+    EXPECT_EQ(sparks.GetParticleCount(), 0u);
+    EXPECT_EQ(sparks.GetPendingEventCount(), 6u);
+    EXPECT_EQ(smoke.GetParticleCount(), 0u);
+
+    // The next step spawns two children per death, carrying half the parent's velocity
+    sparks.Update(0.1f);
+    EXPECT_EQ(sparks.GetPendingEventCount(), 0u);
+    ASSERT_EQ(smoke.GetParticleCount(), 12u);
+    EXPECT_FLOAT_EQ(smoke.GetParticles().vx[0], 0.5f);
+    EXPECT_NEAR(smoke.GetParticles().px[0], 0.1f, 1e-5f);
+
+    // Deaths beyond the queue's capacity are counted, not queued
+    sparks.Emit(glm::vec3(0.0f), 10);
+    sparks.Update(0.1f);
+    EXPECT_EQ(sparks.GetPendingEventCount(), 8u);
+    EXPECT_EQ(sparks.GetEventOverflowCount(), 2u);
+}
@@ -1,7 +1,21 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <chrono>
+#include <fstream>
+#include <iterator>
 #include <thread>
 #include "../src/PerformanceMonitor.h"
+#include "../src/DynamicResolution.h"
+#include "../src/FramePacer.h"
+#include "../src/Profiler.h"
+#include "../src/TraceCapture.h"
+#include "../src/FrameTimeHistogram.h"
+#include "../src/MemoryTracker.h"
+#include "../src/AllocationTracker.h"
+#include "../src/ParticleManager.h"
+#include "../src/ParticleSystem.h"
+#include "../src/ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
 
 class PerformanceTest : public ::testing::Test {
 protected:
@@ -110,6 +124,49 @@ TEST_F(PerformanceTest, MemoryUsage) {
     EXPECT_GE(peakMemory, memoryUsage);
 }
 
+TEST(MemoryTrackerTest, TracksGpuAllocationsPerCategory) {
+    MemoryTracker& tracker = MemoryTracker::Get();
+    tracker.ResetPeaks();
+    size_t particles = tracker.GetGpuUsage(MemoryCategory::Particles);
+    size_t shadows = tracker.GetGpuUsage(MemoryCategory::Shadows);
+    size_t total = tracker.GetTotalGpuUsage();
+
+    // Names are per object type, so a buffer and a texture may share one
+    tracker.TrackBuffer(9001, 4096, MemoryCategory::Particles);
+    tracker.TrackTexture(9001, MemoryTracker::GetTextureSize(1024, 1024, GL_DEPTH_COMPONENT), MemoryCategory::Shadows);
+    EXPECT_EQ(tracker.GetGpuUsage(MemoryCategory::Particles), particles + 4096);
+    EXPECT_EQ(tracker.GetGpuUsage(MemoryCategory::Shadows), shadows + 4 * 1024 * 1024);
+
+    // Respecifying storage replaces the old size; the peak remembers the largest
+    tracker.TrackBuffer(9001, 16384, MemoryCategory::Particles);
+    tracker.TrackBuffer(9001, 1024, MemoryCategory::Particles);
+    EXPECT_EQ(tracker.GetGpuUsage(MemoryCategory::Particles), particles + 1024);
+    EXPECT_EQ(tracker.GetPeakGpuUsage(MemoryCategory::Particles), particles + 16384);
+
+    tracker.ReleaseBuffer(9001);
+    tracker.ReleaseTexture(9001);
+    tracker.ReleaseTexture(9001);
+    EXPECT_EQ(tracker.GetGpuUsage(MemoryCategory::Particles), particles);
+    EXPECT_EQ(tracker.GetTotalGpuUsage(), total);
+    EXPECT_GE(tracker.GetPeakTotalGpuUsage(), total + 16384 + 4 * 1024 * 1024);
+
+    EXPECT_EQ(MemoryTracker::GetTextureSize(100, 50, GL_RGBA16F), 100u * 50u * 8u);
+    EXPECT_STREQ(MemoryTracker::GetCategoryName(MemoryCategory::RenderTargets), "Render Targets");
+}
+
+#ifdef __linux__
+TEST_F(PerformanceTest, ProcessMemoryFromProc) {
+    ProcessMemoryInfo info;
+    ASSERT_TRUE(MemoryTracker::ReadProcessMemory(info));
+    EXPECT_GT(info.residentBytes, 0u);
+    EXPECT_GE(info.virtualBytes, info.residentBytes);
+
+    monitor->UpdateMemoryUsage();
+    EXPECT_GT(monitor->GetMemoryUsage(), 0u);
+    EXPECT_NE(monitor->GetPerformanceReport().find("Process Memory"), std::string::npos);
+}
+#endif
+
 TEST_F(PerformanceTest, MultipleFrames) {
     const int numFrames = 20;
     
@@ -164,3 +221,634 @@ TEST_F(PerformanceTest, PerformanceThresholds) {
     // This might still be considered "good" depending on thresholds
     // The actual threshold testing depends on the implementation
 }
+
+TEST(DynamicResolutionTest, ScalesDownWhenOverBudget) {
+    DynamicResolution resolution;
+    resolution.SetTargetFrameTime(16.0f);
+
+    for (int i = 0; i < 200; i++) {
+        resolution.Update(30.0f * resolution.GetScale() * resolution.GetScale());
+    }
+
+    EXPECT_LT(resolution.GetScale(), 1.0f);
+    EXPECT_GE(resolution.GetScale(), 0.5f);
+    EXPECT_LE(resolution.GetSmoothedFrameTime(), 16.0f);
+}
+
+TEST(DynamicResolutionTest, RecoversWhenUnderBudget) {
+    DynamicResolution resolution;
+    resolution.SetTargetFrameTime(16.0f);
+
+    for (int i = 0; i < 200; i++) {
+        resolution.Update(60.0f);
+    }
+    EXPECT_FLOAT_EQ(resolution.GetScale(), 0.5f);
+
+    for (int i = 0; i < 1000; i++) {
+        resolution.Update(4.0f);
+    }
+    EXPECT_FLOAT_EQ(resolution.GetScale(), 1.0f);
+}
+
+TEST(DynamicResolutionTest, SettlesWithoutOscillating) {
+    DynamicResolution resolution;
+    resolution.SetTargetFrameTime(16.0f);
+
+    // Cost proportional to pixel count, full resolution well over budget
+    for (int i = 0; i < 300; i++) {
+        resolution.Update(25.0f * resolution.GetScale() * resolution.GetScale());
+    }
+    int changes = resolution.GetScaleChangeCount();
+    float settledScale = resolution.GetScale();
+
+    for (int i = 0; i < 500; i++) {
+        resolution.Update(25.0f * resolution.GetScale() * resolution.GetScale());
+    }
+    EXPECT_EQ(resolution.GetScaleChangeCount(), changes);
+    EXPECT_FLOAT_EQ(resolution.GetScale(), settledScale);
+}
+
+TEST(DynamicResolutionTest, ScaleBounds) {
+    DynamicResolution resolution;
+    resolution.SetScaleBounds(0.7f, 0.9f);
+    EXPECT_FLOAT_EQ(resolution.GetScale(), 0.9f);
+
+    for (int i = 0; i < 200; i++) {
+        resolution.Update(100.0f);
+    }
+    EXPECT_GE(resolution.GetScale(), 0.7f);
+
+    resolution.SetEnabled(false);
+    EXPECT_FLOAT_EQ(resolution.GetScale(), 0.9f);
+}
+
+TEST(FramePacerTest, Unlimited) {
+    FramePacer pacer;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; i++) {
+        pacer.WaitForNextFrame();
+    }
+    auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_LT(elapsed, 50.0f);
+}
+
+TEST(FramePacerTest, HoldsTargetRate) {
+    FramePacer pacer;
+    pacer.SetTargetFPS(200.0f);
+
+    pacer.WaitForNextFrame();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; i++) {
+        pacer.WaitForNextFrame();
+        EXPECT_GE(pacer.GetLastWakeError(), 0.0f);
+    }
+    auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // 20 frames at 5 ms each
+    EXPECT_GE(elapsed, 95.0f);
+    EXPECT_LT(elapsed, 150.0f);
+}
+
+TEST_F(PerformanceTest, PacingJitter) {
+    monitor->RecordPacingJitter(0.5f);
+    monitor->RecordPacingJitter(1.5f);
+
+    EXPECT_FLOAT_EQ(monitor->GetAveragePacingJitter(), 1.0f);
+    EXPECT_FLOAT_EQ(monitor->GetMaxPacingJitter(), 1.5f);
+    EXPECT_NE(monitor->GetPerformanceReport().find("Pacing Jitter"), std::string::npos);
+
+    monitor->ResetStatistics();
+    EXPECT_FLOAT_EQ(monitor->GetMaxPacingJitter(), 0.0f);
+}
+
+TEST_F(PerformanceTest, PacingJitterWindowSlides) {
+    // Jitter shares the frame time window: a spike stays in the max and
+    // percentiles for 1024 frames but leaves the 60-frame average much sooner
+    monitor->RecordPacingJitter(4.0f);
+    for (int i = 0; i < 1023; i++) {
+        monitor->RecordPacingJitter(1.0f);
+    }
+    EXPECT_FLOAT_EQ(monitor->GetMaxPacingJitter(), 4.0f);
+    EXPECT_FLOAT_EQ(monitor->GetAveragePacingJitter(), 1.0f);
+    FrameTimeStats stats = monitor->GetPacingJitterStats();
+    EXPECT_EQ(stats.frames, 1024u);
+    EXPECT_NEAR(stats.p50, 1.0f, 0.01f);
+
+    monitor->RecordPacingJitter(2.0f);
+    EXPECT_NEAR(monitor->GetMaxPacingJitter(), 2.0f, 0.02f);
+    EXPECT_NEAR(monitor->GetAveragePacingJitter(), 61.0f / 60.0f, 1e-5f);
+}
+
+TEST(FrameTimeHistogramTest, QuantilesWithinBucketPrecision) {
+    FrameTimeHistogram histogram;
+    EXPECT_EQ(histogram.GetQuantile(0.5), 0u);
+
+    // Bucket edges line up and values below 128 us are exact
+    for (size_t bucket = 1; bucket < FrameTimeHistogram::BUCKET_COUNT; bucket++) {
+        ASSERT_EQ(FrameTimeHistogram::GetBucketLow(bucket), FrameTimeHistogram::GetBucketHigh(bucket - 1) + 1);
+    }
+    EXPECT_EQ(FrameTimeHistogram::GetBucket(100), 100u);
+    EXPECT_EQ(FrameTimeHistogram::GetBucket(FrameTimeHistogram::MAX_VALUE), FrameTimeHistogram::BUCKET_COUNT - 1);
+
+    // 1..10000 us: each quantile is the q-th value to within 1%
+    for (uint32_t value = 1; value <= 10000; value++) {
+        histogram.Add(value);
+    }
+    EXPECT_EQ(histogram.GetCount(), 10000u);
+    EXPECT_DOUBLE_EQ(histogram.GetMean(), 5000.5);
+    EXPECT_NEAR(histogram.GetQuantile(0.5), 5000.0, 50.0);
+    EXPECT_NEAR(histogram.GetQuantile(0.99), 9900.0, 99.0);
+    EXPECT_NEAR(histogram.GetQuantile(0.999), 9990.0, 100.0);
+    EXPECT_EQ(histogram.GetMax(), 10000u);
+
+    // Removing the top half moves the window's quantiles and max down
+    for (uint32_t value = 5001; value <= 10000; value++) {
+        histogram.Remove(value);
+    }
+    EXPECT_NEAR(histogram.GetQuantile(0.5), 2500.0, 25.0);
+    EXPECT_EQ(histogram.GetMax(), FrameTimeHistogram::GetBucketHigh(FrameTimeHistogram::GetBucket(5000)));
+}
+
+TEST_F(PerformanceTest, FrameTimePercentilesShowHitches) {
+    // One slow frame in twenty: invisible to the median, visible in p99 and max
+    for (int i = 0; i < 20; i++) {
+        monitor->BeginFrame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(i == 10 ? 40 : 2));
+        monitor->EndFrame();
+    }
+
+    FrameTimeStats window = monitor->GetWindowFrameTimeStats();
+    EXPECT_EQ(window.frames, 20u);
+    EXPECT_LT(window.p50, 20.0f);
+    EXPECT_GE(window.p99, 39.0f);
+    EXPECT_GE(window.max, 39.0f);
+    EXPECT_LE(window.p50, window.p90);
+    EXPECT_LE(window.p99, window.max);
+    EXPECT_EQ(monitor->GetSessionFrameTimeStats().frames, 20u);
+
+    std::string report = monitor->GetPerformanceReport();
+    EXPECT_NE(report.find("p99.9"), std::string::npos);
+    EXPECT_NE(report.find("Frame Time (session)"), std::string::npos);
+
+    monitor->ResetStatistics();
+    EXPECT_EQ(monitor->GetWindowFrameTimeStats().frames, 0u);
+    EXPECT_EQ(monitor->GetSessionFrameTimeStats().frames, 0u);
+}
+
+TEST(ProfilerTest, BuildsCallTreeWithSelfTimes) {
+    Profiler& profiler = Profiler::Get();
+    profiler.SetThreadName("Test");
+    profiler.EndFrame(); // flush zones from earlier tests
+
+    {
+        ProfileScope frame("Outer");
+        for (int i = 0; i < 3; i++) {
+            ProfileScope inner("Inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    profiler.EndFrame();
+
+    int thread = profiler.FindNode(0, "Test");
+    ASSERT_GE(thread, 0);
+    int outer = profiler.FindNode(thread, "Outer");
+    ASSERT_GE(outer, 0);
+    int inner = profiler.FindNode(outer, "Inner");
+    ASSERT_GE(inner, 0);
+    EXPECT_EQ(profiler.FindNode(thread, "Inner"), -1);
+
+    const ProfileNode& outerNode = profiler.GetNode(outer);
+    const ProfileNode& innerNode = profiler.GetNode(inner);
+    EXPECT_LT((size_t)inner, profiler.GetNodeCount());
+    EXPECT_EQ(outerNode.callCount, 1u);
+    EXPECT_EQ(innerNode.callCount, 3u);
+    EXPECT_GE(innerNode.totalTime, 6000000u);
+    EXPECT_EQ(outerNode.selfTime, outerNode.totalTime - innerNode.totalTime);
+    EXPECT_GE(outerNode.selfTime, 2000000u);
+    EXPECT_NE(profiler.GetFrameReport().find("Inner"), std::string::npos);
+}
+
+TEST(ProfilerTest, ThreadsGetTheirOwnSubtrees) {
+    Profiler& profiler = Profiler::Get();
+    profiler.EndFrame();
+    size_t dropped = profiler.GetDroppedCount();
+
+    std::thread worker([]() {
+        Profiler::Get().SetThreadName("Profiler Worker");
+        ProfileScope zone("Worker Zone");
+    });
+    worker.join();
+    {
+        ProfileScope zone("Caller Zone");
+    }
+    profiler.EndFrame();
+
+    int workerThread = profiler.FindNode(0, "Profiler Worker");
+    ASSERT_GE(workerThread, 0);
+    EXPECT_GE(profiler.FindNode(workerThread, "Worker Zone"), 0);
+    EXPECT_EQ(profiler.FindNode(workerThread, "Caller Zone"), -1);
+    EXPECT_EQ(profiler.GetDroppedCount(), dropped);
+}
+
+TEST(ProfilerTest, ThreadsRegisterWhileFramesEnd) {
+    // New threads grow the name list while the main thread keeps closing frames
+    Profiler& profiler = Profiler::Get();
+    std::atomic<int> finished{0};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 8; i++) {
+        workers.emplace_back([i, &finished]() {
+            Profiler::Get().SetThreadName("Registering Worker " + std::to_string(i));
+            ProfileScope zone("Registered Zone");
+            finished++;
+        });
+    }
+    while (finished.load() < 8) {
+        profiler.EndFrame();
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    profiler.EndFrame();
+
+    for (int i = 0; i < 8; i++) {
+        std::string name = "Registering Worker " + std::to_string(i);
+        bool named = false;
+        for (size_t thread = 0; thread < profiler.GetThreadCount(); thread++) {
+            named = named || profiler.GetThreadName((uint32_t)thread) == name;
+        }
+        EXPECT_TRUE(named) << name;
+    }
+}
+
+TEST_F(PerformanceTest, GpuTimersNeedNoContextUntilUsed) {
+    // Frames without GPU timers never touch GL
+    for (int i = 0; i < 3; i++) {
+        monitor->BeginFrame();
+        monitor->EndFrame();
+    }
+    EXPECT_FALSE(monitor->GetGpuProfiler().IsInitialized());
+    EXPECT_TRUE(monitor->GetGpuProfiler().GetResults().empty());
+    EXPECT_FLOAT_EQ(monitor->GetGPUTime("Scene"), 0.0f);
+
+    // Ending a timer that was never started only warns
+    EXPECT_NO_THROW(monitor->EndGPUTimer("Scene"));
+    EXPECT_FALSE(monitor->GetGpuProfiler().IsInitialized());
+}
+
+// GpuProfiler on a fake GPU clock: each timestamp reads 1 us after the
+// previous one, and completes once `latency` frames have ended since
+class FakeGpuProfiler : public GpuProfiler {
+public:
+    explicit FakeGpuProfiler(uint64_t frameLatency) : latency(frameLatency) {}
+    // Release here; the base destructor would reach the GL versions
+    ~FakeGpuProfiler() override { Cleanup(); }
+
+    uint64_t latency;
+
+protected:
+    struct Timestamp {
+        uint64_t time;
+        uint64_t frame;
+    };
+
+    void CreateQueries(GLuint* queries, int count) override {
+        for (int i = 0; i < count; i++) {
+            queries[i] = (GLuint)m_timestamps.size();
+            m_timestamps.push_back({ 0, 0 });
+        }
+    }
+    void DeleteQueries(GLuint*, int) override {}
+    void WriteTimestamp(GLuint query) override {
+        m_clock += 1000;
+        m_timestamps[query] = { m_clock, GetFrameNumber() };
+    }
+    bool IsTimestampAvailable(GLuint query) override {
+        return GetFrameNumber() >= m_timestamps[query].frame + latency;
+    }
+    uint64_t ReadTimestamp(GLuint query) override { return m_timestamps[query].time; }
+
+private:
+    // Query 0 means "not created", so ids start at 1
+    std::vector<Timestamp> m_timestamps = std::vector<Timestamp>(1);
+    uint64_t m_clock = 0;
+};
+
+TEST(GpuProfilerTest, SlotsRotateAndResultsLag) {
+    FakeGpuProfiler profiler(2);
+    profiler.Initialize();
+    ASSERT_TRUE(profiler.IsInitialized());
+
+    for (uint64_t frame = 0; frame < 10; frame++) {
+        profiler.BeginFrame();
+        if (frame >= 2) {
+            // Each result arrives two frames after it was recorded
+            EXPECT_EQ(profiler.GetResultFrame(), frame - 2);
+            const std::vector<GpuZoneResult>& results = profiler.GetResults();
+            ASSERT_EQ(results.size(), 3u);
+            EXPECT_STREQ(results[1].name, "Outer");
+            EXPECT_EQ(results[1].parent, 0);
+            EXPECT_EQ(results[2].depth, 2);
+            EXPECT_EQ(results[2].parent, 1);
+            // Six timestamps 1 us apart: frame, outer, inner begin, then the ends in reverse
+            EXPECT_FLOAT_EQ(results[2].start, 0.002f);
+            EXPECT_FLOAT_EQ(profiler.GetZoneTime("Inner"), 0.001f);
+            EXPECT_FLOAT_EQ(profiler.GetZoneTime("Outer"), 0.003f);
+            EXPECT_FLOAT_EQ(results[0].time, 0.005f);
+        }
+
+        profiler.BeginZone("Outer");
+        profiler.BeginZone("Inner");
+        EXPECT_STREQ(profiler.GetOpenZoneName(), "Inner");
+        profiler.EndZone();
+        profiler.EndZone();
+        profiler.EndFrame();
+    }
+    EXPECT_EQ(profiler.GetSkippedFrameCount(), 0u);
+    EXPECT_EQ(profiler.GetDroppedZoneCount(), 0u);
+}
+
+TEST(GpuProfilerTest, FramesGoUntimedWhileEverySlotIsInFlight) {
+    // Results take two frames longer than the ring covers
+    FakeGpuProfiler profiler(GpuProfiler::FRAME_LATENCY + 2);
+    profiler.Initialize();
+
+    for (int frame = 0; frame < GpuProfiler::FRAME_LATENCY + 3; frame++) {
+        profiler.BeginFrame();
+        profiler.BeginZone("Scene");
+        // Untimed frames still pair zones up, but have no recorded zone to name
+        if (frame == GpuProfiler::FRAME_LATENCY) {
+            EXPECT_STREQ(profiler.GetOpenZoneName(), "");
+            EXPECT_EQ(profiler.GetOpenZoneCount(), 2);
+        }
+        profiler.EndZone();
+        profiler.EndFrame();
+    }
+
+    // Frames 4 and 5 found slot 0 pending; frame 6 read it back and recorded again
+    EXPECT_EQ(profiler.GetSkippedFrameCount(), 2u);
+    EXPECT_EQ(profiler.GetResultFrame(), 0u);
+    EXPECT_FLOAT_EQ(profiler.GetZoneTime("Scene"), 0.001f);
+    EXPECT_EQ(profiler.GetDroppedZoneCount(), 0u);
+}
+
+TEST(GpuProfilerTest, ZonesPastTheLimitAreDropped) {
+    FakeGpuProfiler profiler(1);
+    profiler.Initialize();
+
+    const int extra = 7;
+    profiler.BeginFrame();
+    for (int i = 0; i < GpuProfiler::MAX_ZONES - 1 + extra; i++) {
+        profiler.BeginZone("Draw");
+        profiler.EndZone();
+    }
+    profiler.EndFrame();
+    EXPECT_EQ(profiler.GetDroppedZoneCount(), (size_t)extra);
+
+    profiler.BeginFrame();
+    EXPECT_EQ(profiler.GetResults().size(), (size_t)GpuProfiler::MAX_ZONES);
+    EXPECT_NEAR(profiler.GetZoneTime("Draw"), 0.001f * (GpuProfiler::MAX_ZONES - 1), 1.0e-5f);
+    profiler.EndFrame();
+}
+
+TEST(TraceCaptureTest, WritesChromeTraceEvents) {
+    Profiler& profiler = Profiler::Get();
+    profiler.EndFrame();
+
+    TraceCapture capture;
+    std::string path = ::testing::TempDir() + "trace_capture_test.json";
+    ASSERT_TRUE(capture.Start(2, path));
+    EXPECT_FALSE(capture.Start(2, path));
+    for (int i = 0; i < 2; i++) {
+        {
+            ProfileScope zone("Trace \"Zone\"");
+        }
+        profiler.EndFrame();
+        capture.SetCounter("Particles", 100.0f * (i + 1));
+        capture.EndFrame(profiler, nullptr);
+    }
+    // Without GPU frames the capture finishes with its last frame
+    EXPECT_FALSE(capture.IsCapturing());
+    capture.WaitForWriter();
+    EXPECT_TRUE(capture.GetLastWriteSucceeded());
+    EXPECT_EQ(capture.GetLastFilePath(), path);
+    EXPECT_EQ(capture.GetCaptureCount(), 1u);
+
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"name\":\"Trace \\\"Zone\\\"\",\"cat\":\"cpu\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"thread_name\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"Frame 1\""), std::string::npos);
+    EXPECT_EQ(json.find("\"name\":\"Frame 2\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"Particles\",\"ph\":\"C\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"value\":200}"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+}
+
+TEST(TraceCaptureTest, FrameTimeTriggerCapturesTheSlowFrame) {
+    Profiler& profiler = Profiler::Get();
+    profiler.EndFrame();
+
+    TraceCapture capture;
+    std::string path = ::testing::TempDir() + "trace_trigger_test.json";
+    capture.SetFrameTimeTrigger(20.0f, 1, path);
+
+    profiler.EndFrame();
+    capture.EndFrame(profiler, nullptr);
+    EXPECT_EQ(capture.GetCaptureCount(), 0u);
+
+    {
+        ProfileScope zone("Slow Zone");
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    profiler.EndFrame();
+    capture.EndFrame(profiler, nullptr);
+    EXPECT_EQ(capture.GetCaptureCount(), 1u);
+    EXPECT_FLOAT_EQ(capture.GetFrameTimeTrigger(), 0.0f);
+
+    capture.WaitForWriter();
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(json.find("Slow Zone"), std::string::npos);
+}
+
+TEST(AllocationTrackerTest, CountsAllocationsPerTagAndFrame) {
+    if (!AllocationTracker::IsCompiledIn()) GTEST_SKIP() << "built without ENABLE_ALLOCATION_TRACKING";
+    AllocationTracker& tracker = AllocationTracker::Get();
+    int tag = tracker.GetTag("Test Tag");
+    int workerTag = tracker.GetTag("Test Worker Tag");
+    EXPECT_EQ(tracker.GetTag("Test Tag"), tag);
+    EXPECT_STREQ(tracker.GetTagName(tag), "Test Tag");
+
+    // Kept outside the tagged scopes so the allocations cannot be optimized away
+    std::vector<std::unique_ptr<char[]>> kept;
+    kept.reserve(16);
+    std::vector<size_t> workerSizes(64, 0);
+    tracker.EndFrame();
+    {
+        AllocationScope scope(tag);
+        EXPECT_EQ(AllocationTracker::GetCurrentTag(), tag);
+        kept.emplace_back(new char[100]);
+        kept.emplace_back(new char[28]);
+    }
+    EXPECT_EQ(AllocationTracker::GetCurrentTag(), AllocationTracker::UNTAGGED);
+    {
+        // Pool workers count against the tag of the thread that submitted the job
+        AllocationScope scope(workerTag);
+        ThreadPool pool(2);
+        pool.ParallelFor(workerSizes.size(), 1, [&workerSizes](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                std::string text(64, 'x');
+                workerSizes[i] = text.size();
+            }
+        });
+    }
+    tracker.EndFrame();
+
+    EXPECT_EQ(tracker.GetFrameStats(tag).allocations, 2u);
+    EXPECT_EQ(tracker.GetFrameStats(tag).bytes, 128u);
+    EXPECT_EQ(tracker.GetFrameStats(tag).frees, 0u);
+    EXPECT_GE(tracker.GetFrameStats(workerTag).allocations, 64u);
+    EXPECT_GE(tracker.GetFrameStats(workerTag).frees, 64u);
+    EXPECT_GE(tracker.GetFrameAllocationCount(), 66u);
+    EXPECT_NE(tracker.GetFrameReport().find("Test Tag"), std::string::npos);
+    EXPECT_EQ(workerSizes[63], 64u);
+
+    // Counters start over every frame
+    kept.clear();
+    tracker.EndFrame();
+    EXPECT_EQ(tracker.GetFrameStats(tag).allocations, 0u);
+    EXPECT_GE(tracker.GetFrameStats(AllocationTracker::UNTAGGED).frees, 2u);
+    EXPECT_GE(tracker.GetSessionStats(tag).allocations, 2u);
+}
+
+TEST(AllocationTrackerTest, RetrackingGpuObjectsDoesNotAllocate) {
+    if (!AllocationTracker::IsCompiledIn()) GTEST_SKIP() << "built without ENABLE_ALLOCATION_TRACKING";
+    AllocationTracker& tracker = AllocationTracker::Get();
+    MemoryTracker& memory = MemoryTracker::Get();
+    int tag = tracker.GetTag("Retrack Test");
+
+    // Only the first call for an object adds an entry; per-frame re-tracking reuses it
+    memory.TrackBuffer(9002, 4096, MemoryCategory::Particles);
+    tracker.EndFrame();
+    {
+        AllocationScope scope(tag);
+        for (size_t i = 0; i < 100; i++) {
+            memory.TrackBuffer(9002, 4096 + i, MemoryCategory::Particles);
+        }
+    }
+    tracker.EndFrame();
+    memory.ReleaseBuffer(9002);
+
+    EXPECT_EQ(tracker.GetFrameStats(tag).allocations, 0u);
+}
+
+TEST(AllocationTrackerTest, SteadyStateParticleUpdateDoesNotAllocate) {
+    if (!AllocationTracker::IsCompiledIn()) GTEST_SKIP() << "built without ENABLE_ALLOCATION_TRACKING";
+    AllocationTracker& tracker = AllocationTracker::Get();
+    Profiler& profiler = Profiler::Get();
+
+    // One standalone system and a manager whose emitters update on the shared pool
+    ParticleSystem particles;
+    particles.SetEmissionRate(2000.0f);
+    particles.SetParticleLife(0.5f, 1.0f);
+    particles.Start();
+    ParticleManager manager;
+    for (int i = 0; i < 8; i++) {
+        ParticleSystem& emitter = manager.GetEmitter(manager.CreateEmitter(ParticleBlendMode::Additive));
+        emitter.SetEmissionRate(1000.0f);
+        emitter.SetParticleLife(0.5f, 1.0f);
+        emitter.Start();
+    }
+
+    // Warm up until emission and expiry balance and every buffer has grown
+    for (int frame = 0; frame < 120; frame++) {
+        particles.Update(1.0f / 60.0f);
+        manager.Update(1.0f / 60.0f);
+        profiler.EndFrame();
+    }
+    tracker.EndFrame();
+
+    tracker.SetSteadyStateCheck(true);
+    size_t violationsBefore = tracker.GetSteadyStateViolationCount();
+    for (int frame = 0; frame < 60; frame++) {
+        particles.Update(1.0f / 60.0f);
+        manager.Update(1.0f / 60.0f);
+        profiler.EndFrame();
+        tracker.EndFrame();
+    }
+    tracker.SetSteadyStateCheck(false);
+
+    EXPECT_GT(particles.GetParticleCount(), 0u);
+    EXPECT_GT(manager.GetParticleCount(), 0u);
+    EXPECT_EQ(tracker.GetSteadyStateViolationCount(), violationsBefore);
+}
+
+TEST(AllocationTrackerTest, SteadyStateBudgetedFrameDoesNotAllocate) {
+    if (!AllocationTracker::IsCompiledIn()) GTEST_SKIP() << "built without ENABLE_ALLOCATION_TRACKING";
+    AllocationTracker& tracker = AllocationTracker::Get();
+    Profiler& profiler = Profiler::Get();
+    MemoryTracker& memory = MemoryTracker::Get();
+    PerformanceMonitor monitor;
+    FakeGpuProfiler gpuProfiler(2);
+    gpuProfiler.Initialize();
+
+    // Camera at the origin looking down -Z; emitters near and far in view,
+    // behind it (coarse updates) and far behind it (frozen)
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 200.0f);
+    const glm::vec3 positions[] = { glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(0.0f, 0.0f, -40.0f),
+                                    glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(0.0f, 0.0f, 150.0f) };
+    ParticleManager manager;
+    for (int i = 0; i < 8; i++) {
+        ParticleSystem& emitter = manager.GetEmitter(manager.CreateEmitter(ParticleBlendMode::Additive));
+        emitter.SetPosition(positions[i % 4] + glm::vec3((float)i, 0.0f, 0.0f));
+        emitter.SetEmissionRate(1000.0f);
+        emitter.SetParticleLife(0.5f, 1.0f);
+        emitter.Start();
+    }
+    manager.SetParticleBudget(1500);
+    manager.SetCamera(view, projection);
+
+    // The per-frame calls of the render loop that do not need a GL context
+    auto frame = [&]() {
+        monitor.BeginFrame();
+        gpuProfiler.BeginFrame();
+        gpuProfiler.BeginZone("Deferred Geometry");
+        gpuProfiler.EndZone();
+        gpuProfiler.BeginZone("Deferred Lighting");
+        manager.Update(1.0f / 60.0f);
+        gpuProfiler.EndZone();
+        // Streamed and light buffers re-track their storage every frame
+        memory.TrackBuffer(9003, 65536, MemoryCategory::Streaming);
+        memory.TrackBuffer(9004, 4096 + 16 * manager.GetParticleCount(), MemoryCategory::Lighting);
+        gpuProfiler.EndFrame();
+        monitor.EndFrame();
+        profiler.EndFrame();
+    };
+
+    for (int i = 0; i < 120; i++) {
+        frame();
+    }
+    tracker.EndFrame();
+
+    tracker.SetSteadyStateCheck(true);
+    size_t violationsBefore = tracker.GetSteadyStateViolationCount();
+    for (int i = 0; i < 60; i++) {
+        frame();
+        tracker.EndFrame();
+    }
+    tracker.SetSteadyStateCheck(false);
+    memory.ReleaseBuffer(9003);
+    memory.ReleaseBuffer(9004);
+
+    // The budget was binding and every update mode ran
+    EXPECT_LE(manager.GetParticleCount(), 1500u);
+    EXPECT_LT(manager.GetEmitterStats(1).emissionScale, 1.0f);
+    EXPECT_EQ(manager.GetEmitterStats(2).updateInterval, ParticleBudget::COARSE_UPDATE_INTERVAL);
+    EXPECT_EQ(manager.GetEmitterStats(3).updateInterval, 0);
+    EXPECT_GT(gpuProfiler.GetZoneTime("Deferred Lighting"), 0.0f);
+    EXPECT_EQ(tracker.GetSteadyStateViolationCount(), violationsBefore);
+}
@@ -3,6 +3,7 @@
 #include "../src/SceneManager.h"
 #include "../src/Object3D.h"
 #include "../src/Light.h"
+#include "../src/Mesh.h"
 
 class SceneTest : public ::testing::Test {
 protected:
@@ -149,3 +150,12 @@ TEST_F(SceneTest, MaterialProperties) {
     EXPECT_EQ(retrievedObject->color, glm::vec3(1.0f, 0.0f, 0.0f));
     EXPECT_FLOAT_EQ(retrievedObject->shininess, 64.0f);
 }
+
+TEST_F(SceneTest, PrimitiveMeshes) {
+    auto box = Mesh::CreateBox();
+    EXPECT_EQ(box->GetVertexCount(), 24u);
+    EXPECT_EQ(box->GetIndexCount(), 36u);
+
+    auto cylinder = Mesh::CreateCylinder(8);
+    EXPECT_EQ(cylinder->GetIndexCount(), 8u * 6u + 2u * 8u * 3u);
+}